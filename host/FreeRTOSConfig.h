@@ -0,0 +1,75 @@
+/**
+ **************************************************************
+ * @file host/FreeRTOSConfig.h
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief FreeRTOS configuration for the host build
+ *        (board: linux host, FreeRTOS POSIX port)
+ * REFERENCE: pf/FreeRTOSConfig.h, FreeRTOS/Demo/Posix_GCC
+ ***************************************************************
+ * mirrors pf/FreeRTOSConfig.h so the tasks see the same kernel. the differences
+ * are what the posix port needs: tasks run on pthreads, so stacks are sized in
+ * host words and large enough for libc, and there are no cortex-m interrupt
+ * priorities
+ ***************************************************************
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <stdint.h>
+#include <assert.h>
+
+#define configCOMMAND_INT_MAX_OUTPUT_SIZE			200
+
+#define configUSE_PREEMPTION              1
+#define configUSE_IDLE_HOOK               0
+#define configUSE_TICK_HOOK               0
+#define configUSE_DAEMON_TASK_STARTUP_HOOK 0
+#define configTICK_RATE_HZ                ((TickType_t)1000)
+#define configMAX_PRIORITIES              (7)
+#define configMINIMAL_STACK_SIZE          ((unsigned short)4096)   // words, libc printf needs room
+#define configTOTAL_HEAP_SIZE             ((size_t)(64 * 1024 * 1024))
+#define configMAX_TASK_NAME_LEN           (16)
+#define configUSE_TRACE_FACILITY          1
+#define configUSE_16_BIT_TICKS            0
+#define configIDLE_SHOULD_YIELD           1
+#define configUSE_QUEUE_SETS			  1
+#define configUSE_MUTEXES                 1
+#define configQUEUE_REGISTRY_SIZE         8
+#define configCHECK_FOR_STACK_OVERFLOW    0
+#define configUSE_RECURSIVE_MUTEXES       1
+#define configUSE_MALLOC_FAILED_HOOK      0
+#define configUSE_APPLICATION_TASK_TAG    0
+#define configUSE_COUNTING_SEMAPHORES     1
+#define configGENERATE_RUN_TIME_STATS     0
+#define configSUPPORT_DYNAMIC_ALLOCATION  1
+#define configSUPPORT_STATIC_ALLOCATION   0
+
+/* Co-routine definitions. */
+#define configUSE_CO_ROUTINES           0
+#define configMAX_CO_ROUTINE_PRIORITIES (2)
+
+/* Software timer definitions. */
+#define configUSE_TIMERS             0
+#define configTIMER_TASK_PRIORITY    (2)
+#define configTIMER_QUEUE_LENGTH     10
+#define configTIMER_TASK_STACK_DEPTH (configMINIMAL_STACK_SIZE * 2)
+
+/* Set the following definitions to 1 to include the API function, or zero
+to exclude the API function. */
+#define INCLUDE_vTaskPrioritySet       1
+#define INCLUDE_uxTaskPriorityGet      1
+#define INCLUDE_vTaskDelete            1
+#define INCLUDE_vTaskCleanUpResources  0
+#define INCLUDE_vTaskSuspend           1
+#define INCLUDE_vTaskDelayUntil        1
+#define INCLUDE_vTaskDelay             1
+#define INCLUDE_xTaskGetSchedulerState 1
+#define INCLUDE_xTaskGetHandle         1
+#define INCLUDE_xTaskGetCurrentTaskHandle 1
+
+/* the posix port has no interrupt priorities, an assert stops the process */
+#define configASSERT( x ) assert( x )
+
+#endif /* FREERTOS_CONFIG_H */
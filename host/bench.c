@@ -0,0 +1,97 @@
+/**
+ **************************************************************
+ * @file host/bench.c
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief simulator engine benchmarks as CSV (board: linux host)
+ * REFERENCE: mylib/s4640878_CAG_bench.h
+ ***************************************************************
+ * usage: bench [-j threads] [-k kernel] [-c] [generations [WIDTHxHEIGHT ...]]
+ * runs every engine on every seed at each size (default: 100 generations at
+ * CAG_BENCH_SIZES) and writes one CSV row per run to stdout
+ * -j sets the threads of the parallel engine (default: one per core), so
+ * runs with -j 1, 2, 4 ... show how it scales
+ * -k sets the tile kernel of the packed engines: scalar, sse2, avx2, or the
+ * lookup tables lut3x3 or lut4x4 (default: the best vector kernel the cpu
+ * has), so runs with each compare them
+ * -c checks the step engines against the int engine (the per-cell loop) cell
+ * for cell after every generation instead of timing them, and hashlife by
+ * saving its pattern as a macrocell, loading it back and comparing the cells
+ ***************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "s4640878_CAG_bench.h"
+
+#define DEFAULT_GENERATIONS 100
+
+static const int defaultSize[][2] = CAG_BENCH_SIZES;
+static const char *kernelName[] = {"scalar", "sse2", "avx2", "lut3x3", "lut4x4"};
+
+// runs (or checks) and prints every engine on every seed at one size
+static void bench_size(int width, int height, uint32_t generations, int check) {
+    caBenchResult_t result;
+    char row[CAG_BENCH_ROW_LEN + 1];
+
+    for (int seed = 0; seed < CAG_BENCH_SEEDS; seed++) {
+        for (int engine = 0; engine < CAG_BENCH_ENGINES; engine++) {
+            if (check) {
+                s4640878_lib_CAG_bench_check(&result, engine, seed, width, height, generations);
+            } else {
+                s4640878_lib_CAG_bench_run(&result, engine, seed, width, height, generations);
+            }
+            s4640878_lib_CAG_bench_format(&result, row);
+            printf("%s\n", row);
+            fflush(stdout);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    int check = 0, option;
+    while ((option = getopt(argc, argv, "j:k:c")) != -1) {
+        switch (option) {
+            case 'j':
+                s4640878_lib_CAG_bench_set_threads(atoi(optarg));
+                break;
+            case 'k':
+                for (int kernel = CAG_KERNEL_SCALAR; kernel <= CAG_KERNEL_LUT_4X4; kernel++) {
+                    if (strcmp(optarg, kernelName[kernel]) == 0) {
+                        s4640878_lib_CAG_bench_set_kernel(kernel);
+                    }
+                }
+                break;
+            case 'c':
+                check = 1;
+                break;
+            default:
+                fprintf(stderr, "usage: bench [-j threads] [-k kernel] [-c] [generations [WIDTHxHEIGHT ...]]\n");
+                return 1;
+        }
+    }
+    argc -= optind - 1;
+    argv += optind - 1;
+    uint32_t generations = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_GENERATIONS;
+    char header[CAG_BENCH_ROW_LEN + 1];
+
+    s4640878_lib_CAG_bench_format_header(header);
+    printf("%s\n", header);
+    if (argc > 2) {
+        for (int i = 2; i < argc; i++) {
+            int width, height;
+            if (sscanf(argv[i], "%dx%d", &width, &height) != 2) {
+                fprintf(stderr, "bench: size %s is not WIDTHxHEIGHT\n", argv[i]);
+                return 1;
+            }
+            bench_size(width, height, generations, check);
+        }
+    } else {
+        for (int i = 0; i < (int)(sizeof(defaultSize) / sizeof(defaultSize[0])); i++) {
+            bench_size(defaultSize[i][0], defaultSize[i][1], generations, check);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,35 @@
+/**
+ **************************************************************
+ * @file host/board.h
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief host stand-in for the nucleo board support (header file)
+ *        (board: linux host, FreeRTOS POSIX port)
+ * REFERENCE: board.h (csse3010 board support)
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * BRD_LEDInit() - initialises the green led
+ * BRD_LEDGreenOn() - turns the green led on
+ * BRD_LEDGreenOff() - turns the green led off
+ * BRD_debuguart_init() - initialises the debug uart
+ * BRD_debuguart_getc() - gets a character from the debug uart
+ ***************************************************************
+ */
+
+#ifndef BOARD_H_
+#define BOARD_H_
+
+#include "processor_hal.h"
+
+// green led state, 1 when on
+extern int hostLEDGreen;
+
+// external function declarations
+void BRD_LEDInit(void);
+void BRD_LEDGreenOn(void);
+void BRD_LEDGreenOff(void);
+void BRD_debuguart_init(void);
+char BRD_debuguart_getc(void);
+
+#endif
@@ -0,0 +1,44 @@
+/**
+ **************************************************************
+ * @file host/debug_log.h
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief host stand-in for the debug uart (header file)
+ *        (board: linux host, FreeRTOS POSIX port)
+ * REFERENCE: debug_log.h (csse3010 board support)
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * debug_putc() - writes a character to stdout
+ * debug_getc() - gets a character from stdin, '\0' when there is none
+ * debug_flush() - flushes stdout
+ * debug_log() - printf to stdout
+ ***************************************************************
+ * the uart is stdin/stdout. a terminal is put in raw mode for the run and the
+ * board inputs are on control keys:
+ *   ctrl-b      user push-button (toggles grid and cli mode)
+ *   ctrl-k      joystick push-button (clears the grid)
+ *   left/right  joystick x held for HOST_JOYSTICK_HOLD_MS (pause/play)
+ *   up/down     joystick y moved a step and left there (update period)
+ * input that is not a terminal has '\n' read as '\r', and the process exits
+ * HOST_EOF_MS after the input has ended (or once the command in progress has
+ * finished), so scripts like `printf '\002step 1000\n' | ./pf` run to completion
+ ***************************************************************
+ */
+
+#ifndef DEBUG_LOG_H_
+#define DEBUG_LOG_H_
+
+#include <stdio.h>
+
+#define HOST_JOYSTICK_HOLD_MS 250
+#define HOST_EOF_MS 500
+
+#define debug_log(...) printf(__VA_ARGS__)
+
+// external function declarations
+void debug_putc(char c);
+char debug_getc(void);
+void debug_flush(void);
+
+#endif
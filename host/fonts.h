@@ -0,0 +1,27 @@
+/**
+ **************************************************************
+ * @file host/fonts.h
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief host stand-in for the ssd1306 fonts (header file)
+ *        (board: linux host, FreeRTOS POSIX port)
+ * REFERENCE: fonts.h (stm32-ssd1306)
+ ***************************************************************
+ * only the glyph size is kept, text is not rasterised on the host
+ ***************************************************************
+ */
+
+#ifndef FONTS_H_
+#define FONTS_H_
+
+#include <stdint.h>
+
+typedef struct {
+    const uint8_t FontWidth;
+    uint8_t FontHeight;
+    const uint16_t *data;
+} FontDef;
+
+extern FontDef Font_7x10;
+
+#endif
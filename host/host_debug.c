@@ -0,0 +1,207 @@
+/**
+ **************************************************************
+ * @file host/host_debug.c
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief host stand-in for the debug uart and the board inputs
+ *        (board: linux host, FreeRTOS POSIX port)
+ * REFERENCE: debug_log.c, board.c (csse3010 board support)
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * BRD_debuguart_init() - no-op, the terminal is set up by HAL_Init
+ * BRD_debuguart_getc() - gets a character from stdin, '\0' when there is none
+ * debug_putc() - writes a character to stdout
+ * debug_getc() - gets a character from stdin, '\0' when there is none
+ * debug_flush() - flushes stdout
+ ***************************************************************
+ * see host/debug_log.h for the keys that stand in for the board inputs
+ ***************************************************************
+ */
+
+#include "processor_hal.h"
+#include "board.h"
+#include "debug_log.h"
+
+// after the hal, termios.h defines CR1 (a register name) as a macro
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+
+// control keys
+#define KEY_USER_PB 0x02        // ctrl-b
+#define KEY_JOYSTICK_PB 0x0B    // ctrl-k
+#define KEY_ESCAPE 0x1B
+
+// joystick adc channels and steps
+#define JOYSTICK_X_CHANNEL ADC_CHANNEL_1
+#define JOYSTICK_Y_CHANNEL ADC_CHANNEL_4
+#define JOYSTICK_MIN 0
+#define JOYSTICK_MAX 4095
+#define JOYSTICK_Y_STEP 1000
+#define JOYSTICK_Y_STEPS 2      // y moves up to 2 steps either side of centre
+
+// gap between raised interrupts, longer than the 10ms debouncing in mylib
+#define EXTI_GAP_MS 20
+
+// internal function declarations
+void host_terminal_init(void);
+void host_terminal_restore(void);
+char host_input(void);
+void host_input_arrow(char key, uint32_t now);
+
+static struct termios hostTermios;
+static int hostTerminal = 0;        // stdin is a terminal in raw mode
+static int hostEscape = 0;          // position in an arrow key escape sequence
+static int hostEnded = 0;           // stdin has ended
+static uint32_t hostEndTick;        // tick stdin ended
+static uint32_t hostHoldoff = EXTI_GAP_MS;  // no input is read before this tick
+static uint32_t hostReleaseTick = 0;    // tick to release the joystick button, 0 if not held
+static uint32_t hostRecentreTick = 0;   // tick to recentre joystick x, 0 if not held
+static int hostJoystickY = 0;           // joystick y in steps from centre
+
+// puts a terminal on stdin in raw mode (signals kept) and makes reads non-blocking
+void host_terminal_init(void) {
+    struct termios raw;
+
+    if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &hostTermios) == 0) {
+        raw = hostTermios;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_iflag &= ~(ICRNL | IXON);
+        raw.c_cc[VMIN] = 0;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+        hostTerminal = 1;
+        atexit(host_terminal_restore);
+        setvbuf(stdout, NULL, _IONBF, 0);
+    }
+    fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+}
+
+// restores the terminal on exit
+void host_terminal_restore(void) {
+    tcsetattr(STDIN_FILENO, TCSANOW, &hostTermios);
+}
+
+// moves the joystick for an arrow key
+void host_input_arrow(char key, uint32_t now) {
+    switch (key) {
+        case 'A':   // up, shorter update period
+            if (hostJoystickY > -JOYSTICK_Y_STEPS) {
+                hostJoystickY--;
+            }
+            break;
+        case 'B':   // down, longer update period
+            if (hostJoystickY < JOYSTICK_Y_STEPS) {
+                hostJoystickY++;
+            }
+            break;
+        case 'C':   // right, play
+            host_adc_set(JOYSTICK_X_CHANNEL, JOYSTICK_MAX);
+            hostRecentreTick = now + HOST_JOYSTICK_HOLD_MS;
+            return;
+        case 'D':   // left, pause
+            host_adc_set(JOYSTICK_X_CHANNEL, JOYSTICK_MIN);
+            hostRecentreTick = now + HOST_JOYSTICK_HOLD_MS;
+            return;
+        default:
+            return;
+    }
+    host_adc_set(JOYSTICK_Y_CHANNEL, HOST_ADC_MID + hostJoystickY * JOYSTICK_Y_STEP);
+}
+
+// gets the next uart character from stdin, handling the board input keys
+// returns '\0' when there is no character
+char host_input(void) {
+    uint32_t now = HAL_GetTick();
+    char c;
+    ssize_t n;
+
+    // release held inputs
+    if (hostReleaseTick && now >= hostReleaseTick) {
+        hostReleaseTick = 0;
+        host_exti_raise(0);
+    }
+    if (hostRecentreTick && now >= hostRecentreTick) {
+        hostRecentreTick = 0;
+        host_adc_set(JOYSTICK_X_CHANNEL, HOST_ADC_MID);
+    }
+    if (now < hostHoldoff) {
+        return '\0';
+    }
+
+    // ended input exits once the last command has had time to finish, a
+    // command that blocks the reader finishes before the next read
+    if (hostEnded) {
+        if (now - hostEndTick >= HOST_EOF_MS) {
+            fflush(stdout);
+            exit(0);
+        }
+        return '\0';
+    }
+
+    n = read(STDIN_FILENO, &c, 1);
+    if (n == 0 && !hostTerminal) {
+        hostEnded = 1;
+        hostEndTick = now;
+        return '\0';
+    }
+    if (n != 1) {
+        return '\0';
+    }
+
+    // arrow keys are ESC [ A..D
+    if (hostEscape == 1) {
+        hostEscape = (c == '[') ? 2 : 0;
+        return '\0';
+    } else if (hostEscape == 2) {
+        hostEscape = 0;
+        host_input_arrow(c, now);
+        return '\0';
+    }
+
+    switch (c) {
+        case KEY_ESCAPE:
+            hostEscape = 1;
+            return '\0';
+        case KEY_USER_PB:
+            host_exti_raise(13);
+            hostHoldoff = now + EXTI_GAP_MS;
+            return '\0';
+        case KEY_JOYSTICK_PB:
+            host_exti_raise(0);
+            hostReleaseTick = now + EXTI_GAP_MS;
+            hostHoldoff = now + 2 * EXTI_GAP_MS;
+            return '\0';
+        case '\n':
+            return hostTerminal ? '\n' : '\r';
+        default:
+            return c;
+    }
+}
+
+// the terminal is set up by HAL_Init
+void BRD_debuguart_init(void) {
+}
+
+// gets a character from the debug uart, '\0' when there is none
+char BRD_debuguart_getc(void) {
+    return host_input();
+}
+
+// gets a character from the debug uart, '\0' when there is none
+char debug_getc(void) {
+    return host_input();
+}
+
+// writes a character to the debug uart
+void debug_putc(char c) {
+    putchar(c);
+}
+
+// flushes the debug uart
+void debug_flush(void) {
+    fflush(stdout);
+}
@@ -0,0 +1,179 @@
+/**
+ **************************************************************
+ * @file host/host_hal.c
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief host stand-in for the STM32F4 HAL and board support
+ *        (board: linux host, FreeRTOS POSIX port)
+ * REFERENCE: stm32f4xx_hal.c, board.c (csse3010 board support)
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * HAL_Init() - sets up the host (terminal, clock)
+ * HAL_GetTick() - gets the time since start in ms
+ * HAL_RCC_GetPCLK1Freq() - gets the (nominal) APB1 clock
+ * HAL_NVIC_SetPriority() - no-op
+ * HAL_NVIC_EnableIRQ() - enables an interrupt for host_exti_raise
+ * NVIC_ClearPendingIRQ() - no-op
+ * HAL_ADC_Init() - no-op
+ * HAL_ADC_ConfigChannel() - selects the channel a handle converts
+ * HAL_ADC_Start() - no-op
+ * HAL_ADC_PollForConversion() - loads the channel value into ADC1->DR
+ * host_adc_set() - sets the value an adc channel converts to
+ * host_exti_raise() - raises an external interrupt line and runs its handler
+ * BRD_LEDInit() - initialises the green led
+ * BRD_LEDGreenOn() - turns the green led on
+ * BRD_LEDGreenOff() - turns the green led off
+ ***************************************************************
+ */
+
+#include <time.h>
+
+#include "processor_hal.h"
+#include "board.h"
+
+// nominal apb1 clock of the nucleo-f401 (hz)
+#define HOST_PCLK1_HZ 42000000U
+
+// interrupt handlers in mylib
+void EXTI0_IRQHandler(void);
+void EXTI15_10_IRQHandler(void);
+
+// internal function declarations
+void host_terminal_init(void);
+
+uint32_t SystemCoreClock = 84000000U;
+
+// peripheral instances
+GPIO_TypeDef hostGPIOA, hostGPIOB, hostGPIOC;
+TIM_TypeDef hostTIM3, hostTIM4;
+EXTI_TypeDef hostEXTI;
+SYSCFG_TypeDef hostSYSCFG;
+RCC_TypeDef hostRCC;
+I2C_TypeDef hostI2C1;
+ADC_TypeDef hostADC1;
+
+int hostLEDGreen = 0;
+
+static struct timespec hostEpoch;
+static int hostStarted = 0;
+static uint32_t hostIRQEnabled = 0;     // bit per enabled exti handler (0 and 13)
+static uint32_t hostADCValue[HOST_ADC_CHANNELS];
+
+// sets up the host: clock epoch, centred adc inputs and the debug terminal
+HAL_StatusTypeDef HAL_Init(void) {
+    if (!hostStarted) {
+        clock_gettime(CLOCK_MONOTONIC, &hostEpoch);
+        hostStarted = 1;
+    }
+    for (int i = 0; i < HOST_ADC_CHANNELS; i++) {
+        hostADCValue[i] = HOST_ADC_MID;
+    }
+    host_terminal_init();
+    return HAL_OK;
+}
+
+// gets the time since HAL_Init in ms
+uint32_t HAL_GetTick(void) {
+    struct timespec now;
+
+    if (!hostStarted) {
+        clock_gettime(CLOCK_MONOTONIC, &hostEpoch);
+        hostStarted = 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((now.tv_sec - hostEpoch.tv_sec) * 1000 + (now.tv_nsec - hostEpoch.tv_nsec) / 1000000);
+}
+
+// gets the (nominal) APB1 clock
+uint32_t HAL_RCC_GetPCLK1Freq(void) {
+    return HOST_PCLK1_HZ;
+}
+
+// no interrupt priorities on the host
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority) {
+    (void)IRQn;
+    (void)PreemptPriority;
+    (void)SubPriority;
+}
+
+// enables an interrupt, only the exti lines are raised on the host
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn) {
+    if (IRQn == EXTI0_IRQn) {
+        hostIRQEnabled |= 1U << 0;
+    } else if (IRQn == EXTI15_10_IRQn) {
+        hostIRQEnabled |= 1U << 13;
+    }
+}
+
+// nothing is pending on the host
+void NVIC_ClearPendingIRQ(IRQn_Type IRQn) {
+    (void)IRQn;
+}
+
+// adc needs no setup on the host
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef *hadc) {
+    (void)hadc;
+    return HAL_OK;
+}
+
+// selects the channel a handle converts
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef *hadc, ADC_ChannelConfTypeDef *sConfig) {
+    if (sConfig->Channel >= HOST_ADC_CHANNELS) {
+        return HAL_ERROR;
+    }
+    hadc->Channel = sConfig->Channel;
+    return HAL_OK;
+}
+
+// conversions complete immediately on the host
+HAL_StatusTypeDef HAL_ADC_Start(ADC_HandleTypeDef *hadc) {
+    (void)hadc;
+    return HAL_OK;
+}
+
+// loads the value of the selected channel into the data register
+HAL_StatusTypeDef HAL_ADC_PollForConversion(ADC_HandleTypeDef *hadc, uint32_t Timeout) {
+    (void)Timeout;
+    hadc->Instance->DR = hostADCValue[hadc->Channel];
+    return HAL_OK;
+}
+
+// sets the value an adc channel converts to (12 bit)
+void host_adc_set(uint32_t channel, uint32_t value) {
+    if (channel < HOST_ADC_CHANNELS) {
+        hostADCValue[channel] = value & 0x0FFF;
+    }
+}
+
+// raises an external interrupt line and runs its handler, as the nvic would
+// if the line is unmasked and its interrupt is enabled
+void host_exti_raise(int line) {
+    uint32_t bit = 1U << line;
+
+    if (!(EXTI->IMR & bit) || !(hostIRQEnabled & bit)) {
+        return;
+    }
+    EXTI->PR |= bit;
+    if (line == 0) {
+        EXTI0_IRQHandler();
+    } else if (line >= 10 && line <= 15) {
+        EXTI15_10_IRQHandler();
+    }
+    EXTI->PR &= ~bit;
+}
+
+// initialises the green led
+void BRD_LEDInit(void) {
+    hostLEDGreen = 0;
+}
+
+// turns the green led on
+void BRD_LEDGreenOn(void) {
+    hostLEDGreen = 1;
+}
+
+// turns the green led off
+void BRD_LEDGreenOff(void) {
+    hostLEDGreen = 0;
+}
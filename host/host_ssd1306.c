@@ -0,0 +1,166 @@
+/**
+ **************************************************************
+ * @file host/host_ssd1306.c
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief host stand-in for the ssd1306 oled driver
+ *        (board: linux host, FreeRTOS POSIX port)
+ * REFERENCE: ssd1306.c (stm32-ssd1306)
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * ssd1306_Init() - clears the framebuffer
+ * ssd1306_Fill() - fills the framebuffer
+ * ssd1306_DrawPixel() - sets a pixel in the framebuffer
+ * ssd1306_UpdateScreen() - counts the update, dumps the frame if enabled
+ * ssd1306_WriteCommand() - runs a panel command (addressing commands only)
+ * ssd1306_WriteData() - writes bytes to the panel at its address pointer
+ * ssd1306_SetCursor() - sets the text cursor
+ * ssd1306_WriteString() - advances the cursor over the string
+ ***************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "oled_pixel.h"
+#include "oled_string.h"
+#include "fonts.h"
+
+FontDef Font_7x10 = {7, 10, NULL};
+
+uint8_t hostOledBuffer[SSD1306_HEIGHT][SSD1306_WIDTH];
+uint32_t hostOledUpdates = 0;
+
+static FILE *hostOledDump = NULL;
+static int hostOledDumpOpened = 0;
+static uint8_t hostCursorX = 0;
+static uint8_t hostCursorY = 0;
+
+// panel addressing: the column and page window, the address pointer in it, the
+// command waiting for its arguments and whether data came since the last update
+static uint8_t hostWindow[2][2] = {{0, SSD1306_WIDTH - 1}, {0, SSD1306_HEIGHT / 8 - 1}};
+static uint8_t hostColumn = 0;
+static uint8_t hostPage = 0;
+static uint8_t hostCommand = 0;
+static int hostArguments = 0;
+static int hostWritten = 0;
+
+// internal function declarations
+void host_panel_frame(void);
+
+// clears the framebuffer and opens the frame dump named by HOST_OLED
+void ssd1306_Init(void) {
+    const char *path;
+
+    memset(hostOledBuffer, 0, sizeof(hostOledBuffer));
+    if (!hostOledDumpOpened) {
+        hostOledDumpOpened = 1;
+        if ((path = getenv("HOST_OLED")) != NULL && *path) {
+            hostOledDump = fopen(path, "w");
+        }
+    }
+}
+
+// fills the framebuffer
+void ssd1306_Fill(SSD1306_COLOR color) {
+    memset(hostOledBuffer, (color == Black) ? 0 : 1, sizeof(hostOledBuffer));
+}
+
+// sets a pixel in the framebuffer, pixels off the screen are ignored
+void ssd1306_DrawPixel(uint8_t x, uint8_t y, SSD1306_COLOR color) {
+    if (x >= SSD1306_WIDTH || y >= SSD1306_HEIGHT) {
+        return;
+    }
+    hostOledBuffer[y][x] = (color == Black) ? 0 : 1;
+}
+
+// counts the screen update and appends the frame to the dump
+void ssd1306_UpdateScreen(void) {
+    char row[SSD1306_WIDTH + 1];
+
+    hostOledUpdates++;
+    if (hostOledDump == NULL) {
+        return;
+    }
+    fprintf(hostOledDump, "frame %lu\n", (unsigned long)hostOledUpdates);
+    for (int y = 0; y < SSD1306_HEIGHT; y++) {
+        for (int x = 0; x < SSD1306_WIDTH; x++) {
+            row[x] = hostOledBuffer[y][x] ? '#' : '.';
+        }
+        row[SSD1306_WIDTH] = '\0';
+        fprintf(hostOledDump, "%s\n", row);
+    }
+    fflush(hostOledDump);
+}
+
+// runs a panel command, the column (0x21) and page (0x22) windows move the
+// address pointer to their start, other commands are ignored
+void ssd1306_WriteCommand(uint8_t byte) {
+    if (hostArguments > 0) {
+        // the window start, then its end
+        int window = hostCommand - 0x21;
+        hostWindow[window][2 - hostArguments] = byte;
+        if (--hostArguments == 0) {
+            hostColumn = hostWindow[0][0];
+            hostPage = hostWindow[1][0];
+            host_panel_frame();
+        }
+        return;
+    }
+    if ((byte == 0x21) || (byte == 0x22)) {
+        hostCommand = byte;
+        hostArguments = 2;
+    }
+}
+
+// writes bytes (8 rows of a column each, bit 0 the top) at the address pointer,
+// which moves along the column window and then down the page window
+void ssd1306_WriteData(uint8_t *buffer, size_t buff_size) {
+    for (size_t i = 0; i < buff_size; i++) {
+        for (int bit = 0; bit < 8; bit++) {
+            if ((hostColumn < SSD1306_WIDTH) && (8 * hostPage + bit < SSD1306_HEIGHT)) {
+                hostOledBuffer[8 * hostPage + bit][hostColumn] = (buffer[i] >> bit) & 1;
+            }
+        }
+        if (hostColumn++ >= hostWindow[0][1]) {
+            hostColumn = hostWindow[0][0];
+            hostPage = (hostPage >= hostWindow[1][1]) ? hostWindow[1][0] : hostPage + 1;
+        }
+    }
+    hostWritten = 1;
+    host_panel_frame();
+}
+
+// counts an update once data has been written and the address pointer is back
+// at the top-left of a window covering the whole screen
+void host_panel_frame(void) {
+    if (hostWritten && (hostColumn == 0) && (hostPage == 0)
+            && (hostWindow[0][1] == SSD1306_WIDTH - 1) && (hostWindow[1][1] == SSD1306_HEIGHT / 8 - 1)) {
+        hostWritten = 0;
+        ssd1306_UpdateScreen();
+    }
+}
+
+// sets the text cursor
+void ssd1306_SetCursor(uint8_t x, uint8_t y) {
+    hostCursorX = x;
+    hostCursorY = y;
+}
+
+// advances the cursor over the string, text is not rasterised on the host
+// returns the last character written, or 0 if the string did not fit
+char ssd1306_WriteString(char *str, FontDef Font, SSD1306_COLOR color) {
+    char last = 0;
+
+    (void)color;
+    for (; *str; str++) {
+        if (hostCursorX + Font.FontWidth > SSD1306_WIDTH || hostCursorY + Font.FontHeight > SSD1306_HEIGHT) {
+            return 0;
+        }
+        hostCursorX += Font.FontWidth;
+        last = *str;
+    }
+    return last;
+}
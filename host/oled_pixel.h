@@ -0,0 +1,56 @@
+/**
+ **************************************************************
+ * @file host/oled_pixel.h
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief host stand-in for the ssd1306 pixel driver (header file)
+ *        (board: linux host, FreeRTOS POSIX port)
+ * REFERENCE: ssd1306.h (stm32-ssd1306)
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * ssd1306_Init() - clears the framebuffer
+ * ssd1306_Fill() - fills the framebuffer
+ * ssd1306_DrawPixel() - sets a pixel in the framebuffer
+ * ssd1306_UpdateScreen() - counts the update, dumps the frame if enabled
+ * ssd1306_WriteCommand() - runs a panel command (addressing commands only)
+ * ssd1306_WriteData() - writes bytes to the panel at its address pointer
+ ***************************************************************
+ * the screen is a framebuffer in memory. when HOST_OLED names a file, every
+ * update appends the frame to it as text ('#' on, '.' off). the data written
+ * with ssd1306_WriteData goes to the framebuffer as the panel would place it
+ * (horizontal addressing), and an update is counted when the address pointer
+ * is back at the top-left of the whole screen after data was written
+ ***************************************************************
+ */
+
+#ifndef OLED_PIXEL_H_
+#define OLED_PIXEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SSD1306_WIDTH 128
+#define SSD1306_HEIGHT 32
+
+typedef enum {
+    Black = 0x00,
+    White = 0x01
+} SSD1306_COLOR;
+
+#define SSD1306_BLACK Black
+#define SSD1306_WHITE White
+
+// framebuffer, one byte per pixel, and the number of screen updates
+extern uint8_t hostOledBuffer[SSD1306_HEIGHT][SSD1306_WIDTH];
+extern uint32_t hostOledUpdates;
+
+// external function declarations
+void ssd1306_Init(void);
+void ssd1306_Fill(SSD1306_COLOR color);
+void ssd1306_DrawPixel(uint8_t x, uint8_t y, SSD1306_COLOR color);
+void ssd1306_UpdateScreen(void);
+void ssd1306_WriteCommand(uint8_t byte);
+void ssd1306_WriteData(uint8_t *buffer, size_t buff_size);
+
+#endif
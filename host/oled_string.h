@@ -0,0 +1,27 @@
+/**
+ **************************************************************
+ * @file host/oled_string.h
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief host stand-in for the ssd1306 text driver (header file)
+ *        (board: linux host, FreeRTOS POSIX port)
+ * REFERENCE: ssd1306.h (stm32-ssd1306)
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * ssd1306_SetCursor() - sets the text cursor
+ * ssd1306_WriteString() - advances the cursor over the string
+ ***************************************************************
+ */
+
+#ifndef OLED_STRING_H_
+#define OLED_STRING_H_
+
+#include "oled_pixel.h"
+#include "fonts.h"
+
+// external function declarations
+void ssd1306_SetCursor(uint8_t x, uint8_t y);
+char ssd1306_WriteString(char *str, FontDef Font, SSD1306_COLOR color);
+
+#endif
@@ -0,0 +1,316 @@
+/**
+ **************************************************************
+ * @file host/processor_hal.h
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief host stand-in for the STM32F4 HAL (header file)
+ *        (board: linux host, FreeRTOS POSIX port)
+ * REFERENCE: stm32f4xx_hal.h, stm32f401xe.h
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * HAL_Init() - sets up the host (terminal, clock)
+ * HAL_GetTick() - gets the time since start in ms
+ * HAL_RCC_GetPCLK1Freq() - gets the (nominal) APB1 clock
+ * HAL_NVIC_SetPriority() - no-op
+ * HAL_NVIC_EnableIRQ() - no-op
+ * NVIC_ClearPendingIRQ() - no-op
+ * HAL_ADC_Init() - no-op
+ * HAL_ADC_ConfigChannel() - selects the channel a handle converts
+ * HAL_ADC_Start() - no-op
+ * HAL_ADC_PollForConversion() - loads the channel value into ADC1->DR
+ * host_adc_set() - sets the value an adc channel converts to
+ * host_exti_raise() - raises an external interrupt line and runs its handler
+ ***************************************************************
+ * peripherals are plain structs in memory: register writes are kept and can be
+ * read back, but nothing is driven. adc channels convert to values set with
+ * host_adc_set (mid-scale by default), external interrupts are raised from the
+ * debug uart input (see host/debug_log.h)
+ ***************************************************************
+ */
+
+#ifndef PROCESSOR_HAL_H_
+#define PROCESSOR_HAL_H_
+
+#include <stdint.h>
+
+// register access
+#define __IO volatile
+#define SET_BIT(REG, BIT) ((REG) |= (BIT))
+#define CLEAR_BIT(REG, BIT) ((REG) &= ~(BIT))
+#define READ_BIT(REG, BIT) ((REG) & (BIT))
+#define WRITE_REG(REG, VAL) ((REG) = (VAL))
+#define READ_REG(REG) ((REG))
+#define MODIFY_REG(REG, CLEARMASK, SETMASK) WRITE_REG((REG), (((READ_REG(REG)) & (~(CLEARMASK))) | (SETMASK)))
+
+// hal status
+typedef enum {
+    HAL_OK = 0x00,
+    HAL_ERROR = 0x01,
+    HAL_BUSY = 0x02,
+    HAL_TIMEOUT = 0x03
+} HAL_StatusTypeDef;
+
+typedef enum {
+    DISABLE = 0,
+    ENABLE = !DISABLE
+} FunctionalState;
+
+// interrupt numbers used by mylib
+typedef enum {
+    EXTI0_IRQn = 6,
+    TIM3_IRQn = 29,
+    TIM4_IRQn = 30,
+    EXTI15_10_IRQn = 40
+} IRQn_Type;
+
+// peripheral register blocks
+typedef struct {
+    __IO uint32_t MODER;
+    __IO uint32_t OTYPER;
+    __IO uint32_t OSPEEDR;
+    __IO uint32_t PUPDR;
+    __IO uint32_t IDR;
+    __IO uint32_t ODR;
+    __IO uint32_t BSRR;
+    __IO uint32_t LCKR;
+    __IO uint32_t AFR[2];
+} GPIO_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t SMCR;
+    __IO uint32_t DIER;
+    __IO uint32_t SR;
+    __IO uint32_t EGR;
+    __IO uint32_t CCMR1;
+    __IO uint32_t CCMR2;
+    __IO uint32_t CCER;
+    __IO uint32_t CNT;
+    __IO uint32_t PSC;
+    __IO uint32_t ARR;
+    __IO uint32_t RCR;
+    __IO uint32_t CCR1;
+    __IO uint32_t CCR2;
+    __IO uint32_t CCR3;
+    __IO uint32_t CCR4;
+    __IO uint32_t BDTR;
+    __IO uint32_t DCR;
+    __IO uint32_t DMAR;
+    __IO uint32_t OR;
+} TIM_TypeDef;
+
+typedef struct {
+    __IO uint32_t IMR;
+    __IO uint32_t EMR;
+    __IO uint32_t RTSR;
+    __IO uint32_t FTSR;
+    __IO uint32_t SWIER;
+    __IO uint32_t PR;
+} EXTI_TypeDef;
+
+typedef struct {
+    __IO uint32_t MEMRMP;
+    __IO uint32_t PMC;
+    __IO uint32_t EXTICR[4];
+    __IO uint32_t CMPCR;
+} SYSCFG_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR;
+    __IO uint32_t PLLCFGR;
+    __IO uint32_t CFGR;
+    __IO uint32_t CIR;
+    __IO uint32_t AHB1RSTR;
+    __IO uint32_t AHB2RSTR;
+    __IO uint32_t APB1RSTR;
+    __IO uint32_t APB2RSTR;
+    __IO uint32_t AHB1ENR;
+    __IO uint32_t AHB2ENR;
+    __IO uint32_t APB1ENR;
+    __IO uint32_t APB2ENR;
+} RCC_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t OAR1;
+    __IO uint32_t OAR2;
+    __IO uint32_t DR;
+    __IO uint32_t SR1;
+    __IO uint32_t SR2;
+    __IO uint32_t CCR;
+    __IO uint32_t TRISE;
+    __IO uint32_t FLTR;
+} I2C_TypeDef;
+
+typedef struct {
+    __IO uint32_t SR;
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t SMPR1;
+    __IO uint32_t SMPR2;
+    __IO uint32_t JOFR[4];
+    __IO uint32_t HTR;
+    __IO uint32_t LTR;
+    __IO uint32_t SQR1;
+    __IO uint32_t SQR2;
+    __IO uint32_t SQR3;
+    __IO uint32_t JSQR;
+    __IO uint32_t JDR[4];
+    __IO uint32_t DR;
+} ADC_TypeDef;
+
+// core clock (hz)
+extern uint32_t SystemCoreClock;
+
+// peripheral instances
+extern GPIO_TypeDef hostGPIOA, hostGPIOB, hostGPIOC;
+extern TIM_TypeDef hostTIM3, hostTIM4;
+extern EXTI_TypeDef hostEXTI;
+extern SYSCFG_TypeDef hostSYSCFG;
+extern RCC_TypeDef hostRCC;
+extern I2C_TypeDef hostI2C1;
+extern ADC_TypeDef hostADC1;
+
+#define GPIOA (&hostGPIOA)
+#define GPIOB (&hostGPIOB)
+#define GPIOC (&hostGPIOC)
+#define TIM3 (&hostTIM3)
+#define TIM4 (&hostTIM4)
+#define EXTI (&hostEXTI)
+#define SYSCFG (&hostSYSCFG)
+#define RCC (&hostRCC)
+#define I2C1 (&hostI2C1)
+#define ADC1 (&hostADC1)
+#define ADC1_BASE ((uintptr_t)&hostADC1)
+
+// clocks are always running
+#define __GPIOA_CLK_ENABLE() do { } while (0)
+#define __GPIOB_CLK_ENABLE() do { } while (0)
+#define __GPIOC_CLK_ENABLE() do { } while (0)
+#define __TIM3_CLK_ENABLE() do { } while (0)
+#define __TIM4_CLK_ENABLE() do { } while (0)
+#define __I2C1_CLK_ENABLE() do { } while (0)
+#define __ADC1_CLK_ENABLE() do { } while (0)
+
+// gpio
+#define GPIO_MODE_AF_OD 0x00000012U
+#define GPIO_PULLUP 0x00000001U
+#define GPIO_SPEED_LOW 0x00000000U
+#define GPIO_SPEED_FAST 0x00000002U
+#define GPIO_AF2_TIM3 ((uint8_t)0x02)
+#define GPIO_AF4_I2C1 ((uint8_t)0x04)
+
+// rcc, syscfg and exti
+#define RCC_APB2ENR_SYSCFGEN (1U << 14)
+#define SYSCFG_EXTICR1_EXTI0 (0xFU << 0)
+#define SYSCFG_EXTICR1_EXTI0_PC (0x2U << 0)
+#define SYSCFG_EXTICR4_EXTI13 (0xFU << 4)
+#define SYSCFG_EXTICR4_EXTI13_PC (0x2U << 4)
+#define EXTI_IMR_IM0 (1U << 0)
+#define EXTI_IMR_IM13 (1U << 13)
+#define EXTI_RTSR_TR0 (1U << 0)
+#define EXTI_RTSR_TR13 (1U << 13)
+#define EXTI_FTSR_TR0 (1U << 0)
+#define EXTI_FTSR_TR13 (1U << 13)
+#define EXTI_PR_PR0 (1U << 0)
+#define EXTI_PR_PR13 (1U << 13)
+
+// timers
+#define TIM_CR1_CEN (1U << 0)
+#define TIM_CR1_DIR (1U << 4)
+#define TIM_CR1_ARPE (1U << 7)
+#define TIM_DIER_UIE (1U << 0)
+#define TIM_DIER_CC1IE (1U << 1)
+#define TIM_DIER_CC2IE (1U << 2)
+#define TIM_SR_CC1IF (1U << 1)
+#define TIM_CCMR1_CC1S (0x3U << 0)
+#define TIM_CCMR1_CC1S_0 (0x1U << 0)
+#define TIM_CCMR1_IC1PSC (0x3U << 2)
+#define TIM_CCMR1_IC1F (0xFU << 4)
+#define TIM_CCMR1_OC1M (0x7U << 4)
+#define TIM_CCMR1_OC2M (0x7U << 12)
+#define TIM_CCER_CC1E (1U << 0)
+#define TIM_CCER_CC1P (1U << 1)
+
+// i2c
+#define I2C_CR1_PE (1U << 0)
+#define I2C_CR1_ENGC (1U << 6)
+#define I2C_CR1_NOSTRETCH (1U << 7)
+#define I2C_CR2_FREQ (0x3FU << 0)
+#define I2C_OAR1_ADD0 (1U << 0)
+#define I2C_OAR1_ADD1_7 (0x7FU << 1)
+#define I2C_OAR1_ADD8_9 (0x3U << 8)
+#define I2C_OAR1_ADDMODE (1U << 15)
+#define I2C_OAR2_ENDUAL (1U << 0)
+#define I2C_OAR2_ADD2 (0x7FU << 1)
+#define I2C_CCR_CCR (0xFFFU << 0)
+#define I2C_CCR_DUTY (1U << 14)
+#define I2C_CCR_FS (1U << 15)
+#define I2C_TRISE_TRISE (0x3FU << 0)
+#define I2C_DUTYCYCLE_2 0x00000000U
+#define I2C_GENERALCALL_DISABLE 0x00000000U
+#define I2C_NOSTRETCH_DISABLE 0x00000000U
+#define I2C_ADDRESSINGMODE_7BIT 0x00004000U
+#define I2C_DUALADDRESS_DISABLE 0x00000000U
+#define I2C_FREQRANGE(__PCLK__) ((__PCLK__) / 1000000U)
+#define I2C_RISE_TIME(__FREQRANGE__, __SPEED__) (((__SPEED__) <= 100000U) ? ((__FREQRANGE__) + 1U) : ((((__FREQRANGE__) * 300U) / 1000U) + 1U))
+#define I2C_SPEED(__PCLK__, __SPEED__, __DUTYCYCLE__) (((__PCLK__) / ((__SPEED__) << 1U)) & I2C_CCR_CCR)
+
+// adc
+#define ADC_CLOCKPRESCALER_PCLK_DIV2 0x00000000U
+#define ADC_RESOLUTION12b 0x00000000U
+#define ADC_EXTERNALTRIGCONVEDGE_NONE 0x00000000U
+#define ADC_EXTERNALTRIGCONV_T1_CC1 0x00000000U
+#define ADC_DATAALIGN_RIGHT 0x00000000U
+#define ADC_SAMPLETIME_3CYCLES 0x00000000U
+#define ADC_CHANNEL_1 ((uint32_t)1)
+#define ADC_CHANNEL_4 ((uint32_t)4)
+#define HOST_ADC_CHANNELS 19
+#define HOST_ADC_MID 2048       // centred joystick
+
+typedef struct {
+    uint32_t ClockPrescaler;
+    uint32_t Resolution;
+    uint32_t DataAlign;
+    uint32_t ScanConvMode;
+    uint32_t EOCSelection;
+    uint32_t ContinuousConvMode;
+    uint32_t NbrOfConversion;
+    uint32_t DiscontinuousConvMode;
+    uint32_t NbrOfDiscConversion;
+    uint32_t ExternalTrigConv;
+    uint32_t ExternalTrigConvEdge;
+    uint32_t DMAContinuousRequests;
+} ADC_InitTypeDef;
+
+typedef struct {
+    ADC_TypeDef *Instance;
+    ADC_InitTypeDef Init;
+    uint32_t Channel;       // host: channel selected by HAL_ADC_ConfigChannel
+} ADC_HandleTypeDef;
+
+typedef struct {
+    uint32_t Channel;
+    uint32_t Rank;
+    uint32_t SamplingTime;
+    uint32_t Offset;
+} ADC_ChannelConfTypeDef;
+
+// external function declarations
+HAL_StatusTypeDef HAL_Init(void);
+uint32_t HAL_GetTick(void);
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority);
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn);
+void NVIC_ClearPendingIRQ(IRQn_Type IRQn);
+HAL_StatusTypeDef HAL_ADC_Init(ADC_HandleTypeDef *hadc);
+HAL_StatusTypeDef HAL_ADC_ConfigChannel(ADC_HandleTypeDef *hadc, ADC_ChannelConfTypeDef *sConfig);
+HAL_StatusTypeDef HAL_ADC_Start(ADC_HandleTypeDef *hadc);
+HAL_StatusTypeDef HAL_ADC_PollForConversion(ADC_HandleTypeDef *hadc, uint32_t Timeout);
+void host_adc_set(uint32_t channel, uint32_t value);
+void host_exti_raise(int line);
+
+#endif
@@ -0,0 +1,578 @@
+/**
+ **************************************************************
+ * @file mylib/s4640878_CAG_bench.c
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief CAGBench - simulator engine benchmarks
+ *        (board: nucleo-f401)
+ * REFERENCE: csse3010_project.pdf (spec sheet)
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * s4640878_lib_CAG_bench_run() - times one engine on one seed and universe size
+ * s4640878_lib_CAG_bench_get_sizes() - gets the number of universe sizes in the corpus
+ * s4640878_lib_CAG_bench_run_case() - runs one case of the benchmark corpus
+ * s4640878_lib_CAG_bench_format_header() - writes the CSV header
+ * s4640878_lib_CAG_bench_format() - writes a result as a CSV row
+ * s4640878_lib_CAG_bench_set_threads() - sets the threads of the parallel engine (hosts)
+ * s4640878_lib_CAG_bench_set_kernel() - sets the tile kernel of the packed engines
+ * s4640878_lib_CAG_bench_set_limit() - sets the longest time a step engine is run for
+ * s4640878_lib_CAG_bench_check() - checks a step engine against the int engine, or
+ *      hashlife through a macrocell save and load and against the packed engine
+ ***************************************************************
+ * every run works on its own universe, so the simulator is not disturbed
+ * on the board the time is the DWT cycle counter, on a host the monotonic clock
+ ***************************************************************
+ */
+
+#include "s4640878_CAG_bench.h"
+#include "processor_hal.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// the cortex-m core (cmsis) has a dwt cycle counter
+#ifdef DWT
+#define CAG_BENCH_CYCLES 1      // dwt cycle counter, 32 bits
+#else
+#include <time.h>
+#define CAG_BENCH_CYCLES 0      // monotonic clock in ns
+#endif
+
+// lifeforms of draw_* as rows of cells, bit x of row y is cell (x, y)
+#define LIFEFORMS 7
+#define LIFEFORM_ROWS 4
+#define LIFEFORM_SPACING 8      // one lifeform or glider per 8x8 block
+#define SCATTERED_SPACING 128   // one glider per 128x128 block
+
+static const uint8_t lifeform[LIFEFORMS][LIFEFORM_ROWS] = {
+    {0x3, 0x3, 0x0, 0x0},       // block
+    {0x6, 0x9, 0x6, 0x0},       // beehive
+    {0x6, 0x9, 0xA, 0x4},       // loaf
+    {0x0, 0x7, 0x0, 0x0},       // blinker
+    {0x0, 0xE, 0x7, 0x0},       // toad
+    {0x3, 0x1, 0x8, 0xC},       // beacon
+    {0x1, 0x6, 0x3, 0x0},       // glider
+};
+#define GLIDER_LIFEFORM 6
+
+static const int benchSize[][2] = CAG_BENCH_SIZES;
+#if CAG_PARALLEL
+static const char *engineName[CAG_BENCH_ENGINES] = {"int", "packed", "hashlife", "bytes", "sparse", "parallel"};
+static int benchThreads = 0;        // parallel engine threads, 0: one per core
+static caParallel_t *benchPool;     // parallel engine of the running benchmark
+#else
+static const char *engineName[CAG_BENCH_ENGINES] = {"int", "packed", "hashlife", "bytes", "sparse"};
+#endif
+static caBytes_t *benchBytes;       // byte engine of the running benchmark
+static caSparse_t *benchSparse;     // sparse engine of the running benchmark
+static const char *seedName[CAG_BENCH_SEEDS] = {"empty", "random25", "random50", "gliders", "lifeforms", "scattered"};
+static const char *kernelName[] = {"scalar", "sse2", "avx2", "lut3x3", "lut4x4"};
+static int benchKernel = CAG_KERNEL_AVX2;   // best kernel the cpu has
+static uint32_t benchLimitMs = 0;           // longest run of a step engine, 0: none
+
+// macrocell text held in memory by the hashlife check
+typedef struct caBenchText {
+    char *text;
+    uint32_t length;        // characters written
+    uint32_t capacity;
+    uint32_t next;          // next character to read
+    int failed;             // out of memory while writing
+} caBenchText_t;
+
+// internal function declarations
+void CAG_bench_seed(caUniverse_t *universe, int seed);
+void CAG_bench_draw(caUniverse_t *universe, int form, int x, int y);
+void CAG_bench_clock_init(void);
+uint64_t CAG_bench_clock(void);
+uint64_t CAG_bench_since(uint64_t mark);
+caUniverse_t *CAG_bench_begin(caBenchResult_t *result, int engine, int seed, int width, int height);
+int CAG_bench_step(caUniverse_t *universe, int engine);
+void CAG_bench_end(caBenchResult_t *result, caUniverse_t *universe);
+void CAG_bench_write_char(char c, void *arg);
+int CAG_bench_read_char(void *arg);
+int CAG_bench_hashlife_fits(caUniverse_t *universe, uint32_t generations);
+void CAG_bench_check_hashlife(caBenchResult_t *result, caUniverse_t *universe, caUniverse_t *copy, int seed, uint32_t generations);
+
+// fills a universe with a seed, random seeds depend only on the universe size
+void CAG_bench_seed(caUniverse_t *universe, int seed) {
+    uint32_t state = 0x9E3779B9u ^ ((uint32_t)universe->width << 16) ^ (uint32_t)universe->height;
+    int form = 0;
+
+    for (int y = 0; y < universe->height; y++) {
+        for (int x = 0; x < universe->width; x++) {
+            // xorshift32
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            if (((seed == CAG_BENCH_RANDOM25) && ((state & 3) == 0))
+                    || ((seed == CAG_BENCH_RANDOM50) && (state & 1))) {
+                s4640878_lib_CAG_universe_set_cell(universe, x, y, 1);
+            }
+        }
+    }
+    if ((seed == CAG_BENCH_GLIDERS) || (seed == CAG_BENCH_LIFEFORMS) || (seed == CAG_BENCH_SCATTERED)) {
+        int spacing = (seed == CAG_BENCH_SCATTERED) ? SCATTERED_SPACING : LIFEFORM_SPACING;
+        for (int y = 0; y + LIFEFORM_ROWS <= universe->height; y += spacing) {
+            for (int x = 0; x + LIFEFORM_ROWS <= universe->width; x += spacing) {
+                CAG_bench_draw(universe, (seed == CAG_BENCH_LIFEFORMS) ? form : GLIDER_LIFEFORM, x, y);
+                form = (form + 1) % LIFEFORMS;
+            }
+        }
+    }
+}
+
+// draws a lifeform with its top-left corner at (x, y)
+void CAG_bench_draw(caUniverse_t *universe, int form, int x, int y) {
+    for (int row = 0; row < LIFEFORM_ROWS; row++) {
+        for (int col = 0; col < LIFEFORM_ROWS; col++) {
+            if ((lifeform[form][row] >> col) & 1) {
+                s4640878_lib_CAG_universe_set_cell(universe, x + col, y + row, 1);
+            }
+        }
+    }
+}
+
+// starts the cycle counter (board), without resetting it: the jitter and oled
+// timings read it too, and CAG_bench_since handles the wrap
+void CAG_bench_clock_init(void) {
+#if CAG_BENCH_CYCLES
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+// returns the time: core cycles (board) or ns (host)
+uint64_t CAG_bench_clock(void) {
+#if CAG_BENCH_CYCLES
+    return DWT->CYCCNT;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+#endif
+}
+
+// returns the time since a clock reading
+// the cycle counter wraps every 51s at 84MHz, so it is read at least once a generation
+uint64_t CAG_bench_since(uint64_t mark) {
+#if CAG_BENCH_CYCLES
+    return (uint32_t)(DWT->CYCCNT - (uint32_t)mark);
+#else
+    return CAG_bench_clock() - mark;
+#endif
+}
+
+// clears a result and creates the seeded universe of a run (and the byte or
+// sparse engine, or the thread pool of the parallel engine), NULL if out of
+// memory (status CAG_BENCH_NOMEM)
+caUniverse_t *CAG_bench_begin(caBenchResult_t *result, int engine, int seed, int width, int height) {
+    result->engine = engine;
+    result->seed = seed;
+    result->width = width;
+    result->height = height;
+    result->generations = 0;
+    result->ms = 0;
+    result->psPerCell = 0;
+    result->gensPerSec = 0;
+    result->cyclesPerGen = 0;
+    result->memory = 0;
+    result->population = 0;
+    result->status = CAG_BENCH_OK;
+    result->threads = 1;
+    result->kernel = -1;
+
+    caUniverse_t *universe = s4640878_lib_CAG_universe_create(width, height);
+    if (universe == NULL) {
+        result->status = CAG_BENCH_NOMEM;
+        return NULL;
+    }
+    CAG_bench_seed(universe, seed);
+    result->memory = s4640878_lib_CAG_universe_get_memory(universe);
+    if ((engine != CAG_BENCH_INT) && (engine != CAG_BENCH_HASHLIFE) && (engine != CAG_BENCH_BYTES)
+            && (engine != CAG_BENCH_SPARSE)) {
+        result->kernel = s4640878_lib_CAG_universe_set_kernel(universe, benchKernel);
+    }
+    if (engine == CAG_BENCH_BYTES) {
+        benchBytes = s4640878_lib_CAG_bytes_create(width, height);
+        if (benchBytes == NULL) {
+            result->status = CAG_BENCH_NOMEM;
+            s4640878_lib_CAG_universe_delete(universe);
+            return NULL;
+        }
+    }
+    if (engine == CAG_BENCH_SPARSE) {
+        benchSparse = s4640878_lib_CAG_sparse_create();
+        if (benchSparse == NULL) {
+            result->status = CAG_BENCH_NOMEM;
+            s4640878_lib_CAG_universe_delete(universe);
+            return NULL;
+        }
+    }
+#if CAG_PARALLEL
+    // the threads are started before the clock
+    if (engine == CAG_BENCH_PARALLEL) {
+        benchPool = s4640878_lib_CAG_parallel_create(benchThreads);
+        if (benchPool == NULL) {
+            result->status = CAG_BENCH_NOMEM;
+            s4640878_lib_CAG_universe_delete(universe);
+            return NULL;
+        }
+        result->threads = s4640878_lib_CAG_parallel_get_threads(benchPool);
+    }
+#endif
+    return universe;
+}
+
+// computes one generation with a step engine (int, packed, bytes, sparse or
+// parallel), returns CAG_BENCH_OK, or CAG_BENCH_NOMEM if the sparse sets could
+// not grow. the byte engine steps its own cells, loaded from the universe beforehand
+int CAG_bench_step(caUniverse_t *universe, int engine) {
+    if (engine == CAG_BENCH_INT) {
+        s4640878_lib_CAG_universe_step_reference(universe);
+    } else if (engine == CAG_BENCH_BYTES) {
+        s4640878_lib_CAG_bytes_step(benchBytes);
+    } else if (engine == CAG_BENCH_SPARSE) {
+        if (s4640878_lib_CAG_sparse_step(benchSparse, universe) != CAG_SPARSE_OK) {
+            return CAG_BENCH_NOMEM;
+        }
+#if CAG_PARALLEL
+    } else if (engine == CAG_BENCH_PARALLEL) {
+        s4640878_lib_CAG_parallel_step(benchPool, universe);
+#endif
+    } else {
+        s4640878_lib_CAG_universe_step(universe);
+    }
+    return CAG_BENCH_OK;
+}
+
+// adds the step engine memory and the population to a result and frees the run
+void CAG_bench_end(caBenchResult_t *result, caUniverse_t *universe) {
+    if (result->engine == CAG_BENCH_INT) {
+        // the two int copies of the reference step
+        result->memory += 2 * (result->width + 2) * (result->height + 2) * sizeof(int);
+    }
+    if (benchBytes != NULL) {
+        result->memory += s4640878_lib_CAG_bytes_get_memory(benchBytes);
+        s4640878_lib_CAG_bytes_delete(benchBytes);
+        benchBytes = NULL;
+    }
+    if (benchSparse != NULL) {
+        // the sets as grown by the last generation
+        result->memory += s4640878_lib_CAG_sparse_get_memory(benchSparse);
+        s4640878_lib_CAG_sparse_delete(benchSparse);
+        benchSparse = NULL;
+    }
+#if CAG_PARALLEL
+    if (benchPool != NULL) {
+        result->memory += s4640878_lib_CAG_parallel_get_memory(benchPool);
+        s4640878_lib_CAG_parallel_delete(benchPool);
+        benchPool = NULL;
+    }
+#endif
+    result->population = s4640878_lib_CAG_universe_get_population(universe);
+    s4640878_lib_CAG_universe_delete(universe);
+}
+
+// times an engine computing generations from a seed in a width x height universe
+// with a dead boundary and life, returns the status (also kept in result)
+int s4640878_lib_CAG_bench_run(caBenchResult_t *result, int engine, int seed, int width, int height, uint32_t generations) {
+    uint64_t elapsed = 0;
+    caHashlife_t *hashlife = NULL;
+
+    caUniverse_t *universe = CAG_bench_begin(result, engine, seed, width, height);
+    if (universe == NULL) {
+        return result->status;
+    }
+    CAG_bench_clock_init();
+
+    if (engine == CAG_BENCH_HASHLIFE) {
+        hashlife = s4640878_lib_CAG_hashlife_create(CAG_HASHLIFE_NODES);
+        if (hashlife == NULL) {
+            result->status = CAG_BENCH_NOMEM;
+        } else {
+            // one jump per set bit of the generations, the largest first
+            int fits = CAG_bench_hashlife_fits(universe, generations);
+            uint64_t mark = CAG_bench_clock();
+            s4640878_lib_CAG_hashlife_load_universe(hashlife, universe);
+            elapsed += CAG_bench_since(mark);
+            for (int k = 31; (k >= 0) && (result->status == CAG_BENCH_OK); k--) {
+                if ((generations >> k) & 1) {
+                    mark = CAG_bench_clock();
+                    if (s4640878_lib_CAG_hashlife_jump(hashlife, k) == CAG_HASHLIFE_OK) {
+                        result->generations += (uint32_t)1 << k;
+                    } else {
+                        result->status = CAG_BENCH_FULL;
+                    }
+                    elapsed += CAG_bench_since(mark);
+                }
+            }
+            mark = CAG_bench_clock();
+            s4640878_lib_CAG_hashlife_store_universe(hashlife, universe);
+            elapsed += CAG_bench_since(mark);
+            result->memory += s4640878_lib_CAG_hashlife_get_memory(hashlife);
+            s4640878_lib_CAG_hashlife_delete(hashlife);
+            if ((result->status == CAG_BENCH_OK) && !fits) {
+                result->status = CAG_BENCH_EDGE;
+            }
+        }
+    } else {
+        // the byte engine copies the cells in once and writes the changed cells
+        // back every generation as the simulator does, timed with the steps
+        // with a limit, the generations stop once it is reached (the rates are
+        // of the generations computed)
+#if CAG_BENCH_CYCLES
+        uint64_t limit = (uint64_t)benchLimitMs * (SystemCoreClock / 1000);
+#else
+        uint64_t limit = (uint64_t)benchLimitMs * 1000000;
+#endif
+        uint64_t mark = CAG_bench_clock(), start = mark;
+        if (engine == CAG_BENCH_BYTES) {
+            s4640878_lib_CAG_bytes_load_universe(benchBytes, universe);
+        }
+        for (uint32_t g = 0; (g < generations) && (result->status == CAG_BENCH_OK)
+                && ((limit == 0) || (CAG_bench_since(start) < limit)); g++) {
+            result->status = CAG_bench_step(universe, engine);
+            if (engine == CAG_BENCH_BYTES) {
+                s4640878_lib_CAG_bytes_store_universe(benchBytes, universe);
+            }
+            if (result->status == CAG_BENCH_OK) {
+                result->generations++;
+            }
+#if CAG_BENCH_CYCLES
+            elapsed += CAG_bench_since(mark);
+            mark = CAG_bench_clock();
+#endif
+        }
+#if CAG_BENCH_CYCLES
+        elapsed += CAG_bench_since(mark);
+#else
+        elapsed = CAG_bench_since(mark);
+#endif
+    }
+    CAG_bench_end(result, universe);
+
+    // elapsed time in ns
+#if CAG_BENCH_CYCLES
+    if (result->generations > 0) {
+        result->cyclesPerGen = (uint32_t)(elapsed / result->generations);
+    }
+    elapsed = elapsed * 1000 / (SystemCoreClock / 1000000);
+#endif
+    uint64_t cellGens = (uint64_t)width * height * result->generations;
+    result->ms = (uint32_t)(elapsed / 1000000);
+    if (cellGens > 0) {
+        result->psPerCell = (uint32_t)(elapsed * 1000 / cellGens);
+    }
+    if (elapsed > 0) {
+        result->gensPerSec = (uint32_t)((uint64_t)result->generations * 1000000000u / elapsed);
+    }
+    return result->status;
+}
+
+// appends a character to the macrocell text
+void CAG_bench_write_char(char c, void *arg) {
+    caBenchText_t *text = arg;
+    if (text->length == text->capacity) {
+        uint32_t capacity = (text->capacity == 0) ? 1024 : text->capacity * 2;
+        char *grown = realloc(text->text, capacity);
+        if (grown == NULL) {
+            text->failed = 1;
+            return;
+        }
+        text->text = grown;
+        text->capacity = capacity;
+    }
+    text->text[text->length++] = c;
+}
+
+// reads the next character of the macrocell text, -1 at the end
+int CAG_bench_read_char(void *arg) {
+    caBenchText_t *text = arg;
+    return (text->next < text->length) ? (unsigned char)text->text[text->next++] : -1;
+}
+
+// returns 1 if jumping the generations gives the cells stepping them would
+// (hashlife_can_jump for the smallest power of 2 covering them)
+int CAG_bench_hashlife_fits(caUniverse_t *universe, uint32_t generations) {
+    int k = 0;
+    while ((k < 32) && (((uint64_t)1 << k) < generations)) {
+        k++;
+    }
+    return s4640878_lib_CAG_hashlife_can_jump(universe, k);
+}
+
+// jumps the seed in universe the generations with hashlife (as a run does), then
+// saves the pattern as a macrocell, loads it into a second engine and stores
+// both, universe from the first and copy from the second, comparing every cell
+// if no cell can reach the universe edge, the seed is then stepped the
+// generations in copy with the packed engine and compared with the jump too
+void CAG_bench_check_hashlife(caBenchResult_t *result, caUniverse_t *universe, caUniverse_t *copy, int seed, uint32_t generations) {
+    int fits = CAG_bench_hashlife_fits(universe, generations);
+    caBenchText_t text = {0};
+    caHashlife_t *hashlife = s4640878_lib_CAG_hashlife_create(CAG_HASHLIFE_NODES);
+    caHashlife_t *loaded = s4640878_lib_CAG_hashlife_create(CAG_HASHLIFE_NODES);
+
+    if ((hashlife == NULL) || (loaded == NULL)) {
+        result->status = CAG_BENCH_NOMEM;
+    } else {
+        s4640878_lib_CAG_hashlife_load_universe(hashlife, universe);
+        for (int k = 31; (k >= 0) && (result->status == CAG_BENCH_OK); k--) {
+            if (((generations >> k) & 1) && (s4640878_lib_CAG_hashlife_jump(hashlife, k) != CAG_HASHLIFE_OK)) {
+                result->status = CAG_BENCH_FULL;
+            }
+        }
+    }
+    if (result->status == CAG_BENCH_OK) {
+        if ((s4640878_lib_CAG_hashlife_save_macrocell(hashlife, CAG_bench_write_char, &text) != CAG_HASHLIFE_OK)
+                || text.failed) {
+            result->status = CAG_BENCH_NOMEM;
+        } else if (s4640878_lib_CAG_hashlife_load_macrocell(loaded, CAG_bench_read_char, &text) != CAG_HASHLIFE_OK) {
+            result->status = CAG_BENCH_MISMATCH;
+        }
+    }
+    if (result->status == CAG_BENCH_OK) {
+        s4640878_lib_CAG_hashlife_store_universe(hashlife, universe);
+        s4640878_lib_CAG_hashlife_store_universe(loaded, copy);
+        for (int y = 0; (y < result->height) && (result->status == CAG_BENCH_OK); y++) {
+            for (int x = 0; x < result->width; x++) {
+                if (s4640878_lib_CAG_universe_get_cell(universe, x, y) != s4640878_lib_CAG_universe_get_cell(copy, x, y)) {
+                    result->status = CAG_BENCH_MISMATCH;
+                    break;
+                }
+            }
+        }
+    }
+    if ((result->status == CAG_BENCH_OK) && !fits) {
+        result->status = CAG_BENCH_EDGE;
+    } else if (result->status == CAG_BENCH_OK) {
+        s4640878_lib_CAG_universe_clear(copy);
+        CAG_bench_seed(copy, seed);
+        for (uint32_t g = 0; g < generations; g++) {
+            s4640878_lib_CAG_universe_step(copy);
+        }
+        // hashlife keeps no ages, only whether a cell is alive is compared
+        for (int y = 0; (y < result->height) && (result->status == CAG_BENCH_OK); y++) {
+            for (int x = 0; x < result->width; x++) {
+                if ((s4640878_lib_CAG_universe_get_cell(universe, x, y) > 0) != (s4640878_lib_CAG_universe_get_cell(copy, x, y) > 0)) {
+                    result->status = CAG_BENCH_MISMATCH;
+                    break;
+                }
+            }
+        }
+    }
+    if ((result->status == CAG_BENCH_OK) || (result->status == CAG_BENCH_EDGE)) {
+        result->generations = generations;
+    }
+    if (hashlife != NULL) {
+        result->memory += s4640878_lib_CAG_hashlife_get_memory(hashlife) + text.capacity;
+        s4640878_lib_CAG_hashlife_delete(hashlife);
+    }
+    if (loaded != NULL) {
+        result->memory += s4640878_lib_CAG_hashlife_get_memory(loaded);
+        s4640878_lib_CAG_hashlife_delete(loaded);
+    }
+    free(text.text);
+}
+
+// steps a step engine and the int engine (the per-cell loop) side by side from a
+// seed and compares every cell after each generation, untimed. generations is
+// the number that matched, the status CAG_BENCH_MISMATCH if one did not
+// hashlife is checked once at the end: the jumped pattern must survive a
+// macrocell save and load cell for cell and match the packed engine, unless a
+// cell could reach the universe edge hashlife does not model (CAG_BENCH_EDGE)
+int s4640878_lib_CAG_bench_check(caBenchResult_t *result, int engine, int seed, int width, int height, uint32_t generations) {
+    caUniverse_t *universe = CAG_bench_begin(result, engine, seed, width, height);
+    if (universe == NULL) {
+        return result->status;
+    }
+    caUniverse_t *reference = s4640878_lib_CAG_universe_create(width, height);
+    if (reference == NULL) {
+        result->status = CAG_BENCH_NOMEM;
+    } else if (engine == CAG_BENCH_HASHLIFE) {
+        CAG_bench_check_hashlife(result, universe, reference, seed, generations);
+        result->memory += s4640878_lib_CAG_universe_get_memory(reference);
+        s4640878_lib_CAG_universe_delete(reference);
+    } else {
+        CAG_bench_seed(reference, seed);
+        if (engine == CAG_BENCH_BYTES) {
+            s4640878_lib_CAG_bytes_load_universe(benchBytes, universe);
+        }
+        for (uint32_t g = 0; (g < generations) && (result->status == CAG_BENCH_OK); g++) {
+            result->status = CAG_bench_step(universe, engine);
+            if (engine == CAG_BENCH_BYTES) {
+                s4640878_lib_CAG_bytes_store_universe(benchBytes, universe);
+            }
+            s4640878_lib_CAG_universe_step_reference(reference);
+            for (int y = 0; (y < height) && (result->status == CAG_BENCH_OK); y++) {
+                for (int x = 0; x < width; x++) {
+                    if (s4640878_lib_CAG_universe_get_cell(universe, x, y) != s4640878_lib_CAG_universe_get_cell(reference, x, y)) {
+                        result->status = CAG_BENCH_MISMATCH;
+                        break;
+                    }
+                }
+            }
+            if (result->status == CAG_BENCH_OK) {
+                result->generations++;
+            }
+        }
+        result->memory += s4640878_lib_CAG_universe_get_memory(reference);
+        s4640878_lib_CAG_universe_delete(reference);
+    }
+    CAG_bench_end(result, universe);
+    return result->status;
+}
+
+// returns the number of universe sizes in the corpus (CAG_BENCH_SIZES)
+int s4640878_lib_CAG_bench_get_sizes(void) {
+    return sizeof(benchSize) / sizeof(benchSize[0]);
+}
+
+// runs case index (0 .. CAG_BENCH_CASES - 1) of the corpus, engines of one seed
+// and size are next to each other, returns the status
+int s4640878_lib_CAG_bench_run_case(caBenchResult_t *result, int index, uint32_t generations) {
+    int engine = index % CAG_BENCH_ENGINES;
+    int seed = (index / CAG_BENCH_ENGINES) % CAG_BENCH_SEEDS;
+    int size = index / (CAG_BENCH_ENGINES * CAG_BENCH_SEEDS);
+    return s4640878_lib_CAG_bench_run(result, engine, seed, benchSize[size][0], benchSize[size][1], generations);
+}
+
+// writes the CSV header (no line ending), returns its length
+int s4640878_lib_CAG_bench_format_header(char *string) {
+    return sprintf(string, "engine,seed,width,height,generations,ms,ns_per_cell,gens_per_sec,cycles_per_gen,peak_bytes,population,status,threads,kernel");
+}
+
+// writes a result as a CSV row (no line ending, at most CAG_BENCH_ROW_LEN characters)
+// returns its length
+int s4640878_lib_CAG_bench_format(const caBenchResult_t *result, char *string) {
+    const char *status = (result->status == CAG_BENCH_OK) ? "ok"
+            : (result->status == CAG_BENCH_FULL) ? "full"
+            : (result->status == CAG_BENCH_MISMATCH) ? "mismatch"
+            : (result->status == CAG_BENCH_EDGE) ? "edge" : "nomem";
+    const char *kernel = (result->kernel < 0) ? "-" : kernelName[result->kernel];
+    return sprintf(string, "%s,%s,%d,%d,%lu,%lu,%lu.%03lu,%lu,%lu,%lu,%d,%s,%d,%s",
+            engineName[result->engine], seedName[result->seed], result->width, result->height,
+            (unsigned long)result->generations, (unsigned long)result->ms,
+            (unsigned long)(result->psPerCell / 1000), (unsigned long)(result->psPerCell % 1000),
+            (unsigned long)result->gensPerSec, (unsigned long)result->cyclesPerGen,
+            (unsigned long)result->memory, result->population, status, result->threads, kernel);
+}
+
+// sets the threads of the parallel engine (0: one per core), ignored on the board
+void s4640878_lib_CAG_bench_set_threads(int threads) {
+#if CAG_PARALLEL
+    benchThreads = threads;
+#endif
+}
+
+// sets the tile kernel of the packed engines (CAG_KERNEL_*), the best one the
+// cpu has below it is used (default: the best one)
+void s4640878_lib_CAG_bench_set_kernel(int kernel) {
+    benchKernel = kernel;
+}
+
+// sets the longest time in ms a step engine computes generations for in a run,
+// fewer generations are computed if it is reached (0: no limit, the default)
+// hashlife jumps are not cut short
+void s4640878_lib_CAG_bench_set_limit(uint32_t ms) {
+    benchLimitMs = ms;
+}
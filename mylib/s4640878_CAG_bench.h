@@ -0,0 +1,117 @@
+/**
+ **************************************************************
+ * @file mylib/s4640878_CAG_bench.h
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief CAGBench - simulator engine benchmarks (header file)
+ *        (board: nucleo-f401)
+ * REFERENCE: csse3010_project.pdf (spec sheet)
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * s4640878_lib_CAG_bench_run() - times one engine on one seed and universe size
+ * s4640878_lib_CAG_bench_get_sizes() - gets the number of universe sizes in the corpus
+ * s4640878_lib_CAG_bench_run_case() - runs one case of the benchmark corpus
+ * s4640878_lib_CAG_bench_format_header() - writes the CSV header
+ * s4640878_lib_CAG_bench_format() - writes a result as a CSV row
+ * s4640878_lib_CAG_bench_set_threads() - sets the threads of the parallel engine (hosts)
+ * s4640878_lib_CAG_bench_set_kernel() - sets the tile kernel of the packed engines
+ * s4640878_lib_CAG_bench_set_limit() - sets the longest time a step engine is run for
+ * s4640878_lib_CAG_bench_check() - checks a step engine against the int engine, or
+ *      hashlife through a macrocell save and load and against the packed engine
+ ***************************************************************
+ */
+
+#ifndef S4640878_CAG_BENCH_H_
+#define S4640878_CAG_BENCH_H_
+
+#include <stdint.h>
+#include "s4640878_CAG_universe.h"
+#include "s4640878_CAG_hashlife.h"
+#include "s4640878_CAG_bytes.h"
+#include "s4640878_CAG_sparse.h"
+#include "s4640878_CAG_parallel.h"
+
+// engines (int and packed match CAG_ENGINE_INT and CAG_ENGINE_PACKED)
+// hashlife advances the generations in power of two jumps, with no universe edge
+// bytes is a byte per cell like int, four cells at a time
+// sparse follows the cells that are not dead through hash sets
+// parallel (hosts only) is packed on a thread pool
+#define CAG_BENCH_INT 0
+#define CAG_BENCH_PACKED 1
+#define CAG_BENCH_HASHLIFE 2
+#define CAG_BENCH_BYTES 3
+#define CAG_BENCH_SPARSE 4
+#if CAG_PARALLEL
+#define CAG_BENCH_PARALLEL 5
+#define CAG_BENCH_ENGINES 6
+#else
+#define CAG_BENCH_ENGINES 5
+#endif
+
+// seeds, the same cells for every engine
+// gliders: one glider per 8x8 block, lifeforms: the draw_* lifeforms in turn
+// scattered: one glider per 128x128 block (0.03% alive, below the sparse crossover)
+#define CAG_BENCH_EMPTY 0
+#define CAG_BENCH_RANDOM25 1
+#define CAG_BENCH_RANDOM50 2
+#define CAG_BENCH_GLIDERS 3
+#define CAG_BENCH_LIFEFORMS 4
+#define CAG_BENCH_SCATTERED 5
+#define CAG_BENCH_SEEDS 6
+
+// universe sizes of the corpus ({width, height}), the board is limited by the heap
+#ifndef CAG_BENCH_SIZES
+#if UINTPTR_MAX > 0xFFFFFFFFUL
+#define CAG_BENCH_SIZES {{64, 16}, {256, 256}, {1024, 1024}}
+#else
+#define CAG_BENCH_SIZES {{64, 16}, {128, 32}}
+#endif
+#endif
+
+// corpus cases: every engine on every seed at every size
+#define CAG_BENCH_CASES (CAG_BENCH_ENGINES * CAG_BENCH_SEEDS * s4640878_lib_CAG_bench_get_sizes())
+
+// bench status
+#define CAG_BENCH_OK 0
+#define CAG_BENCH_NOMEM -1      // universe or engine could not be allocated
+#define CAG_BENCH_FULL -2       // hashlife node cache too small
+#define CAG_BENCH_MISMATCH -3   // check: a cell differs from the int engine (hashlife: from the
+                                // loaded macrocell or the packed engine)
+#define CAG_BENCH_EDGE -4       // hashlife: cells could reach the universe edge, which hashlife
+                                // does not model, so its cells may differ from the other engines
+
+// longest CSV row (without line ending)
+#define CAG_BENCH_ROW_LEN 136
+
+// result of one benchmark
+typedef struct caBenchResult {
+    int engine;                 // CAG_BENCH_* engine
+    int seed;                   // CAG_BENCH_*
+    int width;                  // universe size in cells
+    int height;
+    uint32_t generations;       // generations computed
+    uint32_t ms;                // time taken
+    uint32_t psPerCell;         // time per cell per generation in ps
+    uint32_t gensPerSec;        // generations per second
+    uint32_t cyclesPerGen;      // core cycles per generation (board only, 0 on a host)
+    uint32_t memory;            // peak bytes of the universe and the engine
+    int population;             // live cells after the last generation
+    int status;                 // CAG_BENCH_OK, CAG_BENCH_NOMEM, CAG_BENCH_FULL, CAG_BENCH_MISMATCH
+                                // or CAG_BENCH_EDGE
+    int threads;                // threads stepping the universe
+    int kernel;                 // tile kernel of the packed engines (CAG_KERNEL_*), -1 for the others
+} caBenchResult_t;
+
+// external function declarations
+int s4640878_lib_CAG_bench_run(caBenchResult_t *result, int engine, int seed, int width, int height, uint32_t generations);
+int s4640878_lib_CAG_bench_get_sizes(void);
+int s4640878_lib_CAG_bench_run_case(caBenchResult_t *result, int index, uint32_t generations);
+int s4640878_lib_CAG_bench_format_header(char *string);
+int s4640878_lib_CAG_bench_format(const caBenchResult_t *result, char *string);
+void s4640878_lib_CAG_bench_set_threads(int threads);
+void s4640878_lib_CAG_bench_set_kernel(int kernel);
+void s4640878_lib_CAG_bench_set_limit(uint32_t ms);
+int s4640878_lib_CAG_bench_check(caBenchResult_t *result, int engine, int seed, int width, int height, uint32_t generations);
+
+#endif
@@ -0,0 +1,361 @@
+/**
+ **************************************************************
+ * @file mylib/s4640878_CAG_bytes.c
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief CAGBytes - byte per cell engine, four cells per instruction (c file)
+ *        (board: nucleo-f401)
+ * REFERENCE: csse3010_project.pdf (spec sheet)
+ *            ARM DDI 0403E (ARMv7-M), UADD8, USUB8 and SEL
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * s4640878_lib_CAG_bytes_create() - creates a byte engine
+ * s4640878_lib_CAG_bytes_delete() - deletes a byte engine
+ * s4640878_lib_CAG_bytes_load_universe() - copies the cells, rule and boundary of a universe
+ * s4640878_lib_CAG_bytes_store_universe() - writes the cells back into the universe
+ * s4640878_lib_CAG_bytes_sync_universe() - loads a universe if it changed since the last load or store
+ * s4640878_lib_CAG_bytes_step() - computes the next generation
+ * s4640878_lib_CAG_bytes_get_cell() - gets the state value of a cell
+ * s4640878_lib_CAG_bytes_get_memory() - gets the bytes allocated for the engine
+ ***************************************************************
+ * the cells of the int engine, one byte each, stepped four at a time: a word
+ * holds four neighbouring cells of a row. the counted cells of the rows above,
+ * at and below are added column by column (uadd8), the column sums left, at
+ * and right of the cells give the 3x3 totals, and the rule is applied by
+ * comparing the totals with the ends of its runs of totals (usub8 sets a GE
+ * flag per lane, sel turns them into lane masks). newborn cells take the
+ * highest neighbour value, found the same way with sel
+ ***************************************************************
+ */
+
+#include "s4640878_CAG_bytes.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if CAG_BYTES_DSP
+#include "processor_hal.h"      // cmsis __UADD8, __USUB8 and __SEL
+#endif
+
+// lane constants
+#define LANES(n) ((uint32_t)(n) * 0x01010101u)
+#define LANES_80 0x80808080u
+#define LANES_FF 0xFFFFFFFFu
+
+// word of four cells at any byte of a buffer (unaligned ldr/str on the board)
+typedef uint32_t caLanes_t __attribute__((aligned(1), may_alias));
+#define WORD(cell) (*(caLanes_t *)(cell))
+
+// lane operations, the arguments must be plain variables (evaluated twice,
+// and on the board the GE flags of one operation are read by its own sel)
+#if CAG_BYTES_DSP
+#define ADD8(a, b) __UADD8((a), (b))
+#define GE8(a, b) (__USUB8((a), (b)), __SEL(LANES_FF, 0))
+#define MAX8(a, b) (__USUB8((a), (b)), __SEL((a), (b)))
+#define MIN8(a, b) (__USUB8((a), (b)), __SEL((b), (a)))
+#else
+// lanes stay below 128 (totals up to 9, values up to CAG_AGE_MAX), so a word
+// add never carries into the next lane, and bit 7 of ((a | 0x80) - b) is set
+// exactly when a >= b
+#define ADD8(a, b) ((a) + (b))
+#define GE8(a, b) ((((((a) | LANES_80) - (b)) >> 7) & LANES(1)) * 0xFF)
+#define MAX8(a, b) (((a) & GE8(a, b)) | ((b) & ~GE8(a, b)))
+#define MIN8(a, b) (((b) & GE8(a, b)) | ((a) & ~GE8(a, b)))
+#endif
+
+// internal function declarations
+int CAG_bytes_wrap(caBytes_t *bytes, int *x, int *y);
+void CAG_bytes_fill_halo(caBytes_t *bytes, uint8_t *cells);
+void CAG_bytes_compile(caBytes_t *bytes);
+int CAG_bytes_runs(uint16_t totals, uint8_t run[][2], uint16_t *ends);
+
+// creates a width x height byte engine, returns NULL if out of memory
+caBytes_t *s4640878_lib_CAG_bytes_create(int width, int height) {
+    if ((width <= 0) || (height <= 0)) {
+        return NULL;
+    }
+    caBytes_t *bytes = calloc(1, sizeof(caBytes_t));
+    if (bytes == NULL) {
+        return NULL;
+    }
+    // the last word of a row starts at most at column width - 1 and is read
+    // one byte to each side
+    bytes->width = width;
+    bytes->height = height;
+    bytes->stride = (width + 8) & ~(CAG_BYTES_LANES - 1);
+    size_t size = (size_t)bytes->stride * (height + 2);
+    uint8_t *block = calloc(4 * size + 2 * bytes->stride, 1);
+    if (block == NULL) {
+        free(bytes);
+        return NULL;
+    }
+    bytes->alive[0] = block;
+    bytes->alive[1] = block + size;
+    bytes->value[0] = block + 2 * size;
+    bytes->value[1] = block + 3 * size;
+    bytes->rowSum = block + 4 * size;
+    bytes->rowMax = bytes->rowSum + bytes->stride;
+    bytes->boundary = CAG_BOUNDARY_DEAD;
+    bytes->published = UINT32_MAX;      // no universe loaded (never a published word)
+    s4640878_lib_CAG_universe_parse_rule(&bytes->rule, CAG_RULE_DEFAULT);
+    CAG_bytes_compile(bytes);
+    return bytes;
+}
+
+// frees a byte engine
+void s4640878_lib_CAG_bytes_delete(caBytes_t *bytes) {
+    if (bytes != NULL) {
+        free(bytes->alive[0]);
+        free(bytes);
+    }
+}
+
+// replaces the cells with the ones of a universe (of the same size) and takes
+// over its rule and boundary mode
+void s4640878_lib_CAG_bytes_load_universe(caBytes_t *bytes, caUniverse_t *universe) {
+    int life = (universe->rule.family == CAG_FAMILY_LIFE);
+    uint8_t *alive = bytes->alive[bytes->current], *value = bytes->value[bytes->current];
+
+    bytes->boundary = universe->boundary;
+    bytes->rule = universe->rule;
+    memcpy(bytes->stateTable, universe->stateTable, sizeof(bytes->stateTable));
+    CAG_bytes_compile(bytes);
+    for (int y = 0; y < bytes->height; y++) {
+        int row = (y + 1) * bytes->stride;
+        for (int x = 0; x < bytes->width; x++) {
+            int cell = s4640878_lib_CAG_universe_get_cell(universe, x, y);
+            value[row + x + 1] = cell;
+            alive[row + x + 1] = life ? (cell != 0) : (cell == 1);
+        }
+        // the columns past the east edge are stepped too: life leaves ages up to
+        // CAG_AGE_MAX there, past the end of a multi-state rule's state table
+        memset(value + row + bytes->width + 1, 0, bytes->stride - bytes->width - 1);
+        memset(alive + row + bytes->width + 1, 0, bytes->stride - bytes->width - 1);
+    }
+    bytes->generations = 0;
+    bytes->published = universe->published;
+}
+
+// writes the cells computed since the last load or store into a universe, as
+// one step of that many generations (counters, hash and cycle detection)
+// only the cells that differ from the universe are written: after one generation
+// of an untouched universe the other buffer holds its cells, so the buffers are
+// compared a word at a time, otherwise every cell is compared with the universe
+void s4640878_lib_CAG_bytes_store_universe(caBytes_t *bytes, caUniverse_t *universe) {
+    if (bytes->generations == 0) {
+        return;
+    }
+    int diff = (bytes->generations == 1) && (bytes->published == universe->published);
+    uint8_t *now = bytes->value[bytes->current], *was = bytes->value[1 - bytes->current];
+    uint64_t before = s4640878_lib_CAG_universe_write_begin(universe);
+    for (int y = 0; diff && (y < bytes->height); y++) {
+        int row = (y + 1) * bytes->stride;
+        for (int x = 1; x <= bytes->width; x += CAG_BYTES_LANES) {
+            if (WORD(now + row + x) == WORD(was + row + x)) {
+                continue;
+            }
+            for (int k = 0; (k < CAG_BYTES_LANES) && (x + k <= bytes->width); k++) {
+                if (now[row + x + k] != was[row + x + k]) {
+                    s4640878_lib_CAG_universe_set_cell(universe, x + k - 1, y, now[row + x + k]);
+                }
+            }
+        }
+    }
+    for (int y = 0; !diff && (y < bytes->height); y++) {
+        for (int x = 0; x < bytes->width; x++) {
+            int cell = s4640878_lib_CAG_bytes_get_cell(bytes, x, y);
+            if (s4640878_lib_CAG_universe_get_cell(universe, x, y) != cell) {
+                s4640878_lib_CAG_universe_set_cell(universe, x, y, cell);
+            }
+        }
+    }
+    s4640878_lib_CAG_universe_write_end(universe, before, bytes->generations);
+    bytes->generations = 0;
+    bytes->published = universe->published;
+}
+
+// loads a universe unless its cells, rule and boundary mode are still the ones
+// of the last load or store (any edit or step of the universe publishes it again)
+// the cells computed since are dropped
+void s4640878_lib_CAG_bytes_sync_universe(caBytes_t *bytes, caUniverse_t *universe) {
+    if ((bytes->published != universe->published) || (bytes->boundary != universe->boundary)
+            || (bytes->rule.family != universe->rule.family) || (bytes->rule.states != universe->rule.states)
+            || (bytes->rule.birth != universe->rule.birth) || (bytes->rule.survive != universe->rule.survive)) {
+        s4640878_lib_CAG_bytes_load_universe(bytes, universe);
+    }
+}
+
+// computes the next generation, a row at a time
+// columns past the east edge are stepped too (the last word of a row), what
+// they hold is never read back as a cell: the halo is filled again every step
+void s4640878_lib_CAG_bytes_step(caBytes_t *bytes) {
+    int width = bytes->width, height = bytes->height, stride = bytes->stride;
+    int life = (bytes->rule.family == CAG_FAMILY_LIFE);
+    uint8_t *srcAlive = bytes->alive[bytes->current], *srcValue = bytes->value[bytes->current];
+    uint8_t *dstAlive = bytes->alive[1 - bytes->current], *dstValue = bytes->value[1 - bytes->current];
+    uint8_t *rowSum = bytes->rowSum, *rowMax = bytes->rowMax;
+    uint32_t ge[CAG_BYTES_TOTALS + 1];      // lanes with a total >= n, per n
+
+    CAG_bytes_fill_halo(bytes, srcAlive);
+    CAG_bytes_fill_halo(bytes, srcValue);
+    ge[0] = LANES_FF;
+    ge[CAG_BYTES_TOTALS] = 0;
+
+    for (int y = 1; y <= height; y++) {
+        uint8_t *aliveUp = srcAlive + (y - 1) * stride, *aliveMid = aliveUp + stride, *aliveDown = aliveMid + stride;
+        uint8_t *valueUp = srcValue + (y - 1) * stride, *valueMid = valueUp + stride, *valueDown = valueMid + stride;
+        uint8_t *outAlive = dstAlive + y * stride, *outValue = dstValue + y * stride;
+
+        // counted cells of each column around the row (life: and the highest value)
+        for (int i = 0; i < stride; i += CAG_BYTES_LANES) {
+            uint32_t up = WORD(aliveUp + i), mid = WORD(aliveMid + i), down = WORD(aliveDown + i);
+            uint32_t sum = ADD8(up, mid);
+            WORD(rowSum + i) = ADD8(sum, down);
+        }
+        for (int i = 0; life && (i < stride); i += CAG_BYTES_LANES) {
+            uint32_t up = WORD(valueUp + i), mid = WORD(valueMid + i), down = WORD(valueDown + i);
+            uint32_t highest = MAX8(up, mid);
+            WORD(rowMax + i) = MAX8(highest, down);
+        }
+
+        for (int x = 1; x <= width; x += CAG_BYTES_LANES) {
+            uint32_t west = WORD(rowSum + x - 1), centre = WORD(rowSum + x), east = WORD(rowSum + x + 1);
+            uint32_t total = ADD8(west, centre);
+            total = ADD8(total, east);
+            uint32_t value = WORD(valueMid + x);
+            if ((total | value) == 0) {
+                // nothing counted around empty cells: they stay empty (no rule is born on 0)
+                WORD(outAlive + x) = 0;
+                WORD(outValue + x) = 0;
+                continue;
+            }
+
+            if (!life) {
+                // the next state of each lane from the state table (lane k is cell x + k)
+                for (int k = 0; k < CAG_BYTES_LANES; k++) {
+                    int next = bytes->stateTable[(valueMid[x + k] << 4) | ((total >> (8 * k)) & 0xFF)];
+                    outValue[x + k] = next;
+                    outAlive[x + k] = (next == 1);
+                }
+                continue;
+            }
+
+            // lanes in each run of totals: total >= lo and not total >= hi
+            for (int i = 0; i < bytes->thresholds; i++) {
+                uint32_t n = LANES(bytes->threshold[i]);
+                ge[bytes->threshold[i]] = GE8(total, n);
+            }
+            uint32_t born = 0, keep = 0;
+            for (int i = 0; i < bytes->bornRuns; i++) {
+                born |= ge[bytes->born[i][0]] & ~ge[bytes->born[i][1]];
+            }
+            for (int i = 0; i < bytes->keepRuns; i++) {
+                keep |= ge[bytes->keep[i][0]] & ~ge[bytes->keep[i][1]];
+            }
+            uint32_t alive = WORD(aliveMid + x) * 0xFF;
+            born &= ~alive;
+            keep &= alive;
+
+            // survivors age by one up to CAG_AGE_MAX, newborns take the highest
+            // neighbour value (the cell itself is dead, so its 0 does not count)
+            uint32_t one = LANES(1), most = LANES(CAG_AGE_MAX);
+            uint32_t older = ADD8(value, one);
+            older = MIN8(older, most);
+            uint32_t next = keep & older;
+            if (born != 0) {
+                west = WORD(rowMax + x - 1);
+                centre = WORD(rowMax + x);
+                east = WORD(rowMax + x + 1);
+                uint32_t highest = MAX8(west, centre);
+                highest = MAX8(highest, east);
+                next |= born & highest;
+            }
+            WORD(outAlive + x) = (born | keep) & LANES(1);
+            WORD(outValue + x) = next;
+        }
+    }
+    bytes->current = 1 - bytes->current;
+    bytes->generations++;
+}
+
+// returns the state value of cell (x, y), 0 (dead) outside the universe
+int s4640878_lib_CAG_bytes_get_cell(caBytes_t *bytes, int x, int y) {
+    if ((x < 0) || (x >= bytes->width) || (y < 0) || (y >= bytes->height)) {
+        return 0;
+    }
+    return bytes->value[bytes->current][(y + 1) * bytes->stride + x + 1];
+}
+
+// returns the bytes allocated by create
+uint32_t s4640878_lib_CAG_bytes_get_memory(caBytes_t *bytes) {
+    return sizeof(caBytes_t) + (4 * (bytes->height + 2) + 2) * bytes->stride;
+}
+
+// maps a cell just outside the universe to the cell it is joined to, as the
+// universe does, returns 0 if the cell is dead (dead boundary)
+int CAG_bytes_wrap(caBytes_t *bytes, int *x, int *y) {
+    int width = bytes->width, height = bytes->height;
+    if (bytes->boundary == CAG_BOUNDARY_DEAD) {
+        return (*x >= 0) && (*x < width) && (*y >= 0) && (*y < height);
+    }
+    if ((*x < 0) || (*x >= width)) {
+        *x = (*x + width) % width;
+        if (bytes->boundary == CAG_BOUNDARY_CROSS) {
+            *y = height - 1 - *y;
+        }
+    }
+    if ((*y < 0) || (*y >= height)) {
+        *y = (*y + height) % height;
+        if (bytes->boundary != CAG_BOUNDARY_TORUS) {
+            *x = width - 1 - *x;
+        }
+    }
+    return 1;
+}
+
+// fills the halo ring around a buffer from its edge cells
+// done every step: the last step wrote past the east edge
+void CAG_bytes_fill_halo(caBytes_t *bytes, uint8_t *cells) {
+    int width = bytes->width, height = bytes->height, stride = bytes->stride;
+    for (int y = -1; y <= height; y++) {
+        // whole rows above and below the universe, the two edge columns between
+        int step = ((y < 0) || (y == height)) ? 1 : (width + 1);
+        for (int x = -1; x <= width; x += step) {
+            int wx = x, wy = y;
+            cells[(y + 1) * stride + x + 1] = CAG_bytes_wrap(bytes, &wx, &wy) ? cells[(wy + 1) * stride + wx + 1] : 0;
+        }
+    }
+}
+
+// lists the runs of 3x3 totals the rule gives a live cell for (a live cell
+// counts itself), and the totals they start or end at, so a step compares
+// the totals of four cells with each of those once
+void CAG_bytes_compile(caBytes_t *bytes) {
+    uint16_t ends = 0;
+    bytes->bornRuns = CAG_bytes_runs(bytes->rule.birth, bytes->born, &ends);
+    bytes->keepRuns = CAG_bytes_runs(bytes->rule.survive << 1, bytes->keep, &ends);
+    bytes->thresholds = 0;
+    for (int n = 1; n < CAG_BYTES_TOTALS; n++) {
+        if ((ends >> n) & 1) {
+            bytes->threshold[bytes->thresholds++] = n;
+        }
+    }
+}
+
+// splits a mask of totals (bit n: total n) into runs [lo, hi), returns how many
+// the ends of the runs are added to ends (bit n)
+int CAG_bytes_runs(uint16_t totals, uint8_t run[][2], uint16_t *ends) {
+    int runs = 0;
+    totals &= (1 << CAG_BYTES_TOTALS) - 1;
+    for (int n = 0; n < CAG_BYTES_TOTALS; n++) {
+        if (((totals >> n) & 1) && ((n == 0) || !((totals >> (n - 1)) & 1))) {
+            run[runs][0] = n;
+        }
+        if (((totals >> n) & 1) && !((totals >> (n + 1)) & 1)) {
+            run[runs][1] = n + 1;
+            *ends |= (1 << run[runs][0]) | (1 << (n + 1));
+            runs++;
+        }
+    }
+    return runs;
+}
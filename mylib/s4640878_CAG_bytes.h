@@ -0,0 +1,80 @@
+/**
+ **************************************************************
+ * @file mylib/s4640878_CAG_bytes.h
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief CAGBytes - byte per cell engine, four cells per instruction (header file)
+ *        (board: nucleo-f401)
+ * REFERENCE: csse3010_project.pdf (spec sheet)
+ *            ARM DDI 0403E (ARMv7-M), UADD8, USUB8 and SEL
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * s4640878_lib_CAG_bytes_create() - creates a byte engine
+ * s4640878_lib_CAG_bytes_delete() - deletes a byte engine
+ * s4640878_lib_CAG_bytes_load_universe() - copies the cells, rule and boundary of a universe
+ * s4640878_lib_CAG_bytes_store_universe() - writes the cells back into the universe
+ * s4640878_lib_CAG_bytes_sync_universe() - loads a universe if it changed since the last load or store
+ * s4640878_lib_CAG_bytes_step() - computes the next generation
+ * s4640878_lib_CAG_bytes_get_cell() - gets the state value of a cell
+ * s4640878_lib_CAG_bytes_get_memory() - gets the bytes allocated for the engine
+ ***************************************************************
+ */
+
+#ifndef S4640878_CAG_BYTES_H_
+#define S4640878_CAG_BYTES_H_
+
+#include <stdint.h>
+#include "s4640878_CAG_universe.h"
+
+// cortex-m4 (armv7e-m) dsp instructions: 4 byte lanes added and compared in
+// one cycle, elsewhere the same lanes are worked on with plain 32-bit words
+#if defined(__ARM_FEATURE_SIMD32) && __ARM_FEATURE_SIMD32
+#define CAG_BYTES_DSP 1
+#else
+#define CAG_BYTES_DSP 0
+#endif
+
+// cells per word
+#define CAG_BYTES_LANES 4
+
+// 3x3 totals (0..9), and the runs of them a rule can give a live cell for
+#define CAG_BYTES_TOTALS 10
+#define CAG_BYTES_RUNS (CAG_BYTES_TOTALS / 2)
+
+// byte per cell engine
+// cell (x, y) is byte (y + 1) * stride + x + 1 of a buffer: a one cell halo
+// filled from the boundary mode each step, and rows padded to whole words
+typedef struct caBytes {
+    int width;                  // width in cells (the universe width)
+    int height;                 // height in cells
+    int stride;                 // bytes per row
+    uint8_t *alive[2];          // 1 if the cell is counted (life: alive, multi-state: state 1)
+    uint8_t *value[2];          // state value (life: 0 or 1 + age, multi-state: the state)
+    uint8_t *rowSum;            // vertical sums of alive around the row being stepped
+    uint8_t *rowMax;            // vertical maxima of value around the row being stepped
+    int current;                // buffer holding the current generation
+    uint32_t generations;       // generations computed since the last load or store
+    uint32_t published;         // published word of the universe after the last load or store
+    int boundary;               // boundary mode (CAG_BOUNDARY_*)
+    caRule_t rule;
+    uint8_t stateTable[256];    // multi-state: next state of [(state << 4) | 3x3 total]
+    uint8_t born[CAG_BYTES_RUNS][2];    // life: totals [lo, hi) giving birth to a dead cell
+    int bornRuns;
+    uint8_t keep[CAG_BYTES_RUNS][2];    // life: totals [lo, hi) keeping a live cell alive
+    int keepRuns;
+    uint8_t threshold[CAG_BYTES_TOTALS];    // totals the runs start or end at (1..9)
+    int thresholds;
+} caBytes_t;
+
+// external function declarations
+caBytes_t *s4640878_lib_CAG_bytes_create(int width, int height);
+void s4640878_lib_CAG_bytes_delete(caBytes_t *bytes);
+void s4640878_lib_CAG_bytes_load_universe(caBytes_t *bytes, caUniverse_t *universe);
+void s4640878_lib_CAG_bytes_store_universe(caBytes_t *bytes, caUniverse_t *universe);
+void s4640878_lib_CAG_bytes_sync_universe(caBytes_t *bytes, caUniverse_t *universe);
+void s4640878_lib_CAG_bytes_step(caBytes_t *bytes);
+int s4640878_lib_CAG_bytes_get_cell(caBytes_t *bytes, int x, int y);
+uint32_t s4640878_lib_CAG_bytes_get_memory(caBytes_t *bytes);
+
+#endif
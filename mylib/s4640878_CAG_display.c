@@ -10,6 +10,12 @@
  * EXTERNAL FUNCTIONS 
  ***************************************************************
  * s4640878_tsk_CAG_display_init() - initialises CAG display
+ * s4640878_lib_CAG_display_refresh() - requests a frame
+ * s4640878_lib_CAG_display_set_fps() - sets the highest frame rate
+ * s4640878_lib_CAG_display_get_stats() - gets the frame counts
+ * s4640878_lib_CAG_display_pan() - moves the view
+ * s4640878_lib_CAG_display_zoom() - zooms the view in or out
+ * s4640878_lib_CAG_display_zoom_cycle() - zooms the view out a step, or back in from the whole universe
  *************************************************************** 
  */
 
@@ -18,35 +24,123 @@
 #include "s4640878_oled.h"
 #include "board.h"
 #include "processor_hal.h"
+#include <string.h>
 
-// global variables
-extern int cells[WIDTH][HEIGHT];
+// attempts at drawing a whole generation before showing a partly updated one
+#define DRAW_ATTEMPTS 3
+
+// zoom levels: 1 << zoom pixels a cell side, below 0 1 << -zoom cells a pixel side
+#define ZOOM_4X 2
+#define ZOOM_2X 1
+#define ZOOM_1X 0
+
+// quarters of a cell lit per multi-state cell state (bit 0 top-left, 1 top-right, 2 bottom-left,
+// 3 bottom-right): firing cells are solid, older and wireworld conductor states fainter
+#define PIXELS_ALL 0xF
+static const uint8_t statePixels[16] = {
+    0x0, PIXELS_ALL, 0x9, 0x1, 0x8, 0x8, 0x8, 0x8, 0x8, 0x8, 0x8, 0x8, 0x8, 0x8, 0x8, 0x8
+};
 
 // internal function declarations
 void s4640878TaskCAGDisplay(void);
 void CAG_display_init(void);
 void CAG_display_draw(void);
+void CAG_display_view(caUniverse_t *universe);
+void CAG_display_cells(caUniverse_t *universe, uint32_t ticket);
+void CAG_display_blocks(caUniverse_t *universe, uint32_t ticket);
+void CAG_display_cursor(void);
+void CAG_display_blit(int column, const uint32_t *planes, uint32_t rows, int statePlanes);
+void CAG_display_column(int column, uint32_t pixels);
+uint32_t CAG_display_spread(uint32_t cells);
+uint32_t CAG_display_fold(uint32_t cells, int n);
+
+static uint8_t frame[OLED_FRAME_BYTES];     // frame drawn in ssd1306 page format
+static volatile int fps = CAG_DISPLAY_FPS;  // highest frame rate
+static uint32_t requests;          // refresh requests (requesting tasks)
+static uint32_t requestsMerged;    // requests made while one was already waiting
+static uint32_t frames;            // frames drawn (display task)
+static uint32_t framesMerged;      // requests made while waiting for the frame period
+static uint32_t skipped;           // generations never shown
+static uint32_t shownGeneration;   // generation of the last frame
+static caUniverse_t *shownUniverse; // universe of the last frame
+static int viewX;                  // cell at the top-left of the panel (display task)
+static int viewY;
+static int viewZoom = ZOOM_2X;     // zoom level
+static int panX;                   // pan and zoom requests, taken by the next frame
+static int panY;
+static int zoomSteps;
+static int zoomCycles;
+static int followX;                // selected cell the view last followed
+static int followY;
 
 // controlling task for CAGDisplay
+// sleeps until something shown changes, then draws no sooner than a frame
+// period after the last frame: the requests made meanwhile are drawn together
 void s4640878TaskCAGDisplay(void) {
     portDISABLE_INTERRUPTS();
     s4640878_reg_oled_init();   // initialise the oled
     portENABLE_INTERRUPTS();
 
     CAG_display_init();         // receives semaphore when CAGSimulator is ready
+    TickType_t last = xTaskGetTickCount() - (1000 / CAG_DISPLAY_FPS_MIN) / portTICK_PERIOD_MS;
     for(;;) {
-        ssd1306_Fill(Black);    // clear screen
-        CAG_display_draw();     // draws simulation
-        ssd1306_UpdateScreen();
-        vTaskDelay(100);        // delay 0.1s
+        xSemaphoreTake(s4640878SemaphoreCAGDisplay, portMAX_DELAY);
+
+        TickType_t period = (1000 / fps) / portTICK_PERIOD_MS;
+        TickType_t since = xTaskGetTickCount() - last;
+        if (since < period) {
+            vTaskDelay(period - since);
+            if (xSemaphoreTake(s4640878SemaphoreCAGDisplay, 0) == pdTRUE) {
+                framesMerged++;     // drawn by this frame
+            }
+        }
+
+        // keeps the last frame while a batch run computes generations, the
+        // simulator requests one when it ends
+        if (!s4640878_lib_CAG_simulator_get_busy()) {
+            last = xTaskGetTickCount();
+            CAG_display_draw();     // draws simulation
+            s4640878_reg_oled_update(frame);    // writes the changed parts
+            frames++;
+        }
     }
 }
 
 // task init function for CAGDisplay
 void s4640878_tsk_CAG_display_init(void) {
+    // created before the task, so the simulator can request frames at once
+    s4640878SemaphoreCAGDisplay = xSemaphoreCreateBinary();
     xTaskCreate((void*)&s4640878TaskCAGDisplay, "CAG_DISPLAY", CAG_DISPLAY_TASK_STACKSIZE, NULL, CAG_DISPLAY_TASK_PRIORITY, NULL);
 }
 
+// requests a frame, called when something shown changes
+// requests made before the display task wakes are drawn by one frame
+void s4640878_lib_CAG_display_refresh(void) {
+    if (s4640878SemaphoreCAGDisplay == NULL) {
+        return;
+    }
+    requests++;
+    if (xSemaphoreGive(s4640878SemaphoreCAGDisplay) != pdTRUE) {
+        requestsMerged++;   // a frame is already requested
+    }
+}
+
+// sets the highest frame rate, ignores rates outside CAG_DISPLAY_FPS_MIN .. _MAX
+void s4640878_lib_CAG_display_set_fps(int rate) {
+    if ((rate >= CAG_DISPLAY_FPS_MIN) && (rate <= CAG_DISPLAY_FPS_MAX)) {
+        fps = rate;
+    }
+}
+
+// copies the frame counts
+void s4640878_lib_CAG_display_get_stats(caDisplayStats_t *stats) {
+    stats->requests = requests;
+    stats->frames = frames;
+    stats->merged = requestsMerged + framesMerged;
+    stats->skipped = skipped;
+    stats->fps = fps;
+}
+
 // waits for CAGSimulator to set up
 void CAG_display_init(void) {
     if (s4640878SemaphoreCAGSimulatorInit != NULL) {
@@ -56,18 +150,268 @@ void CAG_display_init(void) {
     }
 }
 
-// draws pixels of corresponding cells on the oled
+// moves the view by an eighth of the panel per step (-1 left or up, 1 right or down)
+void s4640878_lib_CAG_display_pan(int dx, int dy) {
+    portENTER_CRITICAL();
+    panX += dx;
+    panY += dy;
+    portEXIT_CRITICAL();
+    s4640878_lib_CAG_display_refresh();
+}
+
+// zooms the view in (steps > 0) or out, about the centre of the panel
+void s4640878_lib_CAG_display_zoom(int steps) {
+    portENTER_CRITICAL();
+    zoomSteps += steps;
+    portEXIT_CRITICAL();
+    s4640878_lib_CAG_display_refresh();
+}
+
+// zooms the view out a step about the centre of the panel, and from the whole
+// universe back in to 4x (one control goes through every zoom)
+void s4640878_lib_CAG_display_zoom_cycle(void) {
+    portENTER_CRITICAL();
+    zoomCycles++;
+    portEXIT_CRITICAL();
+    s4640878_lib_CAG_display_refresh();
+}
+
+// draws the cells in view on the oled
+// reads the last published generation without locking, and redraws if the
+// simulator got two generations ahead while drawing
 void CAG_display_draw(void) {
-    // loops through the cells array
-    for (int x = 0; x < WIDTH; x++) {
-        for (int y = 0; y < HEIGHT; y++) {
-            // draws cells on the display if it is alive
-            if (cells[x][y]) {
-                ssd1306_DrawPixel(2*x, 2*y, SSD1306_WHITE);
-                ssd1306_DrawPixel(2*x + 1, 2*y, SSD1306_WHITE);
-                ssd1306_DrawPixel(2*x, 2*y + 1, SSD1306_WHITE);
-                ssd1306_DrawPixel(2*x + 1, 2*y + 1, SSD1306_WHITE);
+    caUniverse_t *universe = s4640878_lib_CAG_simulator_get_universe();
+    memset(frame, 0, OLED_FRAME_BYTES);     // clear screen
+    if (universe == NULL) {
+        return;
+    }
+    CAG_display_view(universe);
+
+    for (int attempt = 0; attempt < DRAW_ATTEMPTS; attempt++) {
+        uint32_t ticket = s4640878_lib_CAG_universe_read_begin(universe);
+        if (viewZoom >= ZOOM_1X) {
+            CAG_display_cells(universe, ticket);
+        } else {
+            CAG_display_blocks(universe, ticket);
+        }
+        if (s4640878_lib_CAG_universe_read_end(universe, ticket)) {
+            break;
+        }
+    }
+    CAG_display_cursor();
+
+    // the generations computed since the last frame, but the one shown
+    uint32_t generation = universe->generation;
+    if ((universe == shownUniverse) && (generation > shownGeneration + 1)) {
+        skipped += generation - shownGeneration - 1;
+    }
+    shownUniverse = universe;
+    shownGeneration = generation;
+}
+
+// takes the pan and zoom requests and fits the view to the universe: zooming
+// out stops once the whole universe is on the panel, in grid mode the view
+// follows the selected cell, and zoomed out it starts on a whole pixel of cells
+// the view is worked out in units: cells, or the cells of a pixel zoomed out
+void CAG_display_view(caUniverse_t *universe) {
+    portENTER_CRITICAL();
+    int dx = panX, dy = panY, dz = zoomSteps, cycles = zoomCycles;
+    panX = panY = zoomSteps = zoomCycles = 0;
+    portEXIT_CRITICAL();
+
+    int least = 0;
+    while ((universe->width > (SSD1306_WIDTH << least)) || (universe->height > (SSD1306_HEIGHT << least))) {
+        least++;
+    }
+    int zoom = viewZoom + dz;
+    zoom = (zoom > ZOOM_4X) ? ZOOM_4X : ((zoom < -least) ? -least : zoom);
+    for (int i = 0; i < cycles; i++) {
+        zoom = (zoom <= -least) ? ZOOM_4X : (zoom - 1);
+    }
+    int unit = (zoom < 0) ? (1 << -zoom) : 1;
+    int spanX = (zoom < 0) ? SSD1306_WIDTH : (SSD1306_WIDTH >> zoom);
+    int spanY = (zoom < 0) ? SSD1306_HEIGHT : (SSD1306_HEIGHT >> zoom);
+
+    // the cell at the centre of the panel stays there when zooming
+    int x = viewX / unit, y = viewY / unit;
+    if (zoom != viewZoom) {
+        int oldUnit = (viewZoom < 0) ? (1 << -viewZoom) : 1;
+        int oldSpanX = (viewZoom < 0) ? SSD1306_WIDTH : (SSD1306_WIDTH >> viewZoom);
+        int oldSpanY = (viewZoom < 0) ? SSD1306_HEIGHT : (SSD1306_HEIGHT >> viewZoom);
+        x = (viewX + oldSpanX * oldUnit / 2) / unit - spanX / 2;
+        y = (viewY + oldSpanY * oldUnit / 2) / unit - spanY / 2;
+    }
+    x += dx * ((spanX >= 8) ? spanX / 8 : 1);
+    y += dy * ((spanY >= 8) ? spanY / 8 : 1);
+
+    // only after the selected cell moved, so the view can be panned away from it
+    int cursorX = s4640878_lib_CAG_simulator_get_current_cell(X);
+    int cursorY = s4640878_lib_CAG_simulator_get_current_cell(Y);
+    if (s4640878_lib_CAG_simulator_get_grid() && ((cursorX != followX) || (cursorY != followY))) {
+        int cx = cursorX / unit, cy = cursorY / unit;
+        x = (cx < x) ? cx : ((cx >= x + spanX) ? cx - spanX + 1 : x);
+        y = (cy < y) ? cy : ((cy >= y + spanY) ? cy - spanY + 1 : y);
+    }
+    followX = cursorX;
+    followY = cursorY;
+
+    int unitsX = (universe->width + unit - 1) / unit, unitsY = (universe->height + unit - 1) / unit;
+    x = (x > unitsX - spanX) ? unitsX - spanX : x;
+    y = (y > unitsY - spanY) ? unitsY - spanY : y;
+    viewX = (x > 0) ? x * unit : 0;
+    viewY = (y > 0) ? y * unit : 0;
+    viewZoom = zoom;
+}
+
+// draws the view zoomed in (or 1x), a column of cells at a time
+void CAG_display_cells(caUniverse_t *universe, uint32_t ticket) {
+    int statePlanes = (universe->rule.family != CAG_FAMILY_LIFE) ? universe->statePlanes : 0;
+    int rowCount = universe->height - viewY;
+    rowCount = (rowCount < (SSD1306_HEIGHT >> viewZoom)) ? rowCount : (SSD1306_HEIGHT >> viewZoom);
+    uint32_t rows = (rowCount < 32) ? (((uint32_t)1 << rowCount) - 1) : 0xFFFFFFFFu;
+
+    // every drawn column is written whole, so a redraw needs no clearing
+    for (int x = 0; (x < (SSD1306_WIDTH >> viewZoom)) && (viewX + x < universe->width); x++) {
+        uint32_t planes[CAG_PLANES];
+        s4640878_lib_CAG_universe_read_column(universe, ticket, viewX + x, viewY, planes);
+        CAG_display_blit(x << viewZoom, planes, rows, statePlanes);
+    }
+}
+
+// draws the view zoomed out: a pixel is lit if one of its n x n cells is not dead
+// a pixel of a tile or more is one read of the population pyramid; smaller
+// pixels are folded from the column words, skipping the tiles the pyramid
+// says are empty
+void CAG_display_blocks(caUniverse_t *universe, uint32_t ticket) {
+    int n = 1 << -viewZoom;
+    for (int column = 0; (column < SSD1306_WIDTH) && (viewX + column * n < universe->width); column++) {
+        int x = viewX + column * n;
+        uint32_t pixels = 0;
+        if (n >= CAG_TILE_BITS) {
+            int level = -viewZoom - CAG_TILE_SHIFT;
+            for (int row = 0; row < SSD1306_HEIGHT; row++) {
+                if (s4640878_lib_CAG_universe_read_block(universe, ticket, level, x, viewY + row * n) > 0) {
+                    pixels |= (uint32_t)1 << row;
+                }
+            }
+        } else {
+            // 32 rows of cells at a time, 32 / n pixels (the n columns are in one tile)
+            for (int chunk = 0; chunk < n; chunk++) {
+                int y = viewY + 32 * chunk;
+                int occupied = 0;
+                for (int ty = y; (ty < y + 32) && (ty < universe->height); ty = (ty | (CAG_TILE_BITS - 1)) + 1) {
+                    occupied |= (s4640878_lib_CAG_universe_read_block(universe, ticket, 0, x, ty) > 0);
+                }
+                uint32_t cells = 0;
+                for (int i = 0; occupied && (i < n); i++) {
+                    uint32_t planes[CAG_PLANES];
+                    s4640878_lib_CAG_universe_read_column(universe, ticket, x + i, y, planes);
+                    for (int p = 0; p < CAG_PLANES; p++) {
+                        cells |= planes[p];     // dead cells have every plane clear
+                    }
+                }
+                pixels |= CAG_display_fold(cells, n) << (chunk * (32 / n));
+            }
+        }
+        CAG_display_column(column, pixels);
+    }
+}
+
+// shows the selected cell in grid mode as its pixels inverted (zoomed out,
+// the pixel holding it)
+void CAG_display_cursor(void) {
+    if (!s4640878_lib_CAG_simulator_get_grid()) {
+        return;
+    }
+    int x = s4640878_lib_CAG_simulator_get_current_cell(X) - viewX;
+    int y = s4640878_lib_CAG_simulator_get_current_cell(Y) - viewY;
+    int size = (viewZoom > 0) ? (1 << viewZoom) : 1;
+    x = (viewZoom >= 0) ? (x << viewZoom) : (x >> -viewZoom);
+    y = (viewZoom >= 0) ? (y << viewZoom) : (y >> -viewZoom);
+    if ((x < 0) || (x + size > SSD1306_WIDTH) || (y < 0) || (y + size > SSD1306_HEIGHT)) {
+        return;
+    }
+    for (int column = x; column < x + size; column++) {
+        for (int row = y; row < y + size; row++) {
+            frame[(row / 8) * SSD1306_WIDTH + column] ^= 1 << (row % 8);
+        }
+    }
+}
+
+// writes a column of cells (plane words, bit y for cell y, rows the cells to
+// draw) as the 1 << viewZoom pixel columns from column of the frame
+// the quarters of a cell (life: the live cells, multi-state: by statePixels)
+// each come from a mask of the cells lighting them, spread to the cell's
+// pixel rows; 1x a pixel is lit by any quarter
+void CAG_display_blit(int column, const uint32_t *planes, uint32_t rows, int statePlanes) {
+    uint32_t corner[4];
+
+    if (statePlanes == 0) {
+        corner[0] = corner[1] = corner[2] = corner[3] = planes[0] & rows;
+    } else {
+        corner[0] = corner[1] = corner[2] = corner[3] = 0;
+        for (int value = 1; value < (1 << statePlanes); value++) {
+            // the cells in this state
+            uint32_t cells = rows;
+            for (int p = 0; p < statePlanes; p++) {
+                cells &= ((value >> p) & 1) ? planes[p + 1] : ~planes[p + 1];
+            }
+            for (int c = 0; c < 4; c++) {
+                if ((statePixels[value] >> c) & 1) {
+                    corner[c] |= cells;
+                }
             }
         }
     }
-}
\ No newline at end of file
+
+    // a pixel column word is already 4 page bytes
+    uint32_t left, right;
+    if (viewZoom == ZOOM_1X) {
+        left = right = corner[0] | corner[1] | corner[2] | corner[3];
+    } else if (viewZoom == ZOOM_2X) {
+        // 16 cells: cell y is pixel rows 2y (top quarters) and 2y + 1
+        left = CAG_display_spread(corner[0]) | (CAG_display_spread(corner[2]) << 1);
+        right = CAG_display_spread(corner[1]) | (CAG_display_spread(corner[3]) << 1);
+    } else {
+        // 8 cells: cell y is pixel rows 4y, 4y + 1 (top quarters), 4y + 2 and 4y + 3
+        uint32_t top = CAG_display_spread(CAG_display_spread(corner[0]));
+        uint32_t bottom = CAG_display_spread(CAG_display_spread(corner[2]));
+        left = (top * 3) | (bottom * 12);
+        top = CAG_display_spread(CAG_display_spread(corner[1]));
+        bottom = CAG_display_spread(CAG_display_spread(corner[3]));
+        right = (top * 3) | (bottom * 12);
+    }
+    int size = 1 << viewZoom;
+    for (int i = 0; i < size; i++) {
+        CAG_display_column(column + i, (2 * i < size) ? left : right);
+    }
+}
+
+// writes a pixel column word (bit y for pixel row y) into the 4 pages of the frame
+void CAG_display_column(int column, uint32_t pixels) {
+    for (int page = 0; page < OLED_PAGES; page++) {
+        frame[page * SSD1306_WIDTH + column] = pixels >> (8 * page);
+    }
+}
+
+// moves bit i of the low 16 bits of a word to bit 2 * i
+uint32_t CAG_display_spread(uint32_t cells) {
+    cells &= 0xFFFF;
+    cells = (cells | (cells << 8)) & 0x00FF00FF;
+    cells = (cells | (cells << 4)) & 0x0F0F0F0F;
+    cells = (cells | (cells << 2)) & 0x33333333;
+    cells = (cells | (cells << 1)) & 0x55555555;
+    return cells;
+}
+
+// returns bit i set for every group of n bits i * n .. i * n + n - 1 of a
+// word with a bit set (n a power of two, up to 32)
+uint32_t CAG_display_fold(uint32_t cells, int n) {
+    uint32_t pixels = 0;
+    for (int i = 0; i < 32 / n; i++) {
+        if ((cells >> (i * n)) & ((n < 32) ? (((uint32_t)1 << n) - 1) : 0xFFFFFFFFu)) {
+            pixels |= (uint32_t)1 << i;
+        }
+    }
+    return pixels;
+}
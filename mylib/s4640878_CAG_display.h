@@ -10,6 +10,12 @@
  * EXTERNAL FUNCTIONS 
  ***************************************************************
  * s4640878_tsk_CAG_display_init() - initialises CAG display
+ * s4640878_lib_CAG_display_refresh() - requests a frame
+ * s4640878_lib_CAG_display_set_fps() - sets the highest frame rate
+ * s4640878_lib_CAG_display_get_stats() - gets the frame counts
+ * s4640878_lib_CAG_display_pan() - moves the view
+ * s4640878_lib_CAG_display_zoom() - zooms the view in or out
+ * s4640878_lib_CAG_display_zoom_cycle() - zooms the view out a step, or back in from the whole universe
  *************************************************************** 
  */
 
@@ -19,12 +25,38 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "event_groups.h"
+#include "semphr.h"
+#include <stdint.h>
 
 // CAGDisplay task definitions
 #define CAG_DISPLAY_TASK_PRIORITY (tskIDLE_PRIORITY + 2)
 #define CAG_DISPLAY_TASK_STACKSIZE (configMINIMAL_STACK_SIZE * 2)
 
+// highest frame rate: requests coming faster are drawn together by one frame
+#ifndef CAG_DISPLAY_FPS
+#define CAG_DISPLAY_FPS 20
+#endif
+#define CAG_DISPLAY_FPS_MIN 1
+#define CAG_DISPLAY_FPS_MAX 50
+
+// frame counts since start
+typedef struct caDisplayStats {
+    uint32_t requests;          // refresh requests
+    uint32_t frames;            // frames drawn
+    uint32_t merged;            // requests drawn by a frame already requested
+    uint32_t skipped;           // generations computed but never shown
+    int fps;                    // highest frame rate
+} caDisplayStats_t;
+
+SemaphoreHandle_t s4640878SemaphoreCAGDisplay;      // given when something shown changed
+
 // external function declarations
 void s4640878_tsk_CAG_display_init(void);
+void s4640878_lib_CAG_display_refresh(void);
+void s4640878_lib_CAG_display_set_fps(int fps);
+void s4640878_lib_CAG_display_get_stats(caDisplayStats_t *stats);
+void s4640878_lib_CAG_display_pan(int dx, int dy);
+void s4640878_lib_CAG_display_zoom(int steps);
+void s4640878_lib_CAG_display_zoom_cycle(void);
 
 #endif
\ No newline at end of file
@@ -15,6 +15,7 @@
 
 #include "s4640878_CAG_grid.h"
 #include "s4640878_CAG_simulator.h"
+#include "s4640878_CAG_display.h"
 #include "s4640878_oled.h"
 #include "s4640878_lta1000g.h"
 #include "board.h"
@@ -51,7 +52,7 @@ void s4640878TaskCAGGrid(void) {
         } else {
             BRD_LEDGreenOff();
         }
-        vTaskDelay(100);    // delay 0.1s
+        vTaskDelay(20);     // delay 20ms, a key reaches the display within a frame
     }
 }
 
@@ -113,6 +114,31 @@ void CAG_grid_process_input(void) {
             case 'c':
                 uxBits = xEventGroupSetBits(GroupEventCAGGrid, CLEAR_DISPLAY);
                 break;
+            // the view is the display's, so these go to it directly
+            case 'I':
+            case 'i':
+                s4640878_lib_CAG_display_pan(0, -1);    // pan up
+                break;
+            case 'K':
+            case 'k':
+                s4640878_lib_CAG_display_pan(0, 1);     // pan down
+                break;
+            case 'J':
+            case 'j':
+                s4640878_lib_CAG_display_pan(-1, 0);    // pan left
+                break;
+            case 'L':
+            case 'l':
+                s4640878_lib_CAG_display_pan(1, 0);     // pan right
+                break;
+            case '+':
+            case '=':
+                s4640878_lib_CAG_display_zoom(1);       // zoom in
+                break;
+            case '-':
+            case '_':
+                s4640878_lib_CAG_display_zoom(-1);      // zoom out
+                break;
         }
     }
 }
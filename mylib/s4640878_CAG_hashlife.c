@@ -0,0 +1,808 @@
+/**
+ **************************************************************
+ * @file mylib/s4640878_CAG_hashlife.c
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief CAGHashlife - memoized quadtree engine (c file)
+ *        the pattern is a quadtree of hash-consed nodes, the result of
+ *        each node (its centre 2^(level - 2) generations later) is cached,
+ *        so repeated structure in space and time is only computed once.
+ *        models an unbounded plane: the result matches the universe
+ *        engines while the pattern stays clear of the universe edges.
+ *        cells copied back into a universe get state value 1.
+ *        (board: nucleo-f401)
+ * REFERENCE: csse3010_project.pdf (spec sheet)
+ *            Gosper, "Exploiting regularities in large cellular spaces"
+ *            golly macrocell format ([M2])
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * s4640878_lib_CAG_hashlife_create() - creates a hashlife engine
+ * s4640878_lib_CAG_hashlife_delete() - deletes a hashlife engine
+ * s4640878_lib_CAG_hashlife_clear() - kills every cell
+ * s4640878_lib_CAG_hashlife_set_cell() - sets a cell alive or dead
+ * s4640878_lib_CAG_hashlife_get_cell() - gets a cell
+ * s4640878_lib_CAG_hashlife_load_universe() - copies live cells from a universe
+ * s4640878_lib_CAG_hashlife_store_universe() - copies live cells into a universe
+ * s4640878_lib_CAG_hashlife_can_jump() - checks a jump of a universe matches stepping it
+ * s4640878_lib_CAG_hashlife_jump() - advances 2^k generations
+ * s4640878_lib_CAG_hashlife_gc() - frees nodes not used by the pattern
+ * s4640878_lib_CAG_hashlife_set_rule() - selects the rule
+ * s4640878_lib_CAG_hashlife_save_macrocell() - writes the pattern as a macrocell
+ * s4640878_lib_CAG_hashlife_load_macrocell() - reads a macrocell pattern
+ * s4640878_lib_CAG_hashlife_get_memory() - gets the bytes of the node cache in use
+ ***************************************************************
+ */
+
+#include "s4640878_CAG_hashlife.h"
+#include <stdlib.h>
+#include <string.h>
+
+// level 0 nodes
+#define DEAD_NODE 1
+#define ALIVE_NODE 2
+#define FREE_LEVEL 0xFF
+
+// child positions
+#define NW 0
+#define NE 1
+#define SW 2
+#define SE 3
+
+// smallest root (8x8, one macrocell leaf)
+#define MIN_ROOT_LEVEL 3
+#define LINE_LEN 128
+
+// shorthand for the child of a node
+#define CHILD(h, n, q) ((h)->node[n].child[q])
+
+// internal function declarations
+uint32_t CAG_hashlife_hash(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se);
+uint32_t CAG_hashlife_join(caHashlife_t *hashlife, uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se);
+uint32_t CAG_hashlife_expand(caHashlife_t *hashlife, uint32_t n);
+uint32_t CAG_hashlife_centre(caHashlife_t *hashlife, uint32_t n);
+int CAG_hashlife_is_padded(caHashlife_t *hashlife, uint32_t n);
+uint32_t CAG_hashlife_base(caHashlife_t *hashlife, uint32_t n);
+uint32_t CAG_hashlife_advance(caHashlife_t *hashlife, uint32_t n, int j);
+uint32_t CAG_hashlife_set(caHashlife_t *hashlife, uint32_t n, int64_t x, int64_t y, int alive);
+uint32_t CAG_hashlife_build(caHashlife_t *hashlife, caUniverse_t *universe, int level, int x0, int y0);
+void CAG_hashlife_store(caHashlife_t *hashlife, caUniverse_t *universe, uint32_t n, int64_t x0, int64_t y0);
+void CAG_hashlife_mark(caHashlife_t *hashlife, uint32_t n);
+void CAG_hashlife_flush(caHashlife_t *hashlife);
+void CAG_hashlife_reset(caHashlife_t *hashlife);
+void CAG_hashlife_write_string(void (*writeChar)(char, void *), void *arg, const char *string);
+void CAG_hashlife_write_number(void (*writeChar)(char, void *), void *arg, int64_t number);
+uint32_t CAG_hashlife_write_node(caHashlife_t *hashlife, uint32_t n, uint32_t *lineOf, uint32_t *lines,
+        void (*writeChar)(char, void *), void *arg);
+uint32_t CAG_hashlife_leaf(caHashlife_t *hashlife, uint8_t *rows, int level, int x0, int y0);
+int CAG_hashlife_parse_number(const char **text, int64_t *number);
+
+// hash of the four children of a node
+uint32_t CAG_hashlife_hash(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se) {
+    uint32_t h = nw * 0x9E3779B1UL;
+    h = (h ^ (h >> 15)) + ne * 0x85EBCA77UL;
+    h = (h ^ (h >> 13)) + sw * 0xC2B2AE3DUL;
+    h = (h ^ (h >> 16)) + se * 0x27D4EB2FUL;
+    return h ^ (h >> 15);
+}
+
+// creates a hashlife engine with room for maxNodes nodes, NULL if out of memory
+caHashlife_t *s4640878_lib_CAG_hashlife_create(uint32_t maxNodes) {
+    if (maxNodes < 4 * CAG_HASHLIFE_MAX_LEVEL) {
+        maxNodes = 4 * CAG_HASHLIFE_MAX_LEVEL;
+    }
+    caHashlife_t *hashlife = calloc(1, sizeof(caHashlife_t));
+    if (hashlife == NULL) {
+        return NULL;
+    }
+    // power of two number of buckets, about one per node
+    uint32_t buckets = 1;
+    while (buckets < maxNodes) {
+        buckets <<= 1;
+    }
+    hashlife->node = malloc(maxNodes * sizeof(caNode_t));
+    hashlife->bucket = malloc(buckets * sizeof(uint32_t));
+    if ((hashlife->node == NULL) || (hashlife->bucket == NULL)) {
+        s4640878_lib_CAG_hashlife_delete(hashlife);
+        return NULL;
+    }
+    hashlife->bucketMask = buckets - 1;
+    hashlife->maxNodes = maxNodes;
+    s4640878_lib_CAG_universe_parse_rule(&hashlife->rule, CAG_RULE_DEFAULT);
+    CAG_hashlife_reset(hashlife);
+    return hashlife;
+}
+
+// frees a hashlife engine
+void s4640878_lib_CAG_hashlife_delete(caHashlife_t *hashlife) {
+    if (hashlife == NULL) {
+        return;
+    }
+    free(hashlife->node);
+    free(hashlife->bucket);
+    free(hashlife);
+}
+
+// empties the node cache and creates the level 0 and empty nodes
+void CAG_hashlife_reset(caHashlife_t *hashlife) {
+    memset(hashlife->bucket, 0, (hashlife->bucketMask + 1) * sizeof(uint32_t));
+    memset(&hashlife->node[0], 0, 3 * sizeof(caNode_t));
+    hashlife->used = 3;
+    hashlife->live = 2;
+    hashlife->freeList = 0;
+    hashlife->overflow = 0;
+    hashlife->empty[0] = DEAD_NODE;
+    for (int level = 1; level <= CAG_HASHLIFE_MAX_LEVEL; level++) {
+        uint32_t e = hashlife->empty[level - 1];
+        hashlife->empty[level] = CAG_hashlife_join(hashlife, e, e, e, e);
+    }
+    hashlife->root = hashlife->empty[MIN_ROOT_LEVEL];
+    hashlife->originX = 0;
+    hashlife->originY = 0;
+    hashlife->generation = 0;
+}
+
+// kills every cell (the node cache is emptied too)
+void s4640878_lib_CAG_hashlife_clear(caHashlife_t *hashlife) {
+    CAG_hashlife_reset(hashlife);
+}
+
+// returns the node with the given children, creating it if needed
+// if the arena is full the overflow flag is set and an empty node is returned
+uint32_t CAG_hashlife_join(caHashlife_t *hashlife, uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se) {
+    int level = hashlife->node[nw].level + 1;
+    uint32_t *head = &hashlife->bucket[CAG_hashlife_hash(nw, ne, sw, se) & hashlife->bucketMask];
+    for (uint32_t n = *head; n != 0; n = hashlife->node[n].next) {
+        caNode_t *node = &hashlife->node[n];
+        if ((node->child[NW] == nw) && (node->child[NE] == ne) && (node->child[SW] == sw) && (node->child[SE] == se)) {
+            return n;
+        }
+    }
+
+    // allocate from the free list, then from the unused part of the arena
+    uint32_t n = hashlife->freeList;
+    if (n != 0) {
+        hashlife->freeList = hashlife->node[n].next;
+    } else if (hashlife->used < hashlife->maxNodes) {
+        n = hashlife->used++;
+    } else {
+        hashlife->overflow = 1;
+        return hashlife->empty[level];
+    }
+    caNode_t *node = &hashlife->node[n];
+    node->child[NW] = nw;
+    node->child[NE] = ne;
+    node->child[SW] = sw;
+    node->child[SE] = se;
+    node->level = level;
+    node->result = 0;
+    node->mark = 0;
+    node->next = *head;
+    *head = n;
+    hashlife->live++;
+    return n;
+}
+
+// returns a node one level up with n in the centre
+uint32_t CAG_hashlife_expand(caHashlife_t *hashlife, uint32_t n) {
+    uint32_t e = hashlife->empty[hashlife->node[n].level - 1];
+    return CAG_hashlife_join(hashlife,
+            CAG_hashlife_join(hashlife, e, e, e, CHILD(hashlife, n, NW)),
+            CAG_hashlife_join(hashlife, e, e, CHILD(hashlife, n, NE), e),
+            CAG_hashlife_join(hashlife, e, CHILD(hashlife, n, SW), e, e),
+            CAG_hashlife_join(hashlife, CHILD(hashlife, n, SE), e, e, e));
+}
+
+// returns the centre half of n (one level down, no time step)
+uint32_t CAG_hashlife_centre(caHashlife_t *hashlife, uint32_t n) {
+    return CAG_hashlife_join(hashlife,
+            CHILD(hashlife, CHILD(hashlife, n, NW), SE), CHILD(hashlife, CHILD(hashlife, n, NE), SW),
+            CHILD(hashlife, CHILD(hashlife, n, SW), NE), CHILD(hashlife, CHILD(hashlife, n, SE), NW));
+}
+
+// returns 1 if every live cell of n is inside its centre half
+int CAG_hashlife_is_padded(caHashlife_t *hashlife, uint32_t n) {
+    uint32_t e = hashlife->empty[hashlife->node[n].level - 2];
+    uint32_t nw = CHILD(hashlife, n, NW), ne = CHILD(hashlife, n, NE);
+    uint32_t sw = CHILD(hashlife, n, SW), se = CHILD(hashlife, n, SE);
+    return (CHILD(hashlife, nw, NW) == e) && (CHILD(hashlife, nw, NE) == e) && (CHILD(hashlife, nw, SW) == e)
+            && (CHILD(hashlife, ne, NW) == e) && (CHILD(hashlife, ne, NE) == e) && (CHILD(hashlife, ne, SE) == e)
+            && (CHILD(hashlife, sw, NW) == e) && (CHILD(hashlife, sw, SW) == e) && (CHILD(hashlife, sw, SE) == e)
+            && (CHILD(hashlife, se, NE) == e) && (CHILD(hashlife, se, SW) == e) && (CHILD(hashlife, se, SE) == e);
+}
+
+// computes the centre 2x2 of a 4x4 (level 2) node one generation later
+uint32_t CAG_hashlife_base(caHashlife_t *hashlife, uint32_t n) {
+    int grid[4][4];
+    for (int q = 0; q < 4; q++) {
+        uint32_t quad = CHILD(hashlife, n, q);
+        for (int c = 0; c < 4; c++) {
+            grid[2 * (q >> 1) + (c >> 1)][2 * (q & 1) + (c & 1)] = (CHILD(hashlife, quad, c) == ALIVE_NODE);
+        }
+    }
+    uint32_t out[4];
+    for (int c = 0; c < 4; c++) {
+        int y = 1 + (c >> 1), x = 1 + (c & 1);
+        int count = 0;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                if ((dx != 0) || (dy != 0)) {
+                    count += grid[y + dy][x + dx];
+                }
+            }
+        }
+        int alive = grid[y][x] ? (hashlife->rule.survive >> count) & 1 : (hashlife->rule.birth >> count) & 1;
+        out[c] = alive ? ALIVE_NODE : DEAD_NODE;
+    }
+    return CAG_hashlife_join(hashlife, out[NW], out[NE], out[SW], out[SE]);
+}
+
+// returns the centre half of n advanced by 2^j generations (0 <= j <= level - 2)
+// only full speed results (j == level - 2) are cached
+uint32_t CAG_hashlife_advance(caHashlife_t *hashlife, uint32_t n, int j) {
+    int level = hashlife->node[n].level;
+    if (n == hashlife->empty[level]) {
+        return hashlife->empty[level - 1];
+    }
+    if (level == 2) {
+        return CAG_hashlife_base(hashlife, n);
+    }
+    int full = (j == level - 2);
+    if (full && (hashlife->node[n].result != 0)) {
+        return hashlife->node[n].result;
+    }
+
+    // nine overlapping sub-squares, one level down
+    uint32_t nw = CHILD(hashlife, n, NW), ne = CHILD(hashlife, n, NE);
+    uint32_t sw = CHILD(hashlife, n, SW), se = CHILD(hashlife, n, SE);
+    uint32_t sub[9];
+    sub[0] = nw;
+    sub[1] = CAG_hashlife_join(hashlife, CHILD(hashlife, nw, NE), CHILD(hashlife, ne, NW),
+            CHILD(hashlife, nw, SE), CHILD(hashlife, ne, SW));
+    sub[2] = ne;
+    sub[3] = CAG_hashlife_join(hashlife, CHILD(hashlife, nw, SW), CHILD(hashlife, nw, SE),
+            CHILD(hashlife, sw, NW), CHILD(hashlife, sw, NE));
+    sub[4] = CAG_hashlife_join(hashlife, CHILD(hashlife, nw, SE), CHILD(hashlife, ne, SW),
+            CHILD(hashlife, sw, NE), CHILD(hashlife, se, NW));
+    sub[5] = CAG_hashlife_join(hashlife, CHILD(hashlife, ne, SW), CHILD(hashlife, ne, SE),
+            CHILD(hashlife, se, NW), CHILD(hashlife, se, NE));
+    sub[6] = sw;
+    sub[7] = CAG_hashlife_join(hashlife, CHILD(hashlife, sw, NE), CHILD(hashlife, se, NW),
+            CHILD(hashlife, sw, SE), CHILD(hashlife, se, SW));
+    sub[8] = se;
+
+    // first half of the step (full speed) or no step at all (slow)
+    for (int i = 0; i < 9; i++) {
+        sub[i] = full ? CAG_hashlife_advance(hashlife, sub[i], level - 3) : CAG_hashlife_centre(hashlife, sub[i]);
+    }
+
+    // second half of the step on the four overlapping quadrants
+    int step = full ? level - 3 : j;
+    uint32_t result = CAG_hashlife_join(hashlife,
+            CAG_hashlife_advance(hashlife, CAG_hashlife_join(hashlife, sub[0], sub[1], sub[3], sub[4]), step),
+            CAG_hashlife_advance(hashlife, CAG_hashlife_join(hashlife, sub[1], sub[2], sub[4], sub[5]), step),
+            CAG_hashlife_advance(hashlife, CAG_hashlife_join(hashlife, sub[3], sub[4], sub[6], sub[7]), step),
+            CAG_hashlife_advance(hashlife, CAG_hashlife_join(hashlife, sub[4], sub[5], sub[7], sub[8]), step));
+    if (full && !hashlife->overflow) {
+        hashlife->node[n].result = result;
+    }
+    return result;
+}
+
+// returns n with cell (x, y) (relative to the node) set alive or dead
+uint32_t CAG_hashlife_set(caHashlife_t *hashlife, uint32_t n, int64_t x, int64_t y, int alive) {
+    int level = hashlife->node[n].level;
+    if (level == 0) {
+        return alive ? ALIVE_NODE : DEAD_NODE;
+    }
+    int64_t half = ((int64_t)1) << (level - 1);
+    int q = ((y >= half) << 1) | (x >= half);
+    uint32_t child[4];
+    memcpy(child, hashlife->node[n].child, sizeof(child));
+    child[q] = CAG_hashlife_set(hashlife, child[q], x & (half - 1), y & (half - 1), alive);
+    return CAG_hashlife_join(hashlife, child[NW], child[NE], child[SW], child[SE]);
+}
+
+// sets cell (x, y) alive or dead, the tree grows to cover the cell
+void s4640878_lib_CAG_hashlife_set_cell(caHashlife_t *hashlife, int64_t x, int64_t y, int alive) {
+    for (;;) {
+        int level = hashlife->node[hashlife->root].level;
+        int64_t size = ((int64_t)1) << level;
+        if ((x >= hashlife->originX) && (x < hashlife->originX + size)
+                && (y >= hashlife->originY) && (y < hashlife->originY + size)) {
+            break;
+        }
+        if (level >= CAG_HASHLIFE_MAX_LEVEL) {
+            return;
+        }
+        hashlife->root = CAG_hashlife_expand(hashlife, hashlife->root);
+        hashlife->originX -= size / 2;
+        hashlife->originY -= size / 2;
+    }
+    hashlife->root = CAG_hashlife_set(hashlife, hashlife->root, x - hashlife->originX, y - hashlife->originY, alive);
+}
+
+// returns 1 if cell (x, y) is alive
+int s4640878_lib_CAG_hashlife_get_cell(caHashlife_t *hashlife, int64_t x, int64_t y) {
+    uint32_t n = hashlife->root;
+    int level = hashlife->node[n].level;
+    x -= hashlife->originX;
+    y -= hashlife->originY;
+    if ((x < 0) || (y < 0) || (x >= (((int64_t)1) << level)) || (y >= (((int64_t)1) << level))) {
+        return 0;
+    }
+    while (level > 0) {
+        int64_t half = ((int64_t)1) << (level - 1);
+        n = CHILD(hashlife, n, ((y >= half) << 1) | (x >= half));
+        x &= half - 1;
+        y &= half - 1;
+        level--;
+    }
+    return n == ALIVE_NODE;
+}
+
+// builds the node for the universe square at (x0, y0) of the given level
+uint32_t CAG_hashlife_build(caHashlife_t *hashlife, caUniverse_t *universe, int level, int x0, int y0) {
+    if ((x0 >= universe->width) || (y0 >= universe->height)) {
+        return hashlife->empty[level];
+    }
+    if (level <= CAG_TILE_SHIFT) {
+        // inside one tile, skip it if it has no live cell
+        int slot = universe->tileSlot[(y0 >> CAG_TILE_SHIFT) * universe->tilesX + (x0 >> CAG_TILE_SHIFT)];
+        if (!universe->occupied[universe->current][slot]) {
+            return hashlife->empty[level];
+        }
+        if (level == 0) {
+            cag_word_t column = universe->tiles[universe->current][slot].plane[0][x0 & (CAG_TILE_BITS - 1)];
+            return ((column >> (y0 & (CAG_TILE_BITS - 1))) & 1) ? ALIVE_NODE : DEAD_NODE;
+        }
+    }
+    int half = 1 << (level - 1);
+    return CAG_hashlife_join(hashlife,
+            CAG_hashlife_build(hashlife, universe, level - 1, x0, y0),
+            CAG_hashlife_build(hashlife, universe, level - 1, x0 + half, y0),
+            CAG_hashlife_build(hashlife, universe, level - 1, x0, y0 + half),
+            CAG_hashlife_build(hashlife, universe, level - 1, x0 + half, y0 + half));
+}
+
+// replaces the pattern with the live cells of a universe (top-left at (0, 0))
+void s4640878_lib_CAG_hashlife_load_universe(caHashlife_t *hashlife, caUniverse_t *universe) {
+    int level = MIN_ROOT_LEVEL;
+    while (((1 << level) < universe->width) || ((1 << level) < universe->height)) {
+        level++;
+    }
+    // keep the cached results, only the pattern changes
+    hashlife->root = CAG_hashlife_build(hashlife, universe, level, 0, 0);
+    hashlife->originX = 0;
+    hashlife->originY = 0;
+    hashlife->generation = 0;
+}
+
+// writes the live cells of n (top-left at (x0, y0)) into a universe
+void CAG_hashlife_store(caHashlife_t *hashlife, caUniverse_t *universe, uint32_t n, int64_t x0, int64_t y0) {
+    int level = hashlife->node[n].level;
+    int64_t size = ((int64_t)1) << level;
+    if ((n == hashlife->empty[level]) || (x0 >= universe->width) || (y0 >= universe->height)
+            || (x0 + size <= 0) || (y0 + size <= 0)) {
+        return;
+    }
+    if (level == 0) {
+        s4640878_lib_CAG_universe_set_cell(universe, (int)x0, (int)y0, 1);
+        return;
+    }
+    int64_t half = size / 2;
+    CAG_hashlife_store(hashlife, universe, CHILD(hashlife, n, NW), x0, y0);
+    CAG_hashlife_store(hashlife, universe, CHILD(hashlife, n, NE), x0 + half, y0);
+    CAG_hashlife_store(hashlife, universe, CHILD(hashlife, n, SW), x0, y0 + half);
+    CAG_hashlife_store(hashlife, universe, CHILD(hashlife, n, SE), x0 + half, y0 + half);
+}
+
+// replaces the universe contents with the pattern, cells outside the universe are dropped
+void s4640878_lib_CAG_hashlife_store_universe(caHashlife_t *hashlife, caUniverse_t *universe) {
+    s4640878_lib_CAG_universe_clear(universe);
+    CAG_hashlife_store(hashlife, universe, hashlife->root, hashlife->originX, hashlife->originY);
+}
+
+// returns 1 if a jump of 2^k generations gives the cells stepping the universe
+// would: a life rule, dead edges, and the live cells far enough from the edges
+// that none (one cell a generation) can reach them, so the unbounded plane
+// hashlife runs on never differs from the universe
+int s4640878_lib_CAG_hashlife_can_jump(caUniverse_t *universe, int k) {
+    caBounds_t bounds;
+    if ((k < 0) || (k > CAG_HASHLIFE_MAX_LEVEL - 4) || (universe->rule.family != CAG_FAMILY_LIFE)
+            || (s4640878_lib_CAG_universe_get_boundary(universe) != CAG_BOUNDARY_DEAD)) {
+        return 0;
+    }
+    if (!s4640878_lib_CAG_universe_get_bounds(universe, &bounds)) {
+        return 1;
+    }
+    int64_t reach = (int64_t)1 << k;
+    return (bounds.x0 - reach >= 0) && (bounds.y0 - reach >= 0)
+            && (bounds.x1 + reach < universe->width) && (bounds.y1 + reach < universe->height);
+}
+
+// advances the pattern by 2^k generations in one call
+// returns CAG_HASHLIFE_OK, or CAG_HASHLIFE_FULL if the node cache is too small
+int s4640878_lib_CAG_hashlife_jump(caHashlife_t *hashlife, int k) {
+    if ((k < 0) || (k > CAG_HASHLIFE_MAX_LEVEL - 4)) {
+        return CAG_HASHLIFE_FULL;
+    }
+    if (hashlife->live > hashlife->maxNodes / 4 * 3) {
+        s4640878_lib_CAG_hashlife_gc(hashlife);
+    }
+    for (int attempt = 0; attempt < 2; attempt++) {
+        uint32_t root = hashlife->root;
+        int64_t originX = hashlife->originX, originY = hashlife->originY;
+        hashlife->overflow = 0;
+
+        // pad until the pattern fits the centre half of a node at least k + 2 levels
+        // deep, then once more so growing at light speed cannot leave the result
+        int level = hashlife->node[root].level;
+        int padded = 0;
+        while (!padded) {
+            padded = (level >= k + 2) && CAG_hashlife_is_padded(hashlife, root);
+            if (level >= CAG_HASHLIFE_MAX_LEVEL) {
+                return CAG_HASHLIFE_FULL;
+            }
+            root = CAG_hashlife_expand(hashlife, root);
+            originX -= ((int64_t)1) << (level - 1);
+            originY -= ((int64_t)1) << (level - 1);
+            level++;
+        }
+        root = CAG_hashlife_advance(hashlife, root, k);
+        originX += ((int64_t)1) << (level - 2);
+        originY += ((int64_t)1) << (level - 2);
+
+        if (!hashlife->overflow) {
+            // drop the empty border again
+            level--;
+            while ((level > MIN_ROOT_LEVEL) && CAG_hashlife_is_padded(hashlife, root)) {
+                root = CAG_hashlife_centre(hashlife, root);
+                originX += ((int64_t)1) << (level - 2);
+                originY += ((int64_t)1) << (level - 2);
+                level--;
+            }
+            hashlife->root = root;
+            hashlife->originX = originX;
+            hashlife->originY = originY;
+            hashlife->generation += ((uint64_t)1) << k;
+            return CAG_HASHLIFE_OK;
+        }
+        // results cached while the arena was full are not trusted
+        CAG_hashlife_flush(hashlife);
+        s4640878_lib_CAG_hashlife_gc(hashlife);
+    }
+    hashlife->overflow = 0;
+    return CAG_HASHLIFE_FULL;
+}
+
+// marks n and everything below it as in use
+void CAG_hashlife_mark(caHashlife_t *hashlife, uint32_t n) {
+    caNode_t *node = &hashlife->node[n];
+    if (node->mark || (node->level == 0)) {
+        return;
+    }
+    node->mark = 1;
+    for (int q = 0; q < 4; q++) {
+        CAG_hashlife_mark(hashlife, node->child[q]);
+    }
+}
+
+// forgets every cached result
+void CAG_hashlife_flush(caHashlife_t *hashlife) {
+    for (uint32_t n = 3; n < hashlife->used; n++) {
+        hashlife->node[n].result = 0;
+    }
+}
+
+// frees every node that is not part of the pattern or an empty node
+// cached results pointing at freed nodes are forgotten
+void s4640878_lib_CAG_hashlife_gc(caHashlife_t *hashlife) {
+    for (uint32_t n = 3; n < hashlife->used; n++) {
+        hashlife->node[n].mark = 0;
+    }
+    CAG_hashlife_mark(hashlife, hashlife->root);
+    CAG_hashlife_mark(hashlife, hashlife->empty[CAG_HASHLIFE_MAX_LEVEL]);
+
+    memset(hashlife->bucket, 0, (hashlife->bucketMask + 1) * sizeof(uint32_t));
+    hashlife->freeList = 0;
+    hashlife->live = 2;
+    for (uint32_t n = hashlife->used - 1; n >= 3; n--) {
+        caNode_t *node = &hashlife->node[n];
+        if (!node->mark) {
+            node->level = FREE_LEVEL;
+            node->next = hashlife->freeList;
+            hashlife->freeList = n;
+        } else {
+            uint32_t *head = &hashlife->bucket[CAG_hashlife_hash(node->child[NW], node->child[NE],
+                    node->child[SW], node->child[SE]) & hashlife->bucketMask];
+            node->next = *head;
+            *head = n;
+            hashlife->live++;
+        }
+    }
+    for (uint32_t n = 3; n < hashlife->used; n++) {
+        caNode_t *node = &hashlife->node[n];
+        if ((node->level != FREE_LEVEL) && (node->result != 0) && !hashlife->node[node->result].mark) {
+            node->result = 0;
+        }
+    }
+}
+
+// writes a string through the write callback
+void CAG_hashlife_write_string(void (*writeChar)(char, void *), void *arg, const char *string) {
+    while (*string != '\0') {
+        writeChar(*string++, arg);
+    }
+}
+
+// writes a decimal number through the write callback
+void CAG_hashlife_write_number(void (*writeChar)(char, void *), void *arg, int64_t number) {
+    char digits[24];
+    int len = 0;
+    uint64_t value = (number < 0) ? (uint64_t)(-number) : (uint64_t)number;
+    do {
+        digits[len++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
+    if (number < 0) {
+        writeChar('-', arg);
+    }
+    while (len > 0) {
+        writeChar(digits[--len], arg);
+    }
+}
+
+// writes n and its children as macrocell lines, returns the line of n (0: empty)
+uint32_t CAG_hashlife_write_node(caHashlife_t *hashlife, uint32_t n, uint32_t *lineOf, uint32_t *lines,
+        void (*writeChar)(char, void *), void *arg) {
+    int level = hashlife->node[n].level;
+    if (n == hashlife->empty[level]) {
+        return 0;
+    }
+    if (lineOf[n] != 0) {
+        return lineOf[n];
+    }
+    if (level == MIN_ROOT_LEVEL) {
+        // 8x8 leaf: '.' dead, '*' alive, '$' ends a row, trailing dead cells and rows left out
+        char text[8 * 9 + 1];
+        int len = 0, end = 0;
+        for (int y = 0; y < 8; y++) {
+            int rowEnd = len;
+            for (int x = 0; x < 8; x++) {
+                uint32_t cell = n;
+                for (int l = MIN_ROOT_LEVEL; l > 0; l--) {
+                    int half = 1 << (l - 1);
+                    cell = CHILD(hashlife, cell, (((y & (2 * half - 1)) >= half) << 1) | ((x & (2 * half - 1)) >= half));
+                }
+                text[len++] = (cell == ALIVE_NODE) ? '*' : '.';
+                if (cell == ALIVE_NODE) {
+                    rowEnd = len;
+                }
+            }
+            len = rowEnd;
+            text[len++] = '$';
+            if (rowEnd > 0 && text[rowEnd - 1] == '*') {
+                end = len;
+            }
+        }
+        text[end] = '\0';
+        CAG_hashlife_write_string(writeChar, arg, text);
+    } else {
+        uint32_t child[4];
+        for (int q = 0; q < 4; q++) {
+            child[q] = CAG_hashlife_write_node(hashlife, CHILD(hashlife, n, q), lineOf, lines, writeChar, arg);
+        }
+        CAG_hashlife_write_number(writeChar, arg, level);
+        for (int q = 0; q < 4; q++) {
+            writeChar(' ', arg);
+            CAG_hashlife_write_number(writeChar, arg, child[q]);
+        }
+    }
+    writeChar('\n', arg);
+    lineOf[n] = ++(*lines);
+    return lineOf[n];
+}
+
+// writes the pattern in golly macrocell format through writeChar
+// the root position is kept in a "#C origin x y" comment
+int s4640878_lib_CAG_hashlife_save_macrocell(caHashlife_t *hashlife, void (*writeChar)(char c, void *arg), void *arg) {
+    uint32_t *lineOf = calloc(hashlife->maxNodes, sizeof(uint32_t));
+    if (lineOf == NULL) {
+        return CAG_HASHLIFE_FULL;
+    }
+    char rule[CAG_RULE_LEN];
+    s4640878_lib_CAG_universe_format_rule(&hashlife->rule, rule);
+    CAG_hashlife_write_string(writeChar, arg, "[M2] (s4640878 CAG)\n#R ");
+    CAG_hashlife_write_string(writeChar, arg, rule);
+    CAG_hashlife_write_string(writeChar, arg, "\n#G ");
+    CAG_hashlife_write_number(writeChar, arg, (int64_t)hashlife->generation);
+    CAG_hashlife_write_string(writeChar, arg, "\n#C origin ");
+    CAG_hashlife_write_number(writeChar, arg, hashlife->originX);
+    writeChar(' ', arg);
+    CAG_hashlife_write_number(writeChar, arg, hashlife->originY);
+    writeChar('\n', arg);
+
+    uint32_t lines = 0;
+    if (CAG_hashlife_write_node(hashlife, hashlife->root, lineOf, &lines, writeChar, arg) == 0) {
+        // empty pattern: a single empty leaf
+        CAG_hashlife_write_string(writeChar, arg, "$\n");
+    }
+    free(lineOf);
+    return CAG_HASHLIFE_OK;
+}
+
+// builds a node from 8x8 leaf rows (bit x of rows[y])
+uint32_t CAG_hashlife_leaf(caHashlife_t *hashlife, uint8_t *rows, int level, int x0, int y0) {
+    if (level == 0) {
+        return ((rows[y0] >> x0) & 1) ? ALIVE_NODE : DEAD_NODE;
+    }
+    int half = 1 << (level - 1);
+    return CAG_hashlife_join(hashlife,
+            CAG_hashlife_leaf(hashlife, rows, level - 1, x0, y0),
+            CAG_hashlife_leaf(hashlife, rows, level - 1, x0 + half, y0),
+            CAG_hashlife_leaf(hashlife, rows, level - 1, x0, y0 + half),
+            CAG_hashlife_leaf(hashlife, rows, level - 1, x0 + half, y0 + half));
+}
+
+// parses a (possibly negative) decimal number, returns 0 if there is none
+int CAG_hashlife_parse_number(const char **text, int64_t *number) {
+    const char *p = *text;
+    int negative = 0;
+    while (*p == ' ') {
+        p++;
+    }
+    if (*p == '-') {
+        negative = 1;
+        p++;
+    }
+    if ((*p < '0') || (*p > '9')) {
+        return 0;
+    }
+    int64_t value = 0;
+    while ((*p >= '0') && (*p <= '9')) {
+        value = value * 10 + (*p++ - '0');
+    }
+    *number = negative ? -value : value;
+    *text = p;
+    return 1;
+}
+
+// replaces the pattern with a golly macrocell read through readChar (-1 at the end)
+// returns CAG_HASHLIFE_OK, CAG_HASHLIFE_FORMAT or CAG_HASHLIFE_FULL
+int s4640878_lib_CAG_hashlife_load_macrocell(caHashlife_t *hashlife, int (*readChar)(void *arg), void *arg) {
+    uint32_t *nodeOf = NULL;        // line number -> node
+    uint32_t lines = 0, capacity = 0;
+    int64_t originX = 0, originY = 0, generation = 0;
+    int hasOrigin = 0, first = 1, status = CAG_HASHLIFE_OK;
+    char line[LINE_LEN];
+
+    CAG_hashlife_reset(hashlife);
+    for (;;) {
+        // read one line (long lines are cut short)
+        int len = 0, c;
+        while (((c = readChar(arg)) >= 0) && (c != '\n')) {
+            if ((c != '\r') && (len < LINE_LEN - 1)) {
+                line[len++] = (char)c;
+            }
+        }
+        line[len] = '\0';
+        if ((c < 0) && (len == 0)) {
+            break;
+        }
+        const char *p = line;
+        if (first) {
+            first = 0;
+            if (strncmp(line, "[M2]", 4) != 0) {
+                status = CAG_HASHLIFE_FORMAT;
+                break;
+            }
+            continue;
+        }
+        if (line[0] == '#') {
+            if (strncmp(line, "#R", 2) == 0) {
+                caRule_t rule;
+                if ((s4640878_lib_CAG_universe_parse_rule(&rule, line + 2) == 0) && (rule.family == CAG_FAMILY_LIFE)) {
+                    hashlife->rule = rule;
+                } else {
+                    status = CAG_HASHLIFE_FORMAT;
+                    break;
+                }
+            } else if (strncmp(line, "#G", 2) == 0) {
+                p += 2;
+                CAG_hashlife_parse_number(&p, &generation);
+            } else if (strncmp(line, "#C origin", 9) == 0) {
+                p += 9;
+                hasOrigin = CAG_hashlife_parse_number(&p, &originX) && CAG_hashlife_parse_number(&p, &originY);
+            }
+            continue;
+        }
+        if (len == 0) {
+            continue;
+        }
+
+        uint32_t n;
+        if ((line[0] == '.') || (line[0] == '*') || (line[0] == '$')) {
+            uint8_t rows[8] = {0};
+            int x = 0, y = 0;
+            for (; (*p != '\0') && (y < 8); p++) {
+                if (*p == '$') {
+                    x = 0;
+                    y++;
+                } else {
+                    if ((*p == '*') && (x < 8)) {
+                        rows[y] |= 1 << x;
+                    }
+                    x++;
+                }
+            }
+            n = CAG_hashlife_leaf(hashlife, rows, MIN_ROOT_LEVEL, 0, 0);
+        } else {
+            int64_t level, child[4];
+            int ok = CAG_hashlife_parse_number(&p, &level) && (level > MIN_ROOT_LEVEL) && (level <= CAG_HASHLIFE_MAX_LEVEL);
+            for (int q = 0; ok && (q < 4); q++) {
+                ok = CAG_hashlife_parse_number(&p, &child[q]) && (child[q] >= 0) && (child[q] <= lines);
+            }
+            uint32_t kids[4];
+            for (int q = 0; ok && (q < 4); q++) {
+                kids[q] = (child[q] == 0) ? hashlife->empty[level - 1] : nodeOf[child[q] - 1];
+                ok = (hashlife->node[kids[q]].level == level - 1);
+            }
+            if (!ok) {
+                status = CAG_HASHLIFE_FORMAT;
+                break;
+            }
+            n = CAG_hashlife_join(hashlife, kids[NW], kids[NE], kids[SW], kids[SE]);
+        }
+        if (hashlife->overflow) {
+            status = CAG_HASHLIFE_FULL;
+            break;
+        }
+        if (lines == capacity) {
+            capacity = (capacity == 0) ? 64 : capacity * 2;
+            uint32_t *grown = realloc(nodeOf, capacity * sizeof(uint32_t));
+            if (grown == NULL) {
+                status = CAG_HASHLIFE_FULL;
+                break;
+            }
+            nodeOf = grown;
+        }
+        nodeOf[lines++] = n;
+    }
+
+    if ((status == CAG_HASHLIFE_OK) && (lines == 0)) {
+        status = CAG_HASHLIFE_FORMAT;
+    }
+    if (status == CAG_HASHLIFE_OK) {
+        // golly puts the centre of the root at (0, 0)
+        uint32_t root = nodeOf[lines - 1];
+        int level = hashlife->node[root].level;
+        hashlife->root = root;
+        hashlife->originX = hasOrigin ? originX : -(((int64_t)1) << (level - 1));
+        hashlife->originY = hasOrigin ? originY : -(((int64_t)1) << (level - 1));
+        hashlife->generation = (uint64_t)generation;
+    } else {
+        CAG_hashlife_reset(hashlife);
+    }
+    free(nodeOf);
+    return status;
+}
+
+// selects the rule, cached results of another rule are forgotten
+// only two state (life family) rules are supported, others are ignored
+void s4640878_lib_CAG_hashlife_set_rule(caHashlife_t *hashlife, const caRule_t *rule) {
+    if (rule->family != CAG_FAMILY_LIFE) {
+        return;
+    }
+    if ((hashlife->rule.birth != rule->birth) || (hashlife->rule.survive != rule->survive)) {
+        hashlife->rule = *rule;
+        CAG_hashlife_flush(hashlife);
+    }
+}
+
+// returns the bytes of the engine in use: the hash table and the part of the
+// node arena handed out so far (a high-water mark, freed nodes are reused)
+uint32_t s4640878_lib_CAG_hashlife_get_memory(caHashlife_t *hashlife) {
+    return sizeof(caHashlife_t) + hashlife->used * sizeof(caNode_t)
+            + (hashlife->bucketMask + 1) * sizeof(uint32_t);
+}
@@ -0,0 +1,96 @@
+/**
+ **************************************************************
+ * @file mylib/s4640878_CAG_hashlife.h
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief CAGHashlife - memoized quadtree engine (header file)
+ *        (board: nucleo-f401)
+ * REFERENCE: csse3010_project.pdf (spec sheet)
+ *            Gosper, "Exploiting regularities in large cellular spaces"
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * s4640878_lib_CAG_hashlife_create() - creates a hashlife engine
+ * s4640878_lib_CAG_hashlife_delete() - deletes a hashlife engine
+ * s4640878_lib_CAG_hashlife_clear() - kills every cell
+ * s4640878_lib_CAG_hashlife_set_cell() - sets a cell alive or dead
+ * s4640878_lib_CAG_hashlife_get_cell() - gets a cell
+ * s4640878_lib_CAG_hashlife_load_universe() - copies live cells from a universe
+ * s4640878_lib_CAG_hashlife_store_universe() - copies live cells into a universe
+ * s4640878_lib_CAG_hashlife_can_jump() - checks a jump of a universe matches stepping it
+ * s4640878_lib_CAG_hashlife_jump() - advances 2^k generations
+ * s4640878_lib_CAG_hashlife_gc() - frees nodes not used by the pattern
+ * s4640878_lib_CAG_hashlife_set_rule() - selects the rule
+ * s4640878_lib_CAG_hashlife_save_macrocell() - writes the pattern as a macrocell
+ * s4640878_lib_CAG_hashlife_load_macrocell() - reads a macrocell pattern
+ * s4640878_lib_CAG_hashlife_get_memory() - gets the bytes of the node cache in use
+ ***************************************************************
+ */
+
+#ifndef S4640878_CAG_HASHLIFE_H_
+#define S4640878_CAG_HASHLIFE_H_
+
+#include <stdint.h>
+#include "s4640878_CAG_universe.h"
+
+// default node cache size (about 28 bytes per node)
+#ifndef CAG_HASHLIFE_NODES
+#if UINTPTR_MAX > 0xFFFFFFFFUL
+#define CAG_HASHLIFE_NODES (1UL << 22)
+#else
+#define CAG_HASHLIFE_NODES 512
+#endif
+#endif
+
+// largest tree level (a level n node is 2^n x 2^n cells)
+#define CAG_HASHLIFE_MAX_LEVEL 60
+
+// hashlife error codes
+#define CAG_HASHLIFE_OK 0
+#define CAG_HASHLIFE_FULL -1        // node cache too small for the jump
+#define CAG_HASHLIFE_FORMAT -2      // macrocell could not be parsed
+
+// quadtree node, level 0 nodes are single cells
+typedef struct caNode {
+    uint32_t child[4];      // nw, ne, sw, se
+    uint32_t next;          // hash chain
+    uint32_t result;        // centre after 2^(level - 2) generations (0: unknown)
+    uint8_t level;
+    uint8_t mark;           // garbage collection mark
+} caNode_t;
+
+// hashlife engine
+typedef struct caHashlife {
+    caNode_t *node;         // node arena, index 0 is unused
+    uint32_t *bucket;       // hash table heads
+    uint32_t bucketMask;
+    uint32_t maxNodes;      // arena size
+    uint32_t used;          // arena entries handed out
+    uint32_t live;          // nodes in use
+    uint32_t freeList;      // freed nodes (chained through next)
+    int overflow;           // arena ran out during the current operation
+    uint32_t empty[CAG_HASHLIFE_MAX_LEVEL + 1];    // empty node of each level
+    uint32_t root;          // current pattern
+    int64_t originX;        // cell position of the top-left corner of root
+    int64_t originY;
+    uint64_t generation;    // generations advanced
+    caRule_t rule;          // rule the cached results were computed with
+} caHashlife_t;
+
+// external function declarations
+caHashlife_t *s4640878_lib_CAG_hashlife_create(uint32_t maxNodes);
+void s4640878_lib_CAG_hashlife_delete(caHashlife_t *hashlife);
+void s4640878_lib_CAG_hashlife_clear(caHashlife_t *hashlife);
+void s4640878_lib_CAG_hashlife_set_cell(caHashlife_t *hashlife, int64_t x, int64_t y, int alive);
+int s4640878_lib_CAG_hashlife_get_cell(caHashlife_t *hashlife, int64_t x, int64_t y);
+void s4640878_lib_CAG_hashlife_load_universe(caHashlife_t *hashlife, caUniverse_t *universe);
+void s4640878_lib_CAG_hashlife_store_universe(caHashlife_t *hashlife, caUniverse_t *universe);
+int s4640878_lib_CAG_hashlife_can_jump(caUniverse_t *universe, int k);
+int s4640878_lib_CAG_hashlife_jump(caHashlife_t *hashlife, int k);
+void s4640878_lib_CAG_hashlife_gc(caHashlife_t *hashlife);
+void s4640878_lib_CAG_hashlife_set_rule(caHashlife_t *hashlife, const caRule_t *rule);
+int s4640878_lib_CAG_hashlife_save_macrocell(caHashlife_t *hashlife, void (*writeChar)(char c, void *arg), void *arg);
+int s4640878_lib_CAG_hashlife_load_macrocell(caHashlife_t *hashlife, int (*readChar)(void *arg), void *arg);
+uint32_t s4640878_lib_CAG_hashlife_get_memory(caHashlife_t *hashlife);
+
+#endif
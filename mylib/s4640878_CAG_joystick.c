@@ -16,6 +16,7 @@
 
 #include "s4640878_CAG_joystick.h"
 #include "s4640878_CAG_simulator.h"
+#include "s4640878_CAG_display.h"
 #include "board.h"
 #include "processor_hal.h"
 
@@ -33,23 +34,32 @@ void s4640878TaskCAGJoystick(void) {
         // joystick x and y queue
         if (s4640878QueueJoystick != NULL) {
             if (xQueueReceive(s4640878QueueJoystick, &joystickMsg, 10)) {
-                // joystick x
-                if (joystickMsg.x < 1000) {
-                    uxBits = xEventGroupSetBits(GroupEventCAGSimulator, STOP_SIMULATION); // pause
-                } else if (joystickMsg.x > 3000) {
-                    uxBits = xEventGroupSetBits(GroupEventCAGSimulator, START_SIMULATION); // play
-                }
-                // joystick y
-                if (joystickMsg.y < 500) {
-                    uxBits = xEventGroupSetBits(GroupEventCAGSimulator, UPDATE_1000MS); // update 1000ms
-                } else if (joystickMsg.y < 1500) {
-                    uxBits = xEventGroupSetBits(GroupEventCAGSimulator, UPDATE_1500MS); // update 1500ms
-                } else if (joystickMsg.y < 2500) {
-                    uxBits = xEventGroupSetBits(GroupEventCAGSimulator, UPDATE_2000MS); // update 2000ms
-                } else if (joystickMsg.y < 3500) {
-                    uxBits = xEventGroupSetBits(GroupEventCAGSimulator, UPDATE_5000MS); // update 5000ms
+                if (s4640878_lib_CAG_simulator_get_grid()) {
+                    // grid mode: pans the display while held away from the centre
+                    int dx = (joystickMsg.x < 1000) ? -1 : ((joystickMsg.x > 3000) ? 1 : 0);
+                    int dy = (joystickMsg.y < 1000) ? -1 : ((joystickMsg.y > 3000) ? 1 : 0);
+                    if ((dx != 0) || (dy != 0)) {
+                        s4640878_lib_CAG_display_pan(dx, dy);
+                    }
                 } else {
-                    uxBits = xEventGroupSetBits(GroupEventCAGSimulator, UPDATE_10000MS); // update 10000ms
+                    // joystick x
+                    if (joystickMsg.x < 1000) {
+                        uxBits = xEventGroupSetBits(GroupEventCAGSimulator, STOP_SIMULATION); // pause
+                    } else if (joystickMsg.x > 3000) {
+                        uxBits = xEventGroupSetBits(GroupEventCAGSimulator, START_SIMULATION); // play
+                    }
+                    // joystick y
+                    if (joystickMsg.y < 500) {
+                        uxBits = xEventGroupSetBits(GroupEventCAGSimulator, UPDATE_1000MS); // update 1000ms
+                    } else if (joystickMsg.y < 1500) {
+                        uxBits = xEventGroupSetBits(GroupEventCAGSimulator, UPDATE_1500MS); // update 1500ms
+                    } else if (joystickMsg.y < 2500) {
+                        uxBits = xEventGroupSetBits(GroupEventCAGSimulator, UPDATE_2000MS); // update 2000ms
+                    } else if (joystickMsg.y < 3500) {
+                        uxBits = xEventGroupSetBits(GroupEventCAGSimulator, UPDATE_5000MS); // update 5000ms
+                    } else {
+                        uxBits = xEventGroupSetBits(GroupEventCAGSimulator, UPDATE_10000MS); // update 10000ms
+                    }
                 }
             }
         }
@@ -57,7 +67,11 @@ void s4640878TaskCAGJoystick(void) {
         if (s4640878SemaphoreJoystickZ != NULL) {
             // checks for joystick z semaphore
             if (xSemaphoreTake(s4640878SemaphoreJoystickZ, 10) == pdTRUE) {
-                uxBits = xEventGroupSetBits(GroupEventCAGSimulator, CLEAR_GRID); // clear grid
+                if (s4640878_lib_CAG_simulator_get_grid()) {
+                    s4640878_lib_CAG_display_zoom_cycle();   // grid mode: next zoom
+                } else {
+                    uxBits = xEventGroupSetBits(GroupEventCAGSimulator, CLEAR_GRID); // clear grid
+                }
             }
         }
         vTaskDelay(100);    // delay 0.1s
@@ -0,0 +1,149 @@
+/**
+ **************************************************************
+ * @file mylib/s4640878_CAG_lut.c
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief CAGLut - block lookup table tile kernels (c file)
+ *        (board: nucleo-f401)
+ * REFERENCE: csse3010_project.pdf (spec sheet)
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * s4640878_lib_CAG_lut_get_entries() - gets the table entries of a block kernel
+ * s4640878_lib_CAG_lut_build() - fills the table of a block kernel from a rule
+ * s4640878_lib_CAG_lut_next_3x3() - next live cells of a gathered tile, a 3x3 lookup per cell
+ * s4640878_lib_CAG_lut_next_4x4() - next live cells of a gathered tile, a 4x4 lookup per 2x2 block
+ ***************************************************************
+ * the life rule as a table instead of adders: the live cells around a cell
+ * (3x3, 512 entries) or around a 2x2 block (4x4, 65536 entries) are packed
+ * into an index, and the table holds the next cells. the tables are built
+ * from the birth and survival masks, so any B/S rule works. a neighbourhood
+ * is packed column by column, bit 0 of a column is its top row:
+ *   3x3: bit 3 * column + row, the cell is bit 4
+ *   4x4: bit 4 * column + row, the block is columns 1..2 and rows 1..2, and
+ *        bit 2 * column + row of the entry is its cell (column 0..1, row 0..1)
+ * only the live cells are looked up here, the ages are set by the universe
+ ***************************************************************
+ */
+
+#include "s4640878_CAG_lut.h"
+
+// word of the even bits, a 4x4 lookup starts at every second row
+#define EVEN_ROWS ((cag_word_t)0x5555555555555555ULL)
+
+// internal function declarations
+int CAG_lut_cell(int index, const caRule_t *rule);
+
+// returns the entries of the table of a block kernel (CAG_KERNEL_LUT_*), 0 for
+// the other kernels
+int s4640878_lib_CAG_lut_get_entries(int kernel) {
+    switch (kernel) {
+        case CAG_KERNEL_LUT_3X3:
+            return CAG_LUT_3X3_ENTRIES;
+        case CAG_KERNEL_LUT_4X4:
+            return CAG_LUT_4X4_ENTRIES;
+    }
+    return 0;
+}
+
+// fills the table of a block kernel (get_entries bytes) with the next cells of
+// a life family rule
+void s4640878_lib_CAG_lut_build(uint8_t *table, int kernel, const caRule_t *rule) {
+    if (kernel == CAG_KERNEL_LUT_3X3) {
+        for (int index = 0; index < CAG_LUT_3X3_ENTRIES; index++) {
+            table[index] = CAG_lut_cell(index, rule);
+        }
+    } else if (kernel == CAG_KERNEL_LUT_4X4) {
+        for (int index = 0; index < CAG_LUT_4X4_ENTRIES; index++) {
+            int block = 0;
+            for (int column = 0; column < 2; column++) {
+                for (int row = 0; row < 2; row++) {
+                    // the 3x3 around the cell: 3 rows of columns column..column + 2
+                    int cell = 0;
+                    for (int k = 0; k < 3; k++) {
+                        cell |= ((index >> (4 * (column + k) + row)) & 7) << (3 * k);
+                    }
+                    block |= CAG_lut_cell(cell, rule) << (2 * column + row);
+                }
+            }
+            table[index] = block;
+        }
+    }
+}
+
+// returns the next state (0 or 1) of the cell at the centre of a 3x3 index
+int CAG_lut_cell(int index, const caRule_t *rule) {
+    int total = __builtin_popcount(index);      // own cell included
+    if ((index >> 4) & 1) {
+        return (rule->survive >> (total - 1)) & 1;
+    }
+    return (rule->birth >> total) & 1;
+}
+
+// computes the next live cells of columns 1..validCols of a gathered tile into
+// next[0..validCols - 1], one 3x3 lookup per cell
+// without B0 a cell with no live cell around stays dead and is not looked up
+void s4640878_lib_CAG_lut_next_3x3(const uint8_t *table, caScratch_t *s, cag_word_t *next, int validCols) {
+    int skip = (table[0] == 0);
+    for (int c = 1; c <= validCols; c++) {
+        cag_word_t u[3], m[3], d[3];
+        cag_word_t any = 0;
+        for (int k = 0; k < 3; k++) {
+            u[k] = s->up[0][c - 1 + k];
+            m[k] = s->mid[0][c - 1 + k];
+            d[k] = s->down[0][c - 1 + k];
+            any |= u[k] | m[k] | d[k];
+        }
+        cag_word_t rows = skip ? any : (cag_word_t)~(cag_word_t)0;
+        cag_word_t out = 0;
+        while (rows) {
+            int y = __builtin_ctzll((unsigned long long)rows);
+            rows &= rows - 1;
+            int index = 0;
+            for (int k = 0; k < 3; k++) {
+                index |= (int)(((u[k] >> y) & 1) | (((m[k] >> y) & 1) << 1) | (((d[k] >> y) & 1) << 2)) << (3 * k);
+            }
+            out |= (cag_word_t)table[index] << y;
+        }
+        next[c - 1] = out;
+    }
+}
+
+// computes the next live cells of columns 1..validCols of a gathered tile into
+// next[0..validCols - 1], one 4x4 lookup per 2x2 block (2 columns, rows y and
+// y + 1 for every even y)
+// the 4 rows of a column around rows y and y + 1 are bits y and y + 1 of up
+// (rows y - 1 and y) and of down (rows y + 1 and y + 2)
+void s4640878_lib_CAG_lut_next_4x4(const uint8_t *table, caScratch_t *s, cag_word_t *next, int validCols) {
+    int skip = (table[0] == 0);
+    for (int c = 1; c <= validCols; c += 2) {
+        cag_word_t u[4], d[4];
+        cag_word_t any = 0;
+        for (int k = 0; k < 4; k++) {
+            // past the gathered columns only the block's second column would
+            // read it, and that column is then outside the tile
+            int column = c - 1 + k;
+            u[k] = (column <= validCols + 1) ? s->up[0][column] : 0;
+            d[k] = (column <= validCols + 1) ? s->down[0][column] : 0;
+            any |= u[k] | d[k];
+        }
+        // a block with a live cell in its 4x4 has one in bit y or y + 1 of up or down
+        cag_word_t blocks = skip ? ((any | (any >> 1)) & EVEN_ROWS) : EVEN_ROWS;
+        cag_word_t left = 0, right = 0;
+        while (blocks) {
+            int y = __builtin_ctzll((unsigned long long)blocks);
+            blocks &= blocks - 1;
+            int index = 0;
+            for (int k = 0; k < 4; k++) {
+                index |= (int)(((u[k] >> y) & 3) | (((d[k] >> y) & 3) << 2)) << (4 * k);
+            }
+            int block = table[index];
+            left |= (cag_word_t)(block & 3) << y;
+            right |= (cag_word_t)(block >> 2) << y;
+        }
+        next[c - 1] = left;
+        if (c < validCols) {
+            next[c] = right;
+        }
+    }
+}
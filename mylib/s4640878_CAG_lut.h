@@ -0,0 +1,36 @@
+/**
+ **************************************************************
+ * @file mylib/s4640878_CAG_lut.h
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief CAGLut - block lookup table tile kernels (header file)
+ *        (board: nucleo-f401)
+ * REFERENCE: csse3010_project.pdf (spec sheet)
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * s4640878_lib_CAG_lut_get_entries() - gets the table entries of a block kernel
+ * s4640878_lib_CAG_lut_build() - fills the table of a block kernel from a rule
+ * s4640878_lib_CAG_lut_next_3x3() - next live cells of a gathered tile, a 3x3 lookup per cell
+ * s4640878_lib_CAG_lut_next_4x4() - next live cells of a gathered tile, a 4x4 lookup per 2x2 block
+ ***************************************************************
+ */
+
+#ifndef S4640878_CAG_LUT_H_
+#define S4640878_CAG_LUT_H_
+
+#include <stdint.h>
+#include "s4640878_CAG_universe.h"
+
+// table entries: one per 3x3 neighbourhood (the next cell), or one per 4x4
+// neighbourhood (the next 2x2 block at its centre)
+#define CAG_LUT_3X3_ENTRIES 512
+#define CAG_LUT_4X4_ENTRIES 65536
+
+// external function declarations
+int s4640878_lib_CAG_lut_get_entries(int kernel);
+void s4640878_lib_CAG_lut_build(uint8_t *table, int kernel, const caRule_t *rule);
+void s4640878_lib_CAG_lut_next_3x3(const uint8_t *table, caScratch_t *s, cag_word_t *next, int validCols);
+void s4640878_lib_CAG_lut_next_4x4(const uint8_t *table, caScratch_t *s, cag_word_t *next, int validCols);
+
+#endif
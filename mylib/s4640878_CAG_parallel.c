@@ -0,0 +1,257 @@
+/**
+ **************************************************************
+ * @file mylib/s4640878_CAG_parallel.c
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief CAGParallel - multithreaded packed step for large universes (c file)
+ *        (board: linux host, not built on the nucleo-f401)
+ * REFERENCE: csse3010_project.pdf (spec sheet)
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * s4640878_lib_CAG_parallel_create() - starts a pool of stepping threads
+ * s4640878_lib_CAG_parallel_delete() - stops and frees a pool
+ * s4640878_lib_CAG_parallel_step() - computes the next generation on the pool
+ * s4640878_lib_CAG_parallel_get_threads() - gets the number of stepping threads
+ * s4640878_lib_CAG_parallel_get_memory() - gets the bytes allocated for a pool
+ ***************************************************************
+ * the work list of a generation (morton ordered, so a run of it is a compact
+ * block of tiles) is cut into chunks, each thread starts on an even share of
+ * them and steals from the others when it runs out
+ * tiles read their neighbours from the previous generation's buffer, which no
+ * one writes during a step, and write only their own slot: the halo between
+ * blocks needs no exchange and no lock. the counters, hash changes and
+ * changed tiles of each thread are added up in thread order once all tiles are
+ * done, so the result is the one of s4640878_lib_CAG_universe_step()
+ ***************************************************************
+ */
+
+#include "s4640878_CAG_parallel.h"
+
+#if CAG_PARALLEL
+
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+
+// chunk range word of a worker
+#define RANGE(next, end) (((uint64_t)(next) << 32) | (uint32_t)(end))
+
+// internal function declarations
+void *CAG_parallel_thread(void *argument);
+void CAG_parallel_work(caParallel_t *pool, caWorker_t *worker);
+int CAG_parallel_take(caWorker_t *worker);
+int CAG_parallel_steal(caWorker_t *worker);
+int CAG_parallel_reserve(caParallel_t *pool, int tileCount);
+
+// starts a pool of threads (0: one per online core), NULL if out of memory
+caParallel_t *s4640878_lib_CAG_parallel_create(int threads) {
+    if (threads <= 0) {
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    threads = (threads < 1) ? 1 : ((threads > CAG_PARALLEL_MAX_THREADS) ? CAG_PARALLEL_MAX_THREADS : threads);
+
+    caParallel_t *pool = calloc(1, sizeof(caParallel_t));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->workers = aligned_alloc(CAG_PARALLEL_LINE, threads * sizeof(caWorker_t));
+    if (pool->workers == NULL) {
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    // the threads block every signal: the freertos posix port switches tasks
+    // with signals, which must only reach its own task threads
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    pool->threads = 1;
+    for (int i = 0; i < threads; i++) {
+        caWorker_t *worker = &pool->workers[i];
+        worker->pool = pool;
+        worker->index = i;
+        worker->range = RANGE(0, 0);
+        if ((i > 0) && (pthread_create(&worker->thread, NULL, CAG_parallel_thread, worker) != 0)) {
+            break;
+        }
+        pool->threads = i + 1;
+    }
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    return pool;
+}
+
+// stops the threads of a pool and frees it
+void s4640878_lib_CAG_parallel_delete(caParallel_t *pool) {
+    if (pool == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 1; i < pool->threads; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->start);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->changedLists);
+    free(pool->workers);
+    free(pool);
+}
+
+// computes the next generation of a universe with the threads of a pool
+// short work lists (and pools that cannot grow their lists) step on this thread
+void s4640878_lib_CAG_parallel_step(caParallel_t *pool, caUniverse_t *universe) {
+    if ((pool->threads < 2) || (CAG_parallel_reserve(pool, universe->tileCount) != 0)) {
+        s4640878_lib_CAG_universe_step(universe);
+        return;
+    }
+    int workCount = s4640878_lib_CAG_universe_step_begin(universe);
+    if (workCount < CAG_PARALLEL_MIN_TILES) {
+        s4640878_lib_CAG_universe_stepper_init(&universe->stepper, universe->changedList);
+        s4640878_lib_CAG_universe_step_tiles(universe, &universe->stepper, 0, workCount);
+        caStepper_t *stepper = &universe->stepper;
+        s4640878_lib_CAG_universe_step_end(universe, &stepper, 1);
+        return;
+    }
+
+    // even shares of the chunks to start with
+    int chunks = pool->threads * CAG_PARALLEL_CHUNKS;
+    pool->universe = universe;
+    pool->workCount = workCount;
+    pool->chunk = (workCount + chunks - 1) / chunks;
+    pool->chunks = (workCount + pool->chunk - 1) / pool->chunk;
+    for (int i = 0; i < pool->threads; i++) {
+        caWorker_t *worker = &pool->workers[i];
+        s4640878_lib_CAG_universe_stepper_init(&worker->stepper, &pool->changedLists[(size_t)i * pool->capacity]);
+        worker->range = RANGE(pool->chunks * i / pool->threads, pool->chunks * (i + 1) / pool->threads);
+    }
+
+    // the lock publishes the work list to the threads, and their tiles back
+    pthread_mutex_lock(&pool->lock);
+    pool->sequence++;
+    pool->running = pool->threads - 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    CAG_parallel_work(pool, &pool->workers[0]);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->running > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    caStepper_t *steppers[CAG_PARALLEL_MAX_THREADS];
+    for (int i = 0; i < pool->threads; i++) {
+        steppers[i] = &pool->workers[i].stepper;
+    }
+    s4640878_lib_CAG_universe_step_end(universe, steppers, pool->threads);
+}
+
+// returns the number of stepping threads, the calling thread included
+int s4640878_lib_CAG_parallel_get_threads(caParallel_t *pool) {
+    return pool->threads;
+}
+
+// returns the bytes allocated for a pool (thread stacks excluded)
+uint32_t s4640878_lib_CAG_parallel_get_memory(caParallel_t *pool) {
+    return sizeof(caParallel_t) + pool->threads * (sizeof(caWorker_t) + pool->capacity * sizeof(uint32_t));
+}
+
+// body of the pool threads: waits for a generation, steps, reports back
+void *CAG_parallel_thread(void *argument) {
+    caWorker_t *worker = argument;
+    caParallel_t *pool = worker->pool;
+    uint32_t seen = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while ((pool->sequence == seen) && !pool->stop) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        seen = pool->sequence;
+        int stop = pool->stop;
+        pthread_mutex_unlock(&pool->lock);
+        if (stop) {
+            return NULL;
+        }
+
+        CAG_parallel_work(pool, worker);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->running == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+// steps chunks of the worker's own range, then stolen ones, until none are left
+// chunks are never added during a generation, so one empty pass ends it
+void CAG_parallel_work(caParallel_t *pool, caWorker_t *worker) {
+    int chunk;
+    while (((chunk = CAG_parallel_take(worker)) >= 0) || ((chunk = CAG_parallel_steal(worker)) >= 0)) {
+        int first = chunk * pool->chunk;
+        int count = (first + pool->chunk > pool->workCount) ? (pool->workCount - first) : pool->chunk;
+        s4640878_lib_CAG_universe_step_tiles(pool->universe, &worker->stepper, first, count);
+    }
+}
+
+// takes the first chunk of the worker's own range, -1 if it is empty
+int CAG_parallel_take(caWorker_t *worker) {
+    uint64_t range = __atomic_load_n(&worker->range, __ATOMIC_ACQUIRE);
+    for (;;) {
+        uint32_t next = range >> 32, end = (uint32_t)range;
+        if (next >= end) {
+            return -1;
+        }
+        if (__atomic_compare_exchange_n(&worker->range, &range, RANGE(next + 1, end), 0,
+                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            return next;
+        }
+    }
+}
+
+// steals the last chunk of another worker's range (the next worker first),
+// -1 if every range is empty
+int CAG_parallel_steal(caWorker_t *worker) {
+    caParallel_t *pool = worker->pool;
+    for (int i = 1; i < pool->threads; i++) {
+        caWorker_t *victim = &pool->workers[(worker->index + i) % pool->threads];
+        uint64_t range = __atomic_load_n(&victim->range, __ATOMIC_ACQUIRE);
+        for (;;) {
+            uint32_t next = range >> 32, end = (uint32_t)range;
+            if (next >= end) {
+                break;
+            }
+            if (__atomic_compare_exchange_n(&victim->range, &range, RANGE(next, end - 1), 0,
+                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                return end - 1;
+            }
+        }
+    }
+    return -1;
+}
+
+// makes room for a changed list of tileCount slots per worker, returns 0 on success
+int CAG_parallel_reserve(caParallel_t *pool, int tileCount) {
+    if (tileCount <= pool->capacity) {
+        return 0;
+    }
+    uint32_t *lists = malloc((size_t)pool->threads * tileCount * sizeof(uint32_t));
+    if (lists == NULL) {
+        return -1;
+    }
+    free(pool->changedLists);
+    pool->changedLists = lists;
+    pool->capacity = tileCount;
+    return 0;
+}
+
+#endif
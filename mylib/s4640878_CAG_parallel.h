@@ -0,0 +1,90 @@
+/**
+ **************************************************************
+ * @file mylib/s4640878_CAG_parallel.h
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief CAGParallel - multithreaded packed step for large universes (header file)
+ *        (board: linux host, not built on the nucleo-f401)
+ * REFERENCE: csse3010_project.pdf (spec sheet)
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * s4640878_lib_CAG_parallel_create() - starts a pool of stepping threads
+ * s4640878_lib_CAG_parallel_delete() - stops and frees a pool
+ * s4640878_lib_CAG_parallel_step() - computes the next generation on the pool
+ * s4640878_lib_CAG_parallel_get_threads() - gets the number of stepping threads
+ * s4640878_lib_CAG_parallel_get_memory() - gets the bytes allocated for a pool
+ ***************************************************************
+ */
+
+#ifndef S4640878_CAG_PARALLEL_H_
+#define S4640878_CAG_PARALLEL_H_
+
+#include <stdint.h>
+#include "s4640878_CAG_universe.h"
+
+// pthreads are only there on a host (-DCAG_PARALLEL=0 leaves the pool out)
+#ifndef CAG_PARALLEL
+#if UINTPTR_MAX > 0xFFFFFFFFUL
+#define CAG_PARALLEL 1
+#else
+#define CAG_PARALLEL 0
+#endif
+#endif
+
+#if CAG_PARALLEL
+
+#include <pthread.h>
+
+// most stepping threads, the calling thread included
+#define CAG_PARALLEL_MAX_THREADS 64
+
+// work lists shorter than this are stepped on the calling thread alone
+#define CAG_PARALLEL_MIN_TILES 16
+
+// chunks of the work list per thread: enough to even out the load by stealing
+#define CAG_PARALLEL_CHUNKS 8
+
+// cache line size, workers do not share lines
+#define CAG_PARALLEL_LINE 64
+
+// one stepping thread, kept on its own cache lines
+// range holds the chunks it has left as (next << 32) | end: the owner takes
+// from the front and other threads steal from the back, both with one
+// compare-and-swap, so no lock is taken while stepping
+typedef struct caWorker {
+    caStepper_t stepper;        // working area and counters of its tiles
+    uint64_t range;             // chunks left
+    pthread_t thread;
+    struct caParallel *pool;
+    int index;                  // 0 is the calling thread
+} __attribute__((aligned(CAG_PARALLEL_LINE))) caWorker_t;
+
+// pool of stepping threads, started once and reused every generation
+typedef struct caParallel {
+    int threads;                // stepping threads, the calling thread is worker 0
+    caWorker_t *workers;
+    uint32_t *changedLists;     // changed list of each worker (capacity slots each)
+    int capacity;
+    caUniverse_t *universe;     // universe of the generation being stepped
+    int workCount;              // tiles in its work list
+    int chunk;                  // tiles per chunk
+    int chunks;
+    pthread_mutex_t lock;       // guards sequence, running and stop
+    pthread_cond_t start;       // a generation is ready
+    pthread_cond_t done;        // the last worker finished
+    uint32_t sequence;          // generations started
+    int running;                // workers still stepping
+    int stop;                   // workers exit
+} caParallel_t;
+
+// external function declarations
+caParallel_t *s4640878_lib_CAG_parallel_create(int threads);
+void s4640878_lib_CAG_parallel_delete(caParallel_t *pool);
+void s4640878_lib_CAG_parallel_step(caParallel_t *pool, caUniverse_t *universe);
+int s4640878_lib_CAG_parallel_get_threads(caParallel_t *pool);
+uint32_t s4640878_lib_CAG_parallel_get_memory(caParallel_t *pool);
+
+#endif
+
+#endif
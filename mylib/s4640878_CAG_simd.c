@@ -0,0 +1,75 @@
+/**
+ **************************************************************
+ * @file mylib/s4640878_CAG_simd.c
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief CAGSimd - sse2/avx2 packed tile kernels (c file)
+ *        (board: x86-64 linux host, not built on the nucleo-f401)
+ * REFERENCE: csse3010_project.pdf (spec sheet)
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * s4640878_lib_CAG_simd_supported() - checks the cpu can run a kernel
+ * s4640878_lib_CAG_simd_kernel_sse2() - steps a gathered tile, 2 columns per sse2 op
+ * s4640878_lib_CAG_simd_kernel_avx2() - steps a gathered tile, 4 columns per avx2 op
+ ***************************************************************
+ * the life kernel of s4640878_CAG_universe.c with the column loop vectorised:
+ * a vector holds neighbouring tile columns (2 x 64 cells for sse2, 4 x 64 for
+ * avx2), the left and right neighbour columns are the same vector loaded one
+ * column to each side, and the full adders and the age planes run on whole
+ * vectors. the body (s4640878_CAG_simd_kernel.h) is written once with gcc
+ * vectors and compiled for each instruction set, so both give the cells of
+ * the scalar kernel
+ ***************************************************************
+ */
+
+#include "s4640878_CAG_simd.h"
+
+#if CAG_SIMD
+
+// tile geometry
+#define TILE CAG_TILE_BITS
+
+// vectors of 2 and 4 columns, and the same at any word boundary (unaligned
+// loads and stores of the scratch columns)
+typedef uint64_t caVector2_t __attribute__((vector_size(2 * sizeof(uint64_t))));
+typedef uint64_t caVector4_t __attribute__((vector_size(4 * sizeof(uint64_t))));
+typedef uint64_t caColumns2_t __attribute__((vector_size(2 * sizeof(uint64_t)), aligned(sizeof(uint64_t)), may_alias));
+typedef uint64_t caColumns4_t __attribute__((vector_size(4 * sizeof(uint64_t)), aligned(sizeof(uint64_t)), may_alias));
+
+// returns 1 if the cpu can run a kernel (CAG_KERNEL_*)
+int s4640878_lib_CAG_simd_supported(int kernel) {
+    switch (kernel) {
+        case CAG_KERNEL_SCALAR:
+        case CAG_KERNEL_SSE2:
+            return 1;       // part of x86-64
+        case CAG_KERNEL_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+    }
+    return 0;
+}
+
+// steps a gathered life tile with sse2, 2 columns per vector (see CAG_universe_kernel)
+#define CAG_SIMD_NAME s4640878_lib_CAG_simd_kernel_sse2
+#define CAG_SIMD_TARGET
+#define CAG_SIMD_LANES 2
+#define CAG_SIMD_VECTOR caVector2_t
+#define CAG_SIMD_COLUMNS(column) (*(caColumns2_t *)(column))
+#include "s4640878_CAG_simd_kernel.h"
+#undef CAG_SIMD_NAME
+#undef CAG_SIMD_TARGET
+#undef CAG_SIMD_LANES
+#undef CAG_SIMD_VECTOR
+#undef CAG_SIMD_COLUMNS
+
+// steps a gathered life tile with avx2, 4 columns per vector (see CAG_universe_kernel),
+// only call it if s4640878_lib_CAG_simd_supported(CAG_KERNEL_AVX2)
+#define CAG_SIMD_NAME s4640878_lib_CAG_simd_kernel_avx2
+#define CAG_SIMD_TARGET __attribute__((target("avx2")))
+#define CAG_SIMD_LANES 4
+#define CAG_SIMD_VECTOR caVector4_t
+#define CAG_SIMD_COLUMNS(column) (*(caColumns4_t *)(column))
+#include "s4640878_CAG_simd_kernel.h"
+
+#endif
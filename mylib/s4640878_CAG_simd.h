@@ -0,0 +1,33 @@
+/**
+ **************************************************************
+ * @file mylib/s4640878_CAG_simd.h
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief CAGSimd - sse2/avx2 packed tile kernels (header file)
+ *        (board: x86-64 linux host, not built on the nucleo-f401)
+ * REFERENCE: csse3010_project.pdf (spec sheet)
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * s4640878_lib_CAG_simd_supported() - checks the cpu can run a kernel
+ * s4640878_lib_CAG_simd_kernel_sse2() - steps a gathered tile, 2 columns per sse2 op
+ * s4640878_lib_CAG_simd_kernel_avx2() - steps a gathered tile, 4 columns per avx2 op
+ ***************************************************************
+ */
+
+#ifndef S4640878_CAG_SIMD_H_
+#define S4640878_CAG_SIMD_H_
+
+#include <stdint.h>
+#include "s4640878_CAG_universe.h"
+
+#if CAG_SIMD
+
+// external function declarations
+int s4640878_lib_CAG_simd_supported(int kernel);
+int s4640878_lib_CAG_simd_kernel_sse2(caUniverse_t *universe, caScratch_t *s, caTile_t *dst, int validCols, cag_word_t rowMask);
+int s4640878_lib_CAG_simd_kernel_avx2(caUniverse_t *universe, caScratch_t *s, caTile_t *dst, int validCols, cag_word_t rowMask);
+
+#endif
+
+#endif
@@ -0,0 +1,123 @@
+/**
+ **************************************************************
+ * @file mylib/s4640878_CAG_simd_kernel.h
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief CAGSimd - vector tile kernel body, included once per instruction set
+ *        (board: x86-64 linux host, not built on the nucleo-f401)
+ * REFERENCE: mylib/s4640878_CAG_simd.c
+ ***************************************************************
+ * included by s4640878_CAG_simd.c with
+ *   CAG_SIMD_NAME - function name
+ *   CAG_SIMD_TARGET - target attribute of the instruction set
+ *   CAG_SIMD_LANES - columns per vector
+ *   CAG_SIMD_VECTOR - vector type of CAG_SIMD_LANES columns
+ *   CAG_SIMD_COLUMNS(column) - CAG_SIMD_LANES columns at any word boundary
+ ***************************************************************
+ */
+
+// computes the next state of the gathered tile into dst, returns 1 if a cell is alive
+// columns validCols.. of the last vector are computed from the halo and cleared after
+CAG_SIMD_TARGET
+int CAG_SIMD_NAME(caUniverse_t *universe, caScratch_t *s, caTile_t *dst, int validCols, cag_word_t rowMask) {
+    int life = (universe->rule.birth == (1 << 3)) && (universe->rule.survive == ((1 << 2) | (1 << 3)));
+    int terms = universe->rule.terms;
+    uint8_t lowIndex[10], highIndex[10], selectIndex[10];
+    for (int i = 0; i < terms; i++) {
+        lowIndex[i] = universe->rule.total[i] & 3;
+        highIndex[i] = universe->rule.total[i] >> 2;
+        selectIndex[i] = universe->rule.select[i];
+    }
+    const CAG_SIMD_VECTOR zero = {0}, allOnes = ~zero;
+    const CAG_SIMD_VECTOR mask = zero | rowMask;
+    uint64_t ones[TILE + 2], twos[TILE + 2];
+    cag_word_t occupied = 0;
+
+    // vertical sums of columns -1..TILE
+    for (int c = 0; c < TILE + 2; c++) {
+        uint64_t u = s->up[0][c], m = s->mid[0][c], d = s->down[0][c];
+        ones[c] = u ^ m ^ d;
+        twos[c] = (u & m) | (d & (u ^ m));
+    }
+
+    // columns c..c + CAG_SIMD_LANES - 1, the last load reaches column TILE + 1 at most
+    for (int c = 1; c <= validCols; c += CAG_SIMD_LANES) {
+        CAG_SIMD_VECTOR onesW = CAG_SIMD_COLUMNS(&ones[c - 1]), onesC = CAG_SIMD_COLUMNS(&ones[c]), onesE = CAG_SIMD_COLUMNS(&ones[c + 1]);
+        CAG_SIMD_VECTOR twosW = CAG_SIMD_COLUMNS(&twos[c - 1]), twosC = CAG_SIMD_COLUMNS(&twos[c]), twosE = CAG_SIMD_COLUMNS(&twos[c + 1]);
+        CAG_SIMD_VECTOR b0 = onesW ^ onesC ^ onesE;
+        CAG_SIMD_VECTOR carry = (onesW & onesC) | (onesE & (onesW ^ onesC));
+        CAG_SIMD_VECTOR t = twosW ^ twosC ^ twosE;
+        CAG_SIMD_VECTOR fours = (twosW & twosC) | (twosE & (twosW ^ twosC));
+        CAG_SIMD_VECTOR b1 = t ^ carry;
+        CAG_SIMD_VECTOR b2 = fours ^ (t & carry);
+        CAG_SIMD_VECTOR b3 = fours & t & carry;
+
+        CAG_SIMD_VECTOR alive = CAG_SIMD_COLUMNS(&s->mid[0][c]);
+        CAG_SIMD_VECTOR next;
+        if (life) {
+            next = ((b0 & b1 & ~b2) | (alive & ~b0 & ~b1 & b2)) & ~b3;
+        } else {
+            CAG_SIMD_VECTOR low[4] = {~(b0 | b1), b0 & ~b1, ~b0 & b1, b0 & b1};
+            CAG_SIMD_VECTOR high[3] = {~(b2 | b3), b2, b3};
+            CAG_SIMD_VECTOR select[4] = {zero, ~alive, alive, allOnes};
+            next = zero;
+            for (int i = 0; i < terms; i++) {
+                next |= low[lowIndex[i]] & high[highIndex[i]] & select[selectIndex[i]];
+            }
+        }
+        next &= mask;
+        CAG_SIMD_VECTOR survived = next & alive;
+        CAG_SIMD_VECTOR born = next & ~alive;
+
+        // survivors: saturating increment of the age planes
+        CAG_SIMD_VECTOR age[CAG_AGE_PLANES];
+        CAG_SIMD_VECTOR inc = allOnes;
+        for (int p = 1; p < CAG_PLANES; p++) {
+            inc &= CAG_SIMD_COLUMNS(&s->mid[p][c]);
+        }
+        inc = ~inc;
+        for (int p = 1; p < CAG_PLANES; p++) {
+            CAG_SIMD_VECTOR plane = CAG_SIMD_COLUMNS(&s->mid[p][c]);
+            age[p - 1] = (plane ^ inc) & survived;
+            inc &= plane;
+        }
+
+        // births: highest age of the 8 neighbours, bit-sliced from the top plane down
+        uint64_t anyBorn = 0;
+        for (int i = 0; i < CAG_SIMD_LANES; i++) {
+            anyBorn |= born[i];
+        }
+        if (anyBorn) {
+            CAG_SIMD_VECTOR candidate[8] = {allOnes, allOnes, allOnes, allOnes, allOnes, allOnes, allOnes, allOnes};
+            for (int p = CAG_PLANES - 1; p > 0; p--) {
+                CAG_SIMD_VECTOR neighbour[8] = {
+                    CAG_SIMD_COLUMNS(&s->up[p][c - 1]), CAG_SIMD_COLUMNS(&s->mid[p][c - 1]), CAG_SIMD_COLUMNS(&s->down[p][c - 1]),
+                    CAG_SIMD_COLUMNS(&s->up[p][c]), CAG_SIMD_COLUMNS(&s->down[p][c]),
+                    CAG_SIMD_COLUMNS(&s->up[p][c + 1]), CAG_SIMD_COLUMNS(&s->mid[p][c + 1]), CAG_SIMD_COLUMNS(&s->down[p][c + 1])
+                };
+                CAG_SIMD_VECTOR highest = zero;
+                for (int i = 0; i < 8; i++) {
+                    highest |= candidate[i] & neighbour[i];
+                }
+                for (int i = 0; i < 8; i++) {
+                    candidate[i] &= neighbour[i] | ~highest;
+                }
+                age[p - 1] |= highest & born;
+            }
+        }
+
+        CAG_SIMD_COLUMNS(&dst->plane[0][c - 1]) = next;
+        for (int p = 1; p < CAG_PLANES; p++) {
+            CAG_SIMD_COLUMNS(&dst->plane[p][c - 1]) = age[p - 1];
+        }
+    }
+    for (int c = validCols; c < TILE; c++) {
+        for (int p = 0; p < CAG_PLANES; p++) {
+            dst->plane[p][c] = 0;
+        }
+    }
+    for (int c = 0; c < validCols; c++) {
+        occupied |= dst->plane[0][c];
+    }
+    return occupied != 0;
+}
@@ -15,40 +15,103 @@
  * s4640878_lib_CAG_simulator_get_current_cell() - gets current cell position
  * s4640878_lib_CAG_simulator_get_grid() - gets current grid mode
  * s4640878_lib_CAG_simulator_toggle_grid() - toggles current grid mode
+ * s4640878_lib_CAG_simulator_get_cell() - gets the state of a cell
+ * s4640878_lib_CAG_simulator_get_width() - gets the universe width
+ * s4640878_lib_CAG_simulator_get_height() - gets the universe height
+ * s4640878_lib_CAG_simulator_get_universe() - gets the universe
+ * s4640878_lib_CAG_simulator_get_engine() - gets the simulation engine
+ * s4640878_lib_CAG_simulator_set_engine() - selects the simulation engine
+ * s4640878_lib_CAG_simulator_get_jump() - gets the result of the last jump
+ * s4640878_lib_CAG_simulator_get_batch() - gets the result of the last batch run
+ * s4640878_lib_CAG_simulator_get_busy() - checks if a batch run is in progress
+ * s4640878_lib_CAG_simulator_get_period() - gets the period of a detected cycle
+ * s4640878_lib_CAG_simulator_set_autopause() - pauses when a cycle is detected
+ * s4640878_lib_CAG_simulator_get_population() - gets the number of live cells
+ * s4640878_lib_CAG_simulator_get_stats() - gets population and activity counters
+ * s4640878_lib_CAG_simulator_get_timing() - gets the generation interval and its measured jitter
  *************************************************************** 
  */
 
 #include "s4640878_CAG_simulator.h"
+#include "s4640878_CAG_display.h"
 #include "board.h"
 #include "processor_hal.h"
 
-// delay definitions
-#define DELAY_1000MS 10
-#define DELAY_1500MS 15
-#define DELAY_2000MS 20
-#define DELAY_5000MS 50
-#define DELAY_10000MS 100
+// the cortex-m core (cmsis) has a dwt cycle counter to time the generations
+#ifdef DWT
+#define CAG_SIMULATOR_CYCLES 1      // dwt cycle counter, 32 bits
+#else
+#include <time.h>
+#define CAG_SIMULATOR_CYCLES 0      // monotonic clock in ns
+#endif
 
-// buffers for 2D array of cells
-int cells[WIDTH][HEIGHT];
-int cellsBuf[WIDTH][HEIGHT];
+// longest wait between two looks at the inputs (the CLI waits 10 ticks for
+// the queue), the generations are due on their own deadlines in between
+#define POLL_MS 5
+
+// cell storage
+static caUniverse_t *universe = NULL;
+
+// hashlife engine, created on the first jump and kept so its node cache is reused
+static caHashlife_t *hashlife = NULL;
+
+// byte engine, created on its first step and kept
+static caBytes_t *bytes = NULL;
+
+// sparse engine, created on its first step and kept so its cell set carries over
+static caSparse_t *sparse = NULL;
+
+#if CAG_PARALLEL
+// thread pool of the parallel engine, started on its first step and kept
+static caParallel_t *parallel = NULL;
+#endif
 
 // internal variables
 static int gridMode;               // mode -> 1: grid or 0: mnemonic
 static int currentCell[2];         // selected cell position
 static int pause;                  // pause-game variable
-static int delay;                  // sets update time
+static uint32_t interval;          // generation interval in ms
+static uint32_t joystickInterval;  // interval of the last joystick position, 0 before the first
+static TickType_t due;             // tick the next generation is due at
+static int running;                // due is counting (not paused)
+static caTiming_t timing;          // measured times between generations
+static uint64_t timingMark;        // clock reading at the last generation
+static uint64_t timingSum;         // sum of the times between generations (us)
+static uint64_t timingDeviation;   // sum of their differences from the interval (us)
+static int engine;                 // simulation engine
+static int jumpResult;             // result of the last jump
+static caBatch_t batchResult;      // result of the last batch run
+static volatile int busy;          // batch run in progress
+static int autopause;              // pause when the universe starts repeating
+static caUniverse_t *shownUniverse; // universe of the last frame request
+static uint32_t shownGeneration;   // its generation
+static uint64_t shownHash;         // its cells hash (edits change it, not the generation)
+static int shownCell[2];           // its selected cell
+static int shownGrid = -1;         // its grid mode, -1 before the first request
 static TaskHandle_t xHandleCAGSimulator = NULL;     // CAGSimulator task handler
 
 // internal function declarations for CAGSimulator
 void s4640878TaskCAGSimulator(void);
 void CAG_simulator_init(void);
 void CAG_simulator_process(void);
+void CAG_simulator_step(void);
 void CAG_simulator_process_grid_event(void);
 void CAG_simulator_process_simulator_event(void);
 void CAG_simulator_process_queue(void);
 void CAG_simulator_clear(void);
 void CAG_simulator_move_origin(void);
+void CAG_simulator_set_cell(int x, int y, int value);
+int CAG_simulator_get_cell(int x, int y);
+void CAG_simulator_jump(int k);
+void CAG_simulator_set_rule(int birth, int survive);
+void CAG_simulator_batch(int condition, uint32_t generations, int target);
+void CAG_simulator_set_interval(uint32_t ms);
+void CAG_simulator_joystick_interval(uint32_t ms);
+void CAG_simulator_schedule(void);
+void CAG_simulator_refresh(void);
+void CAG_simulator_timing_reset(void);
+void CAG_simulator_timing_mark(void);
+uint64_t CAG_simulator_clock(void);
 
 // internal function declarations for lifeforms 
 void draw_block(int x, int y);
@@ -65,30 +128,157 @@ void s4640878TaskCAGSimulator(void) {
     // created simulator initilisation semaphore
     // used to signal CAGDisplay that simulator is ready
     s4640878SemaphoreCAGSimulatorInit = xSemaphoreCreateBinary();
+    if (s4640878SemaphoreCAGBatch == NULL) {
+        s4640878SemaphoreCAGBatch = xSemaphoreCreateBinary();
+    }
 
     CAG_simulator_init();       // initilises the simulator
-    int count = 0;              // initilises count (used for variable update time)
+    TickType_t wake = xTaskGetTickCount();      // start of the current wait
     for(;;) {
         CAG_simulator_process_grid_event();         // checks grid event bits
         CAG_simulator_process_simulator_event();    // checks joystick event bits
         CAG_simulator_process_queue();              // checks the queue
+        CAG_simulator_schedule();                   // runs a generation if one is due
+        CAG_simulator_refresh();                    // requests a frame if something shown changed
 
-        // checks if game is currently paused
-        // only run simulation and and update count if game is not paused
-        if (!pause) {
-            // compare count to delay
-            // if delay time is reached, then run simulation
-            if (count >= delay) {
-                CAG_simulator_process();    // implements game logic
-                count = 0;                  // reset count after running simulation
-            } else {
-                count++;                // increments count
-            }
+        // sleeps until the next look at the inputs, or the deadline if sooner
+        // (vTaskDelayUntil, so the time the inputs took is not added on)
+        TickType_t now = xTaskGetTickCount();
+        TickType_t sleep = POLL_MS / portTICK_PERIOD_MS;
+        if ((TickType_t)(now - wake) > sleep) {
+            wake = now;     // a long step or batch run: the missed waits are dropped
         }
-        vTaskDelay(80);          // delay
+        if (running && ((TickType_t)(due - wake) < sleep)) {
+            sleep = due - wake;
+        }
+        vTaskDelayUntil(&wake, (sleep > 0) ? sleep : 1);
+    }
+}
+
+// requests a display frame when the universe, its generation or cells, the
+// selected cell or the grid mode changed since the last request (covers the
+// steps, the edits from every input and the batch runs)
+void CAG_simulator_refresh(void) {
+    if ((universe == shownUniverse) && (gridMode == shownGrid) && (currentCell[X] == shownCell[X])
+            && (currentCell[Y] == shownCell[Y]) && ((universe == NULL)
+            || ((universe->generation == shownGeneration) && (universe->hash == shownHash)))) {
+        return;
+    }
+    shownUniverse = universe;
+    shownGrid = gridMode;
+    shownCell[X] = currentCell[X];
+    shownCell[Y] = currentCell[Y];
+    if (universe != NULL) {
+        shownGeneration = universe->generation;
+        shownHash = universe->hash;
+    }
+    s4640878_lib_CAG_display_refresh();
+}
+
+// runs a generation when its deadline is reached, the deadlines are a whole
+// number of intervals apart from the first one after starting (no drift)
+// deadlines missed by a long step, a batch run or the bench are dropped and
+// counted as late, the next one is an interval later
+void CAG_simulator_schedule(void) {
+    TickType_t now = xTaskGetTickCount();
+    TickType_t ticks = interval / portTICK_PERIOD_MS;
+    ticks = (ticks > 0) ? ticks : 1;
+
+    if (pause) {
+        running = 0;
+        return;
+    }
+    if (!running) {
+        due = now + ticks;
+        running = 1;
+        CAG_simulator_timing_reset();
+        return;
+    }
+    if ((TickType_t)(now - due) >= portMAX_DELAY / 2) {
+        return;     // not due yet
+    }
+    CAG_simulator_timing_mark();
+    CAG_simulator_process();    // implements game logic
+    due += ticks;
+    now = xTaskGetTickCount();
+    if ((TickType_t)(now - due) < portMAX_DELAY / 2) {
+        timing.late++;
+        due = now + ticks;
+    }
+
+    // nothing new will happen, stop stepping until restarted or edited
+    if (autopause && (s4640878_lib_CAG_simulator_get_period() > 0)) {
+        pause = 1;
+    }
+}
+
+// sets the generation interval (CAG_SIMULATOR_INTERVAL_MIN_MS ..
+// CAG_SIMULATOR_INTERVAL_MAX_MS), the next generation is an interval after now
+void CAG_simulator_set_interval(uint32_t ms) {
+    if ((ms < CAG_SIMULATOR_INTERVAL_MIN_MS) || (ms > CAG_SIMULATOR_INTERVAL_MAX_MS) || (ms == interval)) {
+        return;
+    }
+    interval = ms;
+    running = 0;
+}
+
+// sets the interval of a joystick position, the joystick sends its position
+// every 0.1s so only a move sets it (and an interval set by the CLI is kept)
+void CAG_simulator_joystick_interval(uint32_t ms) {
+    if (ms != joystickInterval) {
+        joystickInterval = ms;
+        CAG_simulator_set_interval(ms);
     }
 }
 
+// clears the measured times, the next generation starts the first interval
+void CAG_simulator_timing_reset(void) {
+    memset(&timing, 0, sizeof(caTiming_t));
+    timing.intervalMs = interval;
+    timingSum = 0;
+    timingDeviation = 0;
+    timingMark = CAG_simulator_clock();
+}
+
+// adds the time since the last generation to the measured times
+void CAG_simulator_timing_mark(void) {
+    uint64_t now = CAG_simulator_clock();
+#if CAG_SIMULATOR_CYCLES
+    uint32_t us = (uint32_t)((uint32_t)now - (uint32_t)timingMark) / (SystemCoreClock / 1000000);
+#else
+    uint32_t us = (uint32_t)((now - timingMark) / 1000);
+#endif
+    uint32_t target = interval * 1000;
+    uint32_t deviation = (us > target) ? us - target : target - us;
+    timingMark = now;
+
+    if ((timing.generations == 0) || (us < timing.minUs)) {
+        timing.minUs = us;
+    }
+    if (us > timing.maxUs) {
+        timing.maxUs = us;
+    }
+    if (deviation > timing.jitterUs) {
+        timing.jitterUs = deviation;
+    }
+    timing.generations++;
+    timingSum += us;
+    timingDeviation += deviation;
+    timing.meanUs = (uint32_t)(timingSum / timing.generations);
+    timing.meanJitterUs = (uint32_t)(timingDeviation / timing.generations);
+}
+
+// returns the time: core cycles (board) or ns (host)
+uint64_t CAG_simulator_clock(void) {
+#if CAG_SIMULATOR_CYCLES
+    return DWT->CYCCNT;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+#endif
+}
+
 // task init function for CAGSimulator
 void s4640878_tsk_CAG_simulator_init(void) {
     // creates the CAGSimulator task if one does not already exist
@@ -110,28 +300,39 @@ void s4640878_tsk_CAG_simulator_del(void) {
 
 // initialize CAG simulation
 void CAG_simulator_init(void) {
+    // universe survives task deletion, so re-created tasks keep the grid
+    if (universe == NULL) {
+        universe = s4640878_lib_CAG_universe_create(WIDTH, HEIGHT);
+    }
     CAG_simulator_clear();          // resets the simulator
     CAG_simulator_move_origin();    // default position: origin
     gridMode = 1;                   // default: grid mode
     pause = 1;                      // default: pause
-    delay = 2000;                   // default delay: 2s
+    interval = CAG_SIMULATOR_INTERVAL_MS;   // default interval: 2s
+    running = 0;
+    engine = CAG_SIMULATOR_ENGINE;  // default engine
 
     // signals to CAGDisplay that simulator is ready
     if (s4640878SemaphoreCAGSimulatorInit != NULL) {
         xSemaphoreGive(s4640878SemaphoreCAGSimulatorInit);  // signals to oled task that simulator init is complete
     }
+#if CAG_SIMULATOR_CYCLES
+    // starts the cycle counter used to time the generations
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
     GroupEventCAGSimulator = xEventGroupCreate();   // init simulator event group for joystick and mnemonic
     GroupEventCAGGrid = xEventGroupCreate();   // init grid event group for keyboard inputs
 }
 
 // processes grid event group bits
 void CAG_simulator_process_grid_event(void) {
-    EventBits_t uxBits = xEventGroupWaitBits(GroupEventCAGGrid, GRID_BITS, pdTRUE, pdFALSE, 1);
+    EventBits_t uxBits = xEventGroupWaitBits(GroupEventCAGGrid, GRID_BITS, pdTRUE, pdFALSE, 0);
     if ((uxBits & MOVE_UP) != 0 && currentCell[Y] > 0) {
         currentCell[Y]--;       // move up
         uxBits = xEventGroupClearBits(GroupEventCAGGrid, MOVE_UP);
     }
-    if ((uxBits & MOVE_DOWN) != 0 && currentCell[Y] < HEIGHT - 1) {
+    if ((uxBits & MOVE_DOWN) != 0 && currentCell[Y] < s4640878_lib_CAG_simulator_get_height() - 1) {
         currentCell[Y]++;       // move down
         uxBits = xEventGroupClearBits(GroupEventCAGGrid, MOVE_DOWN);
     }
@@ -139,16 +340,16 @@ void CAG_simulator_process_grid_event(void) {
         currentCell[X]--;       // move left
         uxBits = xEventGroupClearBits(GroupEventCAGGrid, MOVE_LEFT);
     }
-    if ((uxBits & MOVE_RIGHT) != 0 && currentCell[X] < WIDTH - 1) {
+    if ((uxBits & MOVE_RIGHT) != 0 && currentCell[X] < s4640878_lib_CAG_simulator_get_width() - 1) {
         currentCell[X]++;       // move right
         uxBits = xEventGroupClearBits(GroupEventCAGGrid, MOVE_RIGHT);
     }
     if ((uxBits & SELECT_CELL) != 0) {
-        cells[currentCell[X]][currentCell[Y]] = ALIVE;      // selects cell
+        CAG_simulator_set_cell(currentCell[X], currentCell[Y], ALIVE);  // selects cell
         uxBits = xEventGroupClearBits(GroupEventCAGGrid, SELECT_CELL);
     }
     if ((uxBits & UNSELECT_CELL) != 0) {
-        cells[currentCell[X]][currentCell[Y]] = DEAD;       // unselects cell
+        CAG_simulator_set_cell(currentCell[X], currentCell[Y], DEAD);   // unselects cell
         uxBits = xEventGroupClearBits(GroupEventCAGGrid, UNSELECT_CELL);
     }
     if ((uxBits & START_GAME) != 0) {
@@ -171,7 +372,7 @@ void CAG_simulator_process_grid_event(void) {
 
 // processes simulator event group bits
 void CAG_simulator_process_simulator_event(void) {
-    EventBits_t uxBits = xEventGroupWaitBits(GroupEventCAGSimulator, SIMULATOR_BITS, pdTRUE, pdFALSE, 1);
+    EventBits_t uxBits = xEventGroupWaitBits(GroupEventCAGSimulator, SIMULATOR_BITS, pdTRUE, pdFALSE, 0);
     if ((uxBits & CLEAR_GRID) != 0) {
         CAG_simulator_clear();          // clears the display
         uxBits = xEventGroupClearBits(GroupEventCAGSimulator, CLEAR_GRID);
@@ -185,23 +386,23 @@ void CAG_simulator_process_simulator_event(void) {
         uxBits = xEventGroupClearBits(GroupEventCAGSimulator, STOP_SIMULATION);
     }
     if ((uxBits & UPDATE_1000MS) != 0) {
-        delay = DELAY_1000MS;
+        CAG_simulator_joystick_interval(1000);
         uxBits = xEventGroupClearBits(GroupEventCAGSimulator, UPDATE_1000MS);
     }
     if ((uxBits & UPDATE_1500MS) != 0) {
-        delay = DELAY_1500MS;
+        CAG_simulator_joystick_interval(1500);
         uxBits = xEventGroupClearBits(GroupEventCAGSimulator, UPDATE_1500MS);
     }
     if ((uxBits & UPDATE_2000MS) != 0) {
-        delay = DELAY_2000MS;
+        CAG_simulator_joystick_interval(2000);
         uxBits = xEventGroupClearBits(GroupEventCAGSimulator, UPDATE_2000MS);
     }
     if ((uxBits & UPDATE_5000MS) != 0) {
-        delay = DELAY_5000MS;
+        CAG_simulator_joystick_interval(5000);
         uxBits = xEventGroupClearBits(GroupEventCAGSimulator, UPDATE_5000MS);
     }
     if ((uxBits & UPDATE_10000MS) != 0) {
-        delay = DELAY_10000MS;
+        CAG_simulator_joystick_interval(10000);
         uxBits = xEventGroupClearBits(GroupEventCAGSimulator, UPDATE_10000MS);
     }
 }
@@ -211,12 +412,12 @@ void CAG_simulator_process_queue(void) {
     caMessage_t caMsg;
     if (s4640878QueueCAGMnemonic != NULL) {
         // checks the queue
-        if (xQueueReceive(s4640878QueueCAGMnemonic, &caMsg, 10)) {
+        if (xQueueReceive(s4640878QueueCAGMnemonic, &caMsg, 0)) {
             // checks the first 4 bits
             // types: cell, still, oscillator or space ship
             switch ((caMsg.type & 0xF0) >> 4) {
                 case CELL:
-                    cells[caMsg.cell_x][caMsg.cell_y] = caMsg.type & 0xF;
+                    CAG_simulator_set_cell(caMsg.cell_x, caMsg.cell_y, caMsg.type & 0xF);
                     break;
                 case STILL:
                     // checks the last 4 bits for still lifeforms
@@ -257,6 +458,35 @@ void CAG_simulator_process_queue(void) {
                             break;
                     }
                     break;
+                case JUMP:
+                    CAG_simulator_jump(caMsg.cell_x);
+                    break;
+                case RULE:
+                    CAG_simulator_set_rule(caMsg.cell_x, caMsg.cell_y);
+                    break;
+                case BATCH:
+                    CAG_simulator_batch(caMsg.type & 0xF, caMsg.cell_x, caMsg.cell_y);
+                    break;
+                case BOUNDARY:
+                    if (universe != NULL) {
+                        s4640878_lib_CAG_universe_set_boundary(universe, caMsg.cell_x);
+                    }
+                    break;
+                case ENGINE:
+                    s4640878_lib_CAG_simulator_set_engine(caMsg.cell_x);
+                    break;
+                case KERNEL:
+                    // the kernel selected may be another one (the cpu lacks it)
+                    if (universe != NULL) {
+                        s4640878_lib_CAG_universe_set_kernel(universe, caMsg.cell_x);
+                    }
+                    if (s4640878SemaphoreCAGBatch != NULL) {
+                        xSemaphoreGive(s4640878SemaphoreCAGBatch);
+                    }
+                    break;
+                case INTERVAL:
+                    CAG_simulator_set_interval(caMsg.cell_x);
+                    break;
             }
         }
     }
@@ -264,12 +494,27 @@ void CAG_simulator_process_queue(void) {
 
 // clears CAG display
 void CAG_simulator_clear(void) {
-    for (int x = 0; x < WIDTH; x++) {
-        for (int y = 0; y < HEIGHT; y++) {
-            cells[x][y] = DEAD;
-            cellsBuf[x][y] = DEAD;
-        }
+    if (universe != NULL) {
+        s4640878_lib_CAG_universe_clear(universe);
+    }
+}
+
+// sets the state value of a cell, positions outside the grid are ignored
+// (with the sparse engine the placement also goes into its cell set)
+void CAG_simulator_set_cell(int x, int y, int value) {
+    if ((universe != NULL) && (engine == CAG_ENGINE_SPARSE) && (sparse != NULL)) {
+        s4640878_lib_CAG_sparse_set_cell(sparse, universe, x, y, value);
+    } else if (universe != NULL) {
+        s4640878_lib_CAG_universe_set_cell(universe, x, y, value);
+    }
+}
+
+// returns the state value of a cell, DEAD if the cell is dead
+int CAG_simulator_get_cell(int x, int y) {
+    if (universe == NULL) {
+        return DEAD;
     }
+    return s4640878_lib_CAG_universe_get_cell(universe, x, y);
 }
 
 // moves to origin
@@ -307,150 +552,331 @@ void s4640878_lib_CAG_simulator_toggle_grid(void) {
     gridMode = 1 - gridMode;
 }
 
-/* code adapted from: 
- * processing.org/examples/gameoflife.html
- * A Processing Implementation of Game of Life by Joan Soler-Adillon
- */
-// processes simulation
+// returns the state of cell (x, y), DEAD if out of range
+int s4640878_lib_CAG_simulator_get_cell(int x, int y) {
+    return CAG_simulator_get_cell(x, y);
+}
+
+// returns the universe width in cells
+int s4640878_lib_CAG_simulator_get_width(void) {
+    return (universe != NULL) ? universe->width : 0;
+}
+
+// returns the universe height in cells
+int s4640878_lib_CAG_simulator_get_height(void) {
+    return (universe != NULL) ? universe->height : 0;
+}
+
+// returns the universe (NULL if not created)
+caUniverse_t *s4640878_lib_CAG_simulator_get_universe(void) {
+    return universe;
+}
+
+// returns the selected engine
+int s4640878_lib_CAG_simulator_get_engine(void) {
+    return engine;
+}
+
+// selects the engine: CAG_ENGINE_INT, CAG_ENGINE_PACKED, CAG_ENGINE_BYTES,
+// CAG_ENGINE_SPARSE or (hosts) CAG_ENGINE_PARALLEL
+void s4640878_lib_CAG_simulator_set_engine(int newEngine) {
+    if ((newEngine == CAG_ENGINE_INT) || (newEngine == CAG_ENGINE_PACKED) || (newEngine == CAG_ENGINE_BYTES)
+            || (newEngine == CAG_ENGINE_SPARSE) || (CAG_PARALLEL && (newEngine == CAG_ENGINE_PARALLEL))) {
+        engine = newEngine;
+    }
+}
+
+// processes simulation with the selected engine
 void CAG_simulator_process(void) {
-    // make a copy of the cells array
-    for (int x = 0; x < WIDTH; x++) {
-        for (int y = 0; y < HEIGHT; y++) {
-            cellsBuf[x][y] = cells[x][y];
+    if (universe == NULL) {
+        return;
+    }
+    switch (engine) {
+        case CAG_ENGINE_INT:
+            s4640878_lib_CAG_universe_step_reference(universe);
+            break;
+        case CAG_ENGINE_PACKED:
+        case CAG_ENGINE_PARALLEL:
+            CAG_simulator_step();
+            break;
+        case CAG_ENGINE_BYTES:
+            // the byte buffers hold the live cells: they are loaded again only
+            // after an edit, a rule or boundary change or a step by another engine,
+            // and each generation only the cells that changed are written back
+            if (bytes == NULL) {
+                bytes = s4640878_lib_CAG_bytes_create(universe->width, universe->height);
+            }
+            if (bytes != NULL) {
+                s4640878_lib_CAG_bytes_sync_universe(bytes, universe);
+                s4640878_lib_CAG_bytes_step(bytes);
+                s4640878_lib_CAG_bytes_store_universe(bytes, universe);
+            }
+            break;
+        case CAG_ENGINE_SPARSE:
+            // the cell set is kept between generations (placements go into it),
+            // it is read again only after another change to the universe; if the
+            // sets cannot grow the generation is computed by the packed engine instead
+            if (sparse == NULL) {
+                sparse = s4640878_lib_CAG_sparse_create();
+            }
+            if ((sparse == NULL) || (s4640878_lib_CAG_sparse_step(sparse, universe) != CAG_SPARSE_OK)) {
+                CAG_simulator_step();
+            }
+            break;
+    }
+}
+
+// computes one generation with the packed engine, on the thread pool when the
+// parallel engine is selected (the same cells either way)
+void CAG_simulator_step(void) {
+#if CAG_PARALLEL
+    if ((engine == CAG_ENGINE_PARALLEL) && (parallel == NULL)) {
+        parallel = s4640878_lib_CAG_parallel_create(0);
+    }
+    if ((engine == CAG_ENGINE_PARALLEL) && (parallel != NULL)) {
+        s4640878_lib_CAG_parallel_step(parallel, universe);
+        return;
+    }
+#endif
+    s4640878_lib_CAG_universe_step(universe);
+}
+
+// advances the universe 2^k generations (k 0..JUMP_MAX) with the hashlife engine,
+// and gives s4640878SemaphoreCAGBatch when done with the time in the batch result
+// hashlife does not model the universe edges: when a cell could reach them
+// (hashlife_can_jump), with joined edges or a multi-state rule, or when the node
+// cache is too small, 2^k generations are run as a batch instead
+void CAG_simulator_jump(int k) {
+    jumpResult = CAG_HASHLIFE_FULL;
+    batchResult.generations = 0;
+    batchResult.ms = 0;
+    batchResult.reason = BATCH_COUNT;
+    if ((universe != NULL) && (k >= 0) && (k <= JUMP_MAX)) {
+        if ((hashlife == NULL) && s4640878_lib_CAG_hashlife_can_jump(universe, k)) {
+            hashlife = s4640878_lib_CAG_hashlife_create(CAG_HASHLIFE_NODES);
+        }
+        if ((hashlife != NULL) && s4640878_lib_CAG_hashlife_can_jump(universe, k)) {
+            busy = 1;
+            TickType_t start = xTaskGetTickCount();
+            s4640878_lib_CAG_hashlife_set_rule(hashlife, &universe->rule);
+            s4640878_lib_CAG_hashlife_load_universe(hashlife, universe);
+            jumpResult = s4640878_lib_CAG_hashlife_jump(hashlife, k);
+            if (jumpResult == CAG_HASHLIFE_OK) {
+                // one generation of 2^k to readers and the counters
+                uint64_t before = s4640878_lib_CAG_universe_write_begin(universe);
+                s4640878_lib_CAG_hashlife_store_universe(hashlife, universe);
+                s4640878_lib_CAG_universe_write_end(universe, before, ((uint32_t)1) << k);
+                batchResult.generations = ((uint32_t)1) << k;
+            }
+            batchResult.ms = (xTaskGetTickCount() - start) * portTICK_PERIOD_MS;
+            busy = 0;
+        }
+        if (jumpResult != CAG_HASHLIFE_OK) {
+            jumpResult = CAG_HASHLIFE_OK;
+            CAG_simulator_batch(BATCH_COUNT, ((uint32_t)1) << k, 0);
+            return;
         }
     }
-    // loops through cells
-    for (int x = 0; x < WIDTH; x++) {
-        for (int y = 0; y < HEIGHT; y++) {
-            // loops through adjacent cells
-            int count = 0, value = DEAD;
-            for (int dx = x - 1; dx <= x + 1; dx++) {
-                for (int dy = y - 1; dy <= y + 1; dy++) {
-                    // check boundary conditions
-                    if ((dx >= 0) && (dx < WIDTH) && (dy >= 0) && (dy < HEIGHT)) {
-                        // skip own cell
-                        if (!((dx == x) && (dy == y))) {
-                            // increment count if adjacent cell is alive
-                            if (cellsBuf[dx][dy]) {
-                                count++;
-                                if (cellsBuf[dx][dy] > value) {
-                                    value = cellsBuf[dx][dy];   // save the higher adjacent state value
-                                }
-                            }
-                        }
-                    }
-                }
+    if (s4640878SemaphoreCAGBatch != NULL) {
+        xSemaphoreGive(s4640878SemaphoreCAGBatch);
+    }
+}
+
+// selects the rule from birth and survival neighbour count masks with the family
+// and the number of states above RULE_SHIFT, invalid rules are ignored
+void CAG_simulator_set_rule(int birth, int survive) {
+    caRule_t rule;
+    if ((universe != NULL) && (s4640878_lib_CAG_universe_compile_rule(&rule, birth >> RULE_SHIFT,
+            birth & RULE_MASK, survive & RULE_MASK, survive >> RULE_SHIFT) == 0)) {
+        s4640878_lib_CAG_universe_set_rule(universe, &rule);
+    }
+}
+
+// computes up to the given number of generations as fast as possible, stopping
+// early when the condition is met, and gives s4640878SemaphoreCAGBatch when done
+// always uses the packed engine (on the thread pool with the parallel engine),
+// the display only shows the final generation
+void CAG_simulator_batch(int condition, uint32_t generations, int target) {
+    batchResult.generations = 0;
+    batchResult.ms = 0;
+    batchResult.reason = BATCH_COUNT;
+    if (universe != NULL) {
+        busy = 1;
+        int below = (s4640878_lib_CAG_universe_get_population(universe) < target);
+        TickType_t start = xTaskGetTickCount();
+        while (batchResult.generations < generations) {
+            CAG_simulator_step();
+            batchResult.generations++;
+            int met = 0;
+            switch (condition) {
+                case BATCH_EMPTY:
+                    met = (s4640878_lib_CAG_universe_get_population(universe) == 0);
+                    break;
+                case BATCH_STABLE:
+                    met = s4640878_lib_CAG_universe_get_still(universe);
+                    break;
+                case BATCH_CYCLE:
+                    met = (s4640878_lib_CAG_universe_get_period(universe) > 0);
+                    break;
+                case BATCH_POPULATION:
+                    met = below ? (s4640878_lib_CAG_universe_get_population(universe) >= target)
+                            : (s4640878_lib_CAG_universe_get_population(universe) <= target);
+                    break;
             }
-            // check if cell is alive or dead, applies rules
-            if (cellsBuf[x][y]) {
-                if ((count < 2) || (count > 3)) {
-                    cells[x][y] = DEAD;
-                } else {
-                    cells[x][y]++;      // increment state value
-                }
-            } else {
-                if (count == 3) {
-                    cells[x][y] = value;    // assigns the highest state value to new cell
-                }
+            if (met) {
+                batchResult.reason = condition;
+                break;
             }
         }
+        batchResult.ms = (xTaskGetTickCount() - start) * portTICK_PERIOD_MS;
+        busy = 0;
     }
+    if (s4640878SemaphoreCAGBatch != NULL) {
+        xSemaphoreGive(s4640878SemaphoreCAGBatch);
+    }
+}
+
+// copies the result of the last batch run
+void s4640878_lib_CAG_simulator_get_batch(caBatch_t *result) {
+    *result = batchResult;
+}
+
+// returns 1 while a batch run is computing generations
+int s4640878_lib_CAG_simulator_get_busy(void) {
+    return busy;
+}
+
+// returns the period of the cycle found by the last step (1: still), 0 if none
+int s4640878_lib_CAG_simulator_get_period(void) {
+    return (universe != NULL) ? s4640878_lib_CAG_universe_get_period(universe) : 0;
+}
+
+// turns pausing on a detected cycle on (1) or off (0)
+void s4640878_lib_CAG_simulator_set_autopause(int on) {
+    autopause = (on != 0);
+}
+
+// returns the number of live cells
+int s4640878_lib_CAG_simulator_get_population(void) {
+    return (universe != NULL) ? s4640878_lib_CAG_universe_get_population(universe) : 0;
+}
+
+// copies the population and activity counters, all zero without a universe
+void s4640878_lib_CAG_simulator_get_stats(caStats_t *stats) {
+    if (universe == NULL) {
+        memset(stats, 0, sizeof(caStats_t));
+        return;
+    }
+    s4640878_lib_CAG_universe_get_stats(universe, stats);
+}
+
+// copies the generation interval and the times measured between generations
+// since the simulation was started or the interval set
+void s4640878_lib_CAG_simulator_get_timing(caTiming_t *result) {
+    *result = timing;
+    result->intervalMs = interval;
+}
+
+// returns the result of the last jump: CAG_HASHLIFE_OK (by hashlife or as a
+// batch), or CAG_HASHLIFE_FULL if there was no universe or k was out of range
+int s4640878_lib_CAG_simulator_get_jump(void) {
+    return jumpResult;
 }
 
 // draws block lifeform
 void draw_block(int x, int y) {
-    if ((x + 1) < WIDTH && (y + 1) < HEIGHT) {
+    if ((x + 1) < s4640878_lib_CAG_simulator_get_width() && (y + 1) < s4640878_lib_CAG_simulator_get_height()) {
         // row 0
-        cells[x + 0][y + 0] = ALIVE;
-        cells[x + 1][y + 0] = ALIVE;
+        CAG_simulator_set_cell(x + 0, y + 0, ALIVE);
+        CAG_simulator_set_cell(x + 1, y + 0, ALIVE);
         //row 1
-        cells[x + 0][y + 1] = ALIVE;
-        cells[x + 1][y + 1] = ALIVE;
+        CAG_simulator_set_cell(x + 0, y + 1, ALIVE);
+        CAG_simulator_set_cell(x + 1, y + 1, ALIVE);
     }
 }
 
 // draws beehive lifeform
 void draw_beehive(int x, int y) {
-    if ((x + 3) < WIDTH && (y + 2) < HEIGHT) {
+    if ((x + 3) < s4640878_lib_CAG_simulator_get_width() && (y + 2) < s4640878_lib_CAG_simulator_get_height()) {
         // row 0
-        cells[x + 1][y + 0] = ALIVE;
-        cells[x + 2][y + 0] = ALIVE;
+        CAG_simulator_set_cell(x + 1, y + 0, ALIVE);
+        CAG_simulator_set_cell(x + 2, y + 0, ALIVE);
         // row 1
-        cells[x + 0][y + 1] = ALIVE;
-        cells[x + 3][y + 1] = ALIVE;
+        CAG_simulator_set_cell(x + 0, y + 1, ALIVE);
+        CAG_simulator_set_cell(x + 3, y + 1, ALIVE);
         // row 2
-        cells[x + 1][y + 2] = ALIVE;
-        cells[x + 2][y + 2] = ALIVE;
+        CAG_simulator_set_cell(x + 1, y + 2, ALIVE);
+        CAG_simulator_set_cell(x + 2, y + 2, ALIVE);
     }
 }
 
 // draws loaf lifeform
 void draw_loaf(int x, int y) {
-    if ((x + 3) < WIDTH && (y + 3) < HEIGHT) {
+    if ((x + 3) < s4640878_lib_CAG_simulator_get_width() && (y + 3) < s4640878_lib_CAG_simulator_get_height()) {
         // row 0
-        cells[x + 1][y + 0] = ALIVE;
-        cells[x + 2][y + 0] = ALIVE;
+        CAG_simulator_set_cell(x + 1, y + 0, ALIVE);
+        CAG_simulator_set_cell(x + 2, y + 0, ALIVE);
         // row 1
-        cells[x + 0][y + 1] = ALIVE;
-        cells[x + 3][y + 1] = ALIVE;
+        CAG_simulator_set_cell(x + 0, y + 1, ALIVE);
+        CAG_simulator_set_cell(x + 3, y + 1, ALIVE);
         // row 2
-        cells[x + 1][y + 2] = ALIVE;
-        cells[x + 3][y + 2] = ALIVE;
+        CAG_simulator_set_cell(x + 1, y + 2, ALIVE);
+        CAG_simulator_set_cell(x + 3, y + 2, ALIVE);
         // row 3
-        cells[x + 2][y + 3] = ALIVE;
+        CAG_simulator_set_cell(x + 2, y + 3, ALIVE);
     }
 }
 
 // draws blinker lifeform
 void draw_blinker(int x, int y) {
-    if ((x + 2) < WIDTH && (y + 2) < HEIGHT) {
+    if ((x + 2) < s4640878_lib_CAG_simulator_get_width() && (y + 2) < s4640878_lib_CAG_simulator_get_height()) {
         // row 1
-        cells[x + 0][y + 1] = ALIVE;
-        cells[x + 1][y + 1] = ALIVE;
-        cells[x + 2][y + 1] = ALIVE;
+        CAG_simulator_set_cell(x + 0, y + 1, ALIVE);
+        CAG_simulator_set_cell(x + 1, y + 1, ALIVE);
+        CAG_simulator_set_cell(x + 2, y + 1, ALIVE);
     }
 }
 
 // draws toad lifeform
 void draw_toad(int x, int y) {
-    if ((x + 3) < WIDTH && (y + 3) < HEIGHT) {
+    if ((x + 3) < s4640878_lib_CAG_simulator_get_width() && (y + 3) < s4640878_lib_CAG_simulator_get_height()) {
         // row 1
-        cells[x + 1][y + 1] = ALIVE;
-        cells[x + 2][y + 1] = ALIVE;
-        cells[x + 3][y + 1] = ALIVE;
+        CAG_simulator_set_cell(x + 1, y + 1, ALIVE);
+        CAG_simulator_set_cell(x + 2, y + 1, ALIVE);
+        CAG_simulator_set_cell(x + 3, y + 1, ALIVE);
         // row 2
-        cells[x + 0][y + 2] = ALIVE;
-        cells[x + 1][y + 2] = ALIVE;
-        cells[x + 2][y + 2] = ALIVE;
+        CAG_simulator_set_cell(x + 0, y + 2, ALIVE);
+        CAG_simulator_set_cell(x + 1, y + 2, ALIVE);
+        CAG_simulator_set_cell(x + 2, y + 2, ALIVE);
     }
 }
 
 // draws beacon lifeform
 void draw_beacon(int x, int y) {
-    if ((x + 3) < WIDTH && (y + 3) < HEIGHT) {
+    if ((x + 3) < s4640878_lib_CAG_simulator_get_width() && (y + 3) < s4640878_lib_CAG_simulator_get_height()) {
         // row 0
-        cells[x + 0][y + 0] = ALIVE;
-        cells[x + 1][y + 0] = ALIVE;
+        CAG_simulator_set_cell(x + 0, y + 0, ALIVE);
+        CAG_simulator_set_cell(x + 1, y + 0, ALIVE);
         // row 1
-        cells[x + 0][y + 1] = ALIVE;
+        CAG_simulator_set_cell(x + 0, y + 1, ALIVE);
         // row 2
-        cells[x + 3][y + 2] = ALIVE;
+        CAG_simulator_set_cell(x + 3, y + 2, ALIVE);
         // row 3
-        cells[x + 2][y + 3] = ALIVE;
-        cells[x + 3][y + 3] = ALIVE;
+        CAG_simulator_set_cell(x + 2, y + 3, ALIVE);
+        CAG_simulator_set_cell(x + 3, y + 3, ALIVE);
     }
 }
 
 // draws glider lifeform
 void draw_glider(int x, int y) {
-    if ((x + 2) < WIDTH && (y + 2) < HEIGHT) {
+    if ((x + 2) < s4640878_lib_CAG_simulator_get_width() && (y + 2) < s4640878_lib_CAG_simulator_get_height()) {
         // row 0
-        cells[x + 0][y + 0] = ALIVE;
+        CAG_simulator_set_cell(x + 0, y + 0, ALIVE);
         // row 1
-        cells[x + 1][y + 1] = ALIVE;
-        cells[x + 2][y + 1] = ALIVE;
+        CAG_simulator_set_cell(x + 1, y + 1, ALIVE);
+        CAG_simulator_set_cell(x + 2, y + 1, ALIVE);
         // row 2
-        cells[x + 0][y + 2] = ALIVE;
-        cells[x + 1][y + 2] = ALIVE;
+        CAG_simulator_set_cell(x + 0, y + 2, ALIVE);
+        CAG_simulator_set_cell(x + 1, y + 2, ALIVE);
     }
 }
\ No newline at end of file
@@ -15,6 +15,20 @@
  * s4640878_lib_CAG_simulator_get_current_cell() - gets current cell position
  * s4640878_lib_CAG_simulator_get_grid() - gets current grid mode
  * s4640878_lib_CAG_simulator_toggle_grid() - toggles current grid mode
+ * s4640878_lib_CAG_simulator_get_cell() - gets the state of a cell
+ * s4640878_lib_CAG_simulator_get_width() - gets the universe width
+ * s4640878_lib_CAG_simulator_get_height() - gets the universe height
+ * s4640878_lib_CAG_simulator_get_universe() - gets the universe
+ * s4640878_lib_CAG_simulator_get_engine() - gets the simulation engine
+ * s4640878_lib_CAG_simulator_set_engine() - selects the simulation engine
+ * s4640878_lib_CAG_simulator_get_jump() - gets the result of the last jump
+ * s4640878_lib_CAG_simulator_get_batch() - gets the result of the last batch run
+ * s4640878_lib_CAG_simulator_get_busy() - checks if a batch run is in progress
+ * s4640878_lib_CAG_simulator_get_period() - gets the period of a detected cycle
+ * s4640878_lib_CAG_simulator_set_autopause() - pauses when a cycle is detected
+ * s4640878_lib_CAG_simulator_get_population() - gets the number of live cells
+ * s4640878_lib_CAG_simulator_get_stats() - gets population and activity counters
+ * s4640878_lib_CAG_simulator_get_timing() - gets the generation interval and its measured jitter
  *************************************************************** 
  */
 
@@ -27,15 +41,48 @@
 #include "event_groups.h"
 #include "semphr.h"
 #include "queue.h"
+#include "s4640878_CAG_universe.h"
+#include "s4640878_CAG_hashlife.h"
+#include "s4640878_CAG_parallel.h"
+#include "s4640878_CAG_bytes.h"
+#include "s4640878_CAG_sparse.h"
 #include <string.h>
 
 // CAGSimulator task definitions
 #define CAG_SIMULATOR_TASK_PRIORITY (tskIDLE_PRIORITY + 2)
-#define CAG_SIMULATOR_TASK_STACKSIZE (configMINIMAL_STACK_SIZE * 2)
+#define CAG_SIMULATOR_TASK_STACKSIZE (configMINIMAL_STACK_SIZE * 4)   // room for hashlife recursion
 
-// display definitions
+// universe size, the display at 2x by default (larger ones are viewed by
+// panning and zooming the display)
+#ifndef WIDTH
 #define WIDTH 64
+#endif
+#ifndef HEIGHT
 #define HEIGHT 16
+#endif
+
+// simulation engines
+// int: one int per cell, keeps the state value (reference implementation)
+// packed: tiled bit-planes, bit-parallel neighbour counting
+// parallel (hosts only): packed, with the tiles shared out over a thread pool
+// bytes: one byte per cell like int, four cells per instruction (cortex-m4 dsp)
+// sparse: hash set of the cells that are not dead, for a few patterns in a large
+// universe (faster than packed below 1 / CAG_SPARSE_CROSSOVER of the cells alive)
+#define CAG_ENGINE_INT 0
+#define CAG_ENGINE_PACKED 1
+#define CAG_ENGINE_PARALLEL 2
+#define CAG_ENGINE_BYTES 3
+#define CAG_ENGINE_SPARSE 4
+
+// generation interval in ms (default, and the range it can be set to)
+#define CAG_SIMULATOR_INTERVAL_MS 2000
+#define CAG_SIMULATOR_INTERVAL_MIN_MS 1
+#define CAG_SIMULATOR_INTERVAL_MAX_MS 10000
+
+// default engine, can be overridden at compile time (-DCAG_SIMULATOR_ENGINE=0)
+#ifndef CAG_SIMULATOR_ENGINE
+#define CAG_SIMULATOR_ENGINE CAG_ENGINE_PACKED
+#endif
 
 // CAG grid event-group bits
 #define MOVE_UP (1 << 0)
@@ -66,6 +113,23 @@
 #define STILL 2
 #define OSCILLATOR 3
 #define SPACE_SHIP 4
+#define JUMP 5          // hashlife jump of 2^cell_x generations, gives s4640878SemaphoreCAGBatch
+#define JUMP_MAX 30     // largest jump (the generation counter is 32 bits)
+#define BOUNDARY 6      // boundary mode cell_x (CAG_BOUNDARY_*)
+#define RULE 7          // rule with birth mask cell_x and survival mask cell_y
+#define RULE_SHIFT 9    // family above the birth mask, states above the survival mask
+#define RULE_MASK 0x1FF
+#define BATCH 8         // run up to cell_x generations unpaced, condition in the last 4 bits
+#define ENGINE 9        // simulation engine cell_x (CAG_ENGINE_*)
+#define KERNEL 10       // packed tile kernel cell_x (CAG_KERNEL_*), gives s4640878SemaphoreCAGBatch
+#define INTERVAL 11     // generation interval of cell_x ms
+
+// batch stop conditions (besides reaching the number of generations)
+#define BATCH_COUNT 0           // none
+#define BATCH_EMPTY 1           // no live cell left
+#define BATCH_STABLE 2          // a step changed no cell
+#define BATCH_POPULATION 3      // population reached cell_y (from either side)
+#define BATCH_CYCLE 4           // the universe repeats an earlier generation
 
 // cell definitions
 #define DEAD 0
@@ -105,11 +169,32 @@ typedef struct caMessage {
     int cell_y;     // y position
 } caMessage_t;
 
+// result of a batch run
+typedef struct caBatch {
+    uint32_t generations;   // generations computed
+    uint32_t ms;            // time taken
+    int reason;             // BATCH_* condition met, BATCH_COUNT if all generations ran
+} caBatch_t;
+
+// generation timing of the running simulation, measured from the start of one
+// generation to the start of the next
+typedef struct caTiming {
+    uint32_t intervalMs;    // generation interval asked for
+    uint32_t generations;   // generations timed
+    uint32_t minUs;         // shortest, longest and mean time between generations
+    uint32_t maxUs;
+    uint32_t meanUs;
+    uint32_t jitterUs;      // largest difference from the interval (either way)
+    uint32_t meanJitterUs;  // mean difference from the interval
+    uint32_t late;          // generations that missed their deadline by an interval or more
+} caTiming_t;
+
 // CAGMnemonic queue
 QueueHandle_t s4640878QueueCAGMnemonic;
 
 // semaphores
 SemaphoreHandle_t s4640878SemaphoreCAGSimulatorInit;
+SemaphoreHandle_t s4640878SemaphoreCAGBatch;        // given when a batch run, jump or kernel change finishes
 
 // external function declarations
 void s4640878_tsk_CAG_simulator_init(void);
@@ -118,5 +203,19 @@ int s4640878_lib_CAG_simulator_get_pause(void);
 int s4640878_lib_CAG_simulator_get_current_cell(int);
 int s4640878_lib_CAG_simulator_get_grid(void);
 void s4640878_lib_CAG_simulator_toggle_grid(void);
+int s4640878_lib_CAG_simulator_get_cell(int x, int y);
+int s4640878_lib_CAG_simulator_get_width(void);
+int s4640878_lib_CAG_simulator_get_height(void);
+caUniverse_t *s4640878_lib_CAG_simulator_get_universe(void);
+int s4640878_lib_CAG_simulator_get_engine(void);
+void s4640878_lib_CAG_simulator_set_engine(int newEngine);
+int s4640878_lib_CAG_simulator_get_jump(void);
+void s4640878_lib_CAG_simulator_get_batch(caBatch_t *result);
+int s4640878_lib_CAG_simulator_get_busy(void);
+int s4640878_lib_CAG_simulator_get_period(void);
+void s4640878_lib_CAG_simulator_set_autopause(int on);
+int s4640878_lib_CAG_simulator_get_population(void);
+void s4640878_lib_CAG_simulator_get_stats(caStats_t *stats);
+void s4640878_lib_CAG_simulator_get_timing(caTiming_t *result);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,404 @@
+/**
+ **************************************************************
+ * @file mylib/s4640878_CAG_sparse.c
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief CAGSparse - hash set engine for very sparse patterns (c file)
+ *        (board: nucleo-f401)
+ * REFERENCE: csse3010_project.pdf (spec sheet)
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * s4640878_lib_CAG_sparse_create() - creates a sparse engine
+ * s4640878_lib_CAG_sparse_delete() - deletes a sparse engine
+ * s4640878_lib_CAG_sparse_step() - computes the next generation of a universe
+ * s4640878_lib_CAG_sparse_set_cell() - sets a cell of the universe and of the cell set
+ * s4640878_lib_CAG_sparse_get_cells() - gets the number of cells that are not dead
+ * s4640878_lib_CAG_sparse_get_memory() - gets the bytes allocated for the engine
+ ***************************************************************
+ * the work of a step follows the cells instead of the area: the cells that
+ * are not dead are kept in a hash set, each counted cell adds itself to the
+ * 3x3 totals of the cells around it (a second set), and only the cells with a
+ * total (and, multi-state, the decaying cells) can change. the next generation
+ * is built as a third set, and only the cells that changed are written back
+ * with set_cell, so the universe always holds the current generation for its
+ * readers. edits made through sparse_set_cell go into the set as well; any
+ * other change of the universe (edits, clear, other engines) publishes it
+ * again, and the set is then read again from the occupied tiles
+ ***************************************************************
+ */
+
+#include "s4640878_CAG_sparse.h"
+#include <stdlib.h>
+#include <string.h>
+
+// fibonacci hashing of a key into the top bits
+#define HASH(key, bits) ((uint32_t)((key) * 0x9E3779B1u) >> (32 - (bits)))
+
+// internal function declarations
+int CAG_sparse_reserve(caSparseSet_t *set, int entries, int highest);
+int CAG_sparse_grow(caSparseSet_t *set);
+uint32_t CAG_sparse_find(caSparseSet_t *set, uint32_t key);
+int CAG_sparse_get(caSparseSet_t *set, uint32_t key);
+int CAG_sparse_put(caSparseSet_t *set, uint32_t key, int value);
+void CAG_sparse_remove(caSparseSet_t *set, uint32_t key);
+int CAG_sparse_load(caSparse_t *sparse, caUniverse_t *universe);
+int CAG_sparse_count(caSparse_t *sparse, caUniverse_t *universe);
+int CAG_sparse_add(caSparseSet_t *set, uint32_t key, int value);
+int CAG_sparse_next(caSparse_t *sparse, caUniverse_t *universe);
+
+// creates a sparse engine, its sets are allocated by the first step
+// (an engine follows one universe, its cell set is only checked against the
+// published word)
+caSparse_t *s4640878_lib_CAG_sparse_create(void) {
+    caSparse_t *sparse = calloc(1, sizeof(caSparse_t));
+    if (sparse != NULL) {
+        sparse->published = CAG_SPARSE_FREE;
+    }
+    return sparse;
+}
+
+// frees a sparse engine
+void s4640878_lib_CAG_sparse_delete(caSparse_t *sparse) {
+    if (sparse != NULL) {
+        free(sparse->cells.key);
+        free(sparse->next.key);
+        free(sparse->neighbours.key);
+        free(sparse);
+    }
+}
+
+// computes the next generation of a universe from its cells that are not dead
+// returns CAG_SPARSE_OK, or CAG_SPARSE_NOMEM (the universe is left as it was)
+int s4640878_lib_CAG_sparse_step(caSparse_t *sparse, caUniverse_t *universe) {
+    int width = universe->width;
+
+    if ((uint64_t)width * universe->height >= CAG_SPARSE_FREE) {
+        return CAG_SPARSE_NOMEM;
+    }
+    if ((sparse->published != universe->published) && (CAG_sparse_load(sparse, universe) != 0)) {
+        sparse->published = CAG_SPARSE_FREE;
+        return CAG_SPARSE_NOMEM;
+    }
+    sparse->published = universe->published;
+    if ((CAG_sparse_count(sparse, universe) != 0) || (CAG_sparse_next(sparse, universe) != 0)) {
+        return CAG_SPARSE_NOMEM;
+    }
+
+    // the cells that were born or changed, then the ones that died
+    uint64_t before = s4640878_lib_CAG_universe_write_begin(universe);
+    caSparseSet_t *cells = &sparse->cells, *next = &sparse->next;
+    for (uint32_t i = 0; i < ((uint32_t)1 << next->bits); i++) {
+        uint32_t key = next->key[i];
+        if ((key != CAG_SPARSE_FREE) && (CAG_sparse_get(cells, key) != next->value[i])) {
+            s4640878_lib_CAG_universe_set_cell(universe, key % width, key / width, next->value[i]);
+        }
+    }
+    for (uint32_t i = 0; i < ((uint32_t)1 << cells->bits); i++) {
+        uint32_t key = cells->key[i];
+        if ((key != CAG_SPARSE_FREE) && (CAG_sparse_get(next, key) == 0)) {
+            s4640878_lib_CAG_universe_set_cell(universe, key % width, key / width, 0);
+        }
+    }
+    s4640878_lib_CAG_universe_write_end(universe, before, 1);
+
+    caSparseSet_t set = *cells;
+    *cells = *next;
+    *next = set;
+    sparse->published = universe->published;
+    return CAG_SPARSE_OK;
+}
+
+// sets cell (x, y) of a universe as set_cell does, and of the cell set if it
+// matched the universe, so the next step need not read the cells again
+void s4640878_lib_CAG_sparse_set_cell(caSparse_t *sparse, caUniverse_t *universe, int x, int y, int value) {
+    int synced = (sparse->published == universe->published) && (sparse->cells.bits > 0);
+    s4640878_lib_CAG_universe_set_cell(universe, x, y, value);
+    if (!synced || (x < 0) || (x >= universe->width) || (y < 0) || (y >= universe->height)) {
+        return;
+    }
+    // the value as the universe stored it (ages and states are clamped)
+    uint32_t key = (uint32_t)y * universe->width + x;
+    value = s4640878_lib_CAG_universe_get_cell(universe, x, y);
+    if (value == 0) {
+        CAG_sparse_remove(&sparse->cells, key);
+    } else if (CAG_sparse_put(&sparse->cells, key, value) != 0) {
+        return;
+    }
+    sparse->published = universe->published;
+}
+
+// returns the number of cells that are not dead after the last step (or load)
+int s4640878_lib_CAG_sparse_get_cells(caSparse_t *sparse) {
+    return sparse->cells.used;
+}
+
+// returns the bytes allocated for the engine and its sets
+uint32_t s4640878_lib_CAG_sparse_get_memory(caSparse_t *sparse) {
+    uint32_t memory = sizeof(caSparse_t);
+    if (sparse->cells.bits > 0) {
+        memory += ((uint32_t)1 << sparse->cells.bits) * (sizeof(uint32_t) + 1);
+    }
+    if (sparse->next.bits > 0) {
+        memory += ((uint32_t)1 << sparse->next.bits) * (sizeof(uint32_t) + 1);
+    }
+    if (sparse->neighbours.bits > 0) {
+        memory += ((uint32_t)1 << sparse->neighbours.bits) * (sizeof(uint32_t) + 2);
+    }
+    return memory;
+}
+
+// empties a set with room for entries keys at half load (highest: with the
+// highest values), returns 0, or -1 if out of memory (the set is kept)
+// the set only shrinks when it is 4 times larger than needed
+int CAG_sparse_reserve(caSparseSet_t *set, int entries, int highest) {
+    int bits = CAG_SPARSE_MIN_BITS;
+    while ((1 << bits) < 2 * entries) {
+        bits++;
+    }
+    if ((bits > set->bits) || (bits + 2 < set->bits)) {
+        uint32_t slots = (uint32_t)1 << bits;
+        uint32_t *key = malloc(slots * (sizeof(uint32_t) + 1 + (highest ? 1 : 0)));
+        if (key == NULL) {
+            return -1;
+        }
+        free(set->key);
+        set->key = key;
+        set->value = (uint8_t *)(key + slots);
+        set->highest = highest ? (set->value + slots) : NULL;
+        set->bits = bits;
+    }
+    memset(set->key, 0xFF, ((size_t)1 << set->bits) * sizeof(uint32_t));
+    set->used = 0;
+    return 0;
+}
+
+// doubles a set past half load, keeping its keys, returns 0, or -1 if out of memory
+int CAG_sparse_grow(caSparseSet_t *set) {
+    caSparseSet_t old = *set;
+    uint32_t slots = (uint32_t)1 << (old.bits + 1);
+    uint32_t *key = malloc(slots * (sizeof(uint32_t) + 1 + ((old.highest != NULL) ? 1 : 0)));
+    if (key == NULL) {
+        return -1;
+    }
+    set->key = key;
+    set->value = (uint8_t *)(key + slots);
+    set->highest = (old.highest != NULL) ? (set->value + slots) : NULL;
+    set->bits = old.bits + 1;
+    memset(set->key, 0xFF, slots * sizeof(uint32_t));
+    for (uint32_t i = 0; i < ((uint32_t)1 << old.bits); i++) {
+        if (old.key[i] != CAG_SPARSE_FREE) {
+            uint32_t slot = CAG_sparse_find(set, old.key[i]);
+            set->key[slot] = old.key[i];
+            set->value[slot] = old.value[i];
+            if (set->highest != NULL) {
+                set->highest[slot] = old.highest[i];
+            }
+        }
+    }
+    free(old.key);
+    return 0;
+}
+
+// returns the slot holding a key, or the free slot it would go in
+uint32_t CAG_sparse_find(caSparseSet_t *set, uint32_t key) {
+    uint32_t mask = ((uint32_t)1 << set->bits) - 1;
+    uint32_t slot = HASH(key, set->bits);
+    while ((set->key[slot] != key) && (set->key[slot] != CAG_SPARSE_FREE)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// returns the value of a key in a set, 0 if it is not there
+int CAG_sparse_get(caSparseSet_t *set, uint32_t key) {
+    if (set->bits == 0) {
+        return 0;
+    }
+    uint32_t slot = CAG_sparse_find(set, key);
+    return (set->key[slot] == key) ? set->value[slot] : 0;
+}
+
+// puts a key with its value into a set, growing it past half load
+// returns 0, or -1 if out of memory
+int CAG_sparse_put(caSparseSet_t *set, uint32_t key, int value) {
+    uint32_t slot = CAG_sparse_find(set, key);
+    if (set->key[slot] != key) {
+        if ((2 * (set->used + 1) > (1 << set->bits)) && (CAG_sparse_grow(set) != 0)) {
+            return -1;
+        }
+        slot = CAG_sparse_find(set, key);
+        set->key[slot] = key;
+        set->used++;
+    }
+    set->value[slot] = value;
+    return 0;
+}
+
+// takes a key out of a set, the keys probed past it move back into the gap
+// so every key stays reachable from its home slot
+void CAG_sparse_remove(caSparseSet_t *set, uint32_t key) {
+    uint32_t mask = ((uint32_t)1 << set->bits) - 1;
+    uint32_t hole = CAG_sparse_find(set, key);
+    if (set->key[hole] != key) {
+        return;
+    }
+    for (uint32_t i = (hole + 1) & mask; set->key[i] != CAG_SPARSE_FREE; i = (i + 1) & mask) {
+        uint32_t home = HASH(set->key[i], set->bits);
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            set->key[hole] = set->key[i];
+            set->value[hole] = set->value[i];
+            hole = i;
+        }
+    }
+    set->key[hole] = CAG_SPARSE_FREE;
+    set->used--;
+}
+
+// reads the cells that are not dead from the occupied tiles of a universe
+// into the cell set, returns 0, or -1 if out of memory
+int CAG_sparse_load(caSparse_t *sparse, caUniverse_t *universe) {
+    int life = (universe->rule.family == CAG_FAMILY_LIFE);
+    int current = universe->current;
+
+    // a cell is not dead if it has a bit in one of these planes
+    int first = life ? 0 : 1, last = life ? 0 : universe->statePlanes;
+    int count = 0;
+    for (int slot = 0; slot < universe->tileCount; slot++) {
+        if (universe->occupied[current][slot]) {
+            caTile_t *tile = &universe->tiles[current][slot];
+            for (int c = 0; c < CAG_TILE_BITS; c++) {
+                cag_word_t word = 0;
+                for (int p = first; p <= last; p++) {
+                    word |= tile->plane[p][c];
+                }
+                count += __builtin_popcountll(word);
+            }
+        }
+    }
+    if (CAG_sparse_reserve(&sparse->cells, count, 0) != 0) {
+        return -1;
+    }
+
+    for (int slot = 0; slot < universe->tileCount; slot++) {
+        if (!universe->occupied[current][slot]) {
+            continue;
+        }
+        caTile_t *tile = &universe->tiles[current][slot];
+        int x0 = universe->slotX[slot] * CAG_TILE_BITS, y0 = universe->slotY[slot] * CAG_TILE_BITS;
+        for (int c = 0; c < CAG_TILE_BITS; c++) {
+            cag_word_t word = 0;
+            for (int p = first; p <= last; p++) {
+                word |= tile->plane[p][c];
+            }
+            while (word != 0) {
+                int y = y0 + __builtin_ctzll(word);
+                uint32_t key = (uint32_t)y * universe->width + x0 + c;
+                uint32_t index = CAG_sparse_find(&sparse->cells, key);
+                sparse->cells.key[index] = key;
+                sparse->cells.value[index] = s4640878_lib_CAG_universe_get_cell(universe, x0 + c, y);
+                sparse->cells.used++;
+                word &= word - 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// adds every counted cell (life: live, multi-state: state 1) to the 3x3 totals
+// of the cells around it, joined across the edges by the boundary mode
+// returns 0, or -1 if out of memory
+int CAG_sparse_count(caSparse_t *sparse, caUniverse_t *universe) {
+    int width = universe->width, height = universe->height;
+    int life = (universe->rule.family == CAG_FAMILY_LIFE);
+    caSparseSet_t *cells = &sparse->cells;
+
+    // most totals are shared, so about 4 per cell to start with
+    if (CAG_sparse_reserve(&sparse->neighbours, 4 * cells->used, 1) != 0) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < ((uint32_t)1 << cells->bits); i++) {
+        uint32_t key = cells->key[i];
+        int value = cells->value[i];
+        if ((key == CAG_SPARSE_FREE) || (!life && (value != 1))) {
+            continue;
+        }
+        int x = key % width, y = key / width;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                int nx = x + dx, ny = y + dy;
+                if (((nx < 0) || (nx >= width) || (ny < 0) || (ny >= height))
+                        && !s4640878_lib_CAG_universe_wrap(universe, &nx, &ny)) {
+                    continue;
+                }
+                if (CAG_sparse_add(&sparse->neighbours, (uint32_t)ny * width + nx, value) != 0) {
+                    return -1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// adds one to the total of a cell and keeps the highest value added to it
+// returns 0, or -1 if out of memory
+int CAG_sparse_add(caSparseSet_t *set, uint32_t key, int value) {
+    uint32_t slot = CAG_sparse_find(set, key);
+    if (set->key[slot] != key) {
+        if ((2 * (set->used + 1) > (1 << set->bits)) && (CAG_sparse_grow(set) != 0)) {
+            return -1;
+        }
+        slot = CAG_sparse_find(set, key);
+        set->key[slot] = key;
+        set->value[slot] = 0;
+        set->highest[slot] = 0;
+        set->used++;
+    }
+    set->value[slot]++;
+    if (value > set->highest[slot]) {
+        set->highest[slot] = value;
+    }
+    return 0;
+}
+
+// computes the next generation of the cell set into the next set from the
+// totals, returns 0, or -1 if out of memory (the cell set is kept)
+int CAG_sparse_next(caSparse_t *sparse, caUniverse_t *universe) {
+    int life = (universe->rule.family == CAG_FAMILY_LIFE);
+    caSparseSet_t *cells = &sparse->cells, *neighbours = &sparse->neighbours, *next = &sparse->next;
+
+    if (CAG_sparse_reserve(next, cells->used, 0) != 0) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < ((uint32_t)1 << neighbours->bits); i++) {
+        uint32_t key = neighbours->key[i];
+        if (key == CAG_SPARSE_FREE) {
+            continue;
+        }
+        int state = CAG_sparse_get(cells, key);
+        int total = neighbours->value[i], value;
+        if (!life) {
+            value = universe->stateTable[(state << 4) | total];
+        } else if (state > 0) {
+            // a live cell counts itself
+            value = ((universe->rule.survive >> (total - 1)) & 1) ? ((state < CAG_AGE_MAX) ? state + 1 : state) : 0;
+        } else {
+            value = ((universe->rule.birth >> total) & 1) ? neighbours->highest[i] : 0;
+        }
+        if ((value != 0) && (CAG_sparse_put(next, key, value) != 0)) {
+            return -1;
+        }
+    }
+    // multi-state cells with nothing counted around them (decaying or idle)
+    for (uint32_t i = 0; !life && (i < ((uint32_t)1 << cells->bits)); i++) {
+        uint32_t key = cells->key[i];
+        if ((key == CAG_SPARSE_FREE) || (neighbours->key[CAG_sparse_find(neighbours, key)] == key)) {
+            continue;
+        }
+        int value = universe->stateTable[cells->value[i] << 4];
+        if ((value != 0) && (CAG_sparse_put(next, key, value) != 0)) {
+            return -1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+/**
+ **************************************************************
+ * @file mylib/s4640878_CAG_sparse.h
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief CAGSparse - hash set engine for very sparse patterns (header file)
+ *        (board: nucleo-f401)
+ * REFERENCE: csse3010_project.pdf (spec sheet)
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * s4640878_lib_CAG_sparse_create() - creates a sparse engine
+ * s4640878_lib_CAG_sparse_delete() - deletes a sparse engine
+ * s4640878_lib_CAG_sparse_step() - computes the next generation of a universe
+ * s4640878_lib_CAG_sparse_set_cell() - sets a cell of the universe and of the cell set
+ * s4640878_lib_CAG_sparse_get_cells() - gets the number of cells that are not dead
+ * s4640878_lib_CAG_sparse_get_memory() - gets the bytes allocated for the engine
+ ***************************************************************
+ */
+
+#ifndef S4640878_CAG_SPARSE_H_
+#define S4640878_CAG_SPARSE_H_
+
+#include <stdint.h>
+#include "s4640878_CAG_universe.h"
+
+// sparse status
+#define CAG_SPARSE_OK 0
+#define CAG_SPARSE_NOMEM -1     // sets could not grow (or the universe has 2^32 cells or more)
+
+// free slot of a set
+#define CAG_SPARSE_FREE 0xFFFFFFFFu
+
+// smallest set (1 << bits slots)
+#define CAG_SPARSE_MIN_BITS 6
+
+// live cells below which the sparse engine steps faster than the packed one,
+// as a fraction of the universe: 1 / CAG_SPARSE_CROSSOVER (measured with
+// glider fields on 1024x1024, the set kept between steps: about 0.1% with 64
+// cell tiles, 0.5% with 16)
+#if CAG_TILE_BITS >= 64
+#define CAG_SPARSE_CROSSOVER 1000
+#else
+#define CAG_SPARSE_CROSSOVER 200
+#endif
+
+// open addressing hash set of cells, key y * width + x (linear probing)
+typedef struct caSparseSet {
+    uint32_t *key;              // CAG_SPARSE_FREE for a free slot
+    uint8_t *value;             // cells: state value, neighbours: 3x3 total
+    uint8_t *highest;           // neighbours: highest value around (life births)
+    int bits;                   // 1 << bits slots, 0 before the first step
+    int used;                   // slots holding a key
+} caSparseSet_t;
+
+// sparse engine: the cells of the universe that are not dead, kept from step to
+// step, and the cells around the counted ones with their 3x3 totals
+typedef struct caSparse {
+    caSparseSet_t cells;        // the current generation
+    caSparseSet_t next;         // the next generation while a step computes it
+    caSparseSet_t neighbours;
+    uint32_t published;         // published word of the universe when cells last matched it
+                                // (CAG_SPARSE_FREE: never), cells are read again if it moved on
+} caSparse_t;
+
+// external function declarations
+caSparse_t *s4640878_lib_CAG_sparse_create(void);
+void s4640878_lib_CAG_sparse_delete(caSparse_t *sparse);
+int s4640878_lib_CAG_sparse_step(caSparse_t *sparse, caUniverse_t *universe);
+void s4640878_lib_CAG_sparse_set_cell(caSparse_t *sparse, caUniverse_t *universe, int x, int y, int value);
+int s4640878_lib_CAG_sparse_get_cells(caSparse_t *sparse);
+uint32_t s4640878_lib_CAG_sparse_get_memory(caSparse_t *sparse);
+
+#endif
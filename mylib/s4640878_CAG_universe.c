@@ -0,0 +1,1711 @@
+/**
+ **************************************************************
+ * @file mylib/s4640878_CAG_universe.c
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief CAGUniverse - runtime sized, tiled cell storage (c file)
+ *        (board: nucleo-f401)
+ * REFERENCE: csse3010_project.pdf (spec sheet)
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * s4640878_lib_CAG_universe_create() - creates a universe
+ * s4640878_lib_CAG_universe_delete() - deletes a universe
+ * s4640878_lib_CAG_universe_clear() - kills every cell
+ * s4640878_lib_CAG_universe_get_cell() - gets the state value of a cell
+ * s4640878_lib_CAG_universe_set_cell() - sets the state value of a cell
+ * s4640878_lib_CAG_universe_step() - computes the next generation (packed)
+ * s4640878_lib_CAG_universe_step_reference() - computes the next generation (int)
+ * s4640878_lib_CAG_universe_write_begin() - starts writing a generation computed elsewhere
+ * s4640878_lib_CAG_universe_write_end() - ends it, counts the generations and looks for a cycle
+ * s4640878_lib_CAG_universe_step_begin() - starts a generation, lists the tiles to step
+ * s4640878_lib_CAG_universe_step_tiles() - steps a range of the listed tiles
+ * s4640878_lib_CAG_universe_step_end() - adds up the steppers and publishes the generation
+ * s4640878_lib_CAG_universe_stepper_init() - clears the counters of a stepper
+ * s4640878_lib_CAG_universe_get_bounds() - gets the bounding box of the live cells
+ * s4640878_lib_CAG_universe_get_changed() - gets the number of tiles that changed
+ * s4640878_lib_CAG_universe_get_population() - gets the number of live cells
+ * s4640878_lib_CAG_universe_get_still() - checks the last step moved no cell
+ * s4640878_lib_CAG_universe_get_hash() - gets the hash of the current generation
+ * s4640878_lib_CAG_universe_get_period() - gets the period of a detected cycle
+ * s4640878_lib_CAG_universe_get_stats() - gets population and activity counters
+ * s4640878_lib_CAG_universe_get_memory() - gets the bytes allocated for the universe
+ * s4640878_lib_CAG_universe_read_begin() - starts reading the published generation
+ * s4640878_lib_CAG_universe_read_cell() - gets the state value of a published cell
+ * s4640878_lib_CAG_universe_read_column() - gets 32 published cells of a column as plane words
+ * s4640878_lib_CAG_universe_read_end() - checks the published generation was intact
+ * s4640878_lib_CAG_universe_read_block() - gets the published cells that are not dead in a pyramid block
+ * s4640878_lib_CAG_universe_set_boundary() - selects the boundary mode
+ * s4640878_lib_CAG_universe_get_boundary() - gets the boundary mode
+ * s4640878_lib_CAG_universe_wrap() - maps a cell outside the universe to the cell it is joined to
+ * s4640878_lib_CAG_universe_compile_rule() - builds a rule from birth/survival counts and states
+ * s4640878_lib_CAG_universe_parse_rule() - builds a rule from a B/S[/C] rule string
+ * s4640878_lib_CAG_universe_format_rule() - writes a rule as a B/S[/C] rule string
+ * s4640878_lib_CAG_universe_set_rule() - selects the rule
+ * s4640878_lib_CAG_universe_set_kernel() - selects the packed tile kernel
+ * s4640878_lib_CAG_universe_get_kernel() - gets the packed tile kernel
+ ***************************************************************
+ */
+
+#include "s4640878_CAG_universe.h"
+#include "s4640878_CAG_simd.h"
+#include "s4640878_CAG_lut.h"
+#include <stdlib.h>
+#include <string.h>
+
+// tile geometry
+#define TILE CAG_TILE_BITS
+#define TILE_MASK (CAG_TILE_BITS - 1)
+#define WORD_ONES ((cag_word_t)~(cag_word_t)0)
+
+// neighbour slot order
+#define NB_NW 0
+#define NB_N 1
+#define NB_NE 2
+#define NB_W 3
+#define NB_E 4
+#define NB_SW 5
+#define NB_S 6
+#define NB_SE 7
+
+// empty tile bounds (x0 > x1), and tile bounds to recompute (edited since)
+#define BOUNDS_EMPTY 0xFF
+#define BOUNDS_STALE 0xFE
+
+// published word: buffer index in the low bits, a flag while the published
+// generation is edited in place, sequence above
+#define PUBLISH_SHIFT 3
+#define PUBLISH_MASK 3
+#define PUBLISH_WRITING 4
+
+// blocks a side of a pyramid level
+#define LEVEL_SIZE(tiles, level) (((tiles) + (1 << (level)) - 1) >> (level))
+
+// internal function declarations
+uint32_t CAG_universe_morton(uint32_t x, uint32_t y);
+int CAG_universe_compare_morton(const void *a, const void *b);
+int CAG_universe_slot(caUniverse_t *universe, int tx, int ty);
+int CAG_universe_valid_cols(caUniverse_t *universe, int tx);
+cag_word_t CAG_universe_row_mask(caUniverse_t *universe, int ty);
+void CAG_universe_gather(caUniverse_t *universe, caScratch_t *s, caTile_t *src, int slot);
+int CAG_universe_kernel(caUniverse_t *universe, caScratch_t *s, caTile_t *dst, int validCols, cag_word_t rowMask);
+cag_word_t CAG_universe_age_column(caScratch_t *s, caTile_t *dst, int c, cag_word_t next);
+int CAG_universe_kernel_lut(caUniverse_t *universe, caScratch_t *s, caTile_t *dst, int validCols, cag_word_t rowMask);
+void CAG_universe_step_tile(caUniverse_t *universe, caStepper_t *stepper, int slot, int src, int dst);
+void CAG_universe_mark_changed(caUniverse_t *universe, int slot);
+void CAG_universe_tile_bounds(caUniverse_t *universe, int slot, caTile_t *tile);
+int CAG_universe_tile_value(caUniverse_t *universe, caTile_t *tile, int x, int y);
+int CAG_universe_kernel_states(caUniverse_t *universe, caScratch_t *s, caTile_t *dst, int validCols, cag_word_t rowMask);
+void CAG_universe_convert(caUniverse_t *universe);
+uint64_t CAG_universe_column_hash(caUniverse_t *universe, int slot, int c, int p, cag_word_t word);
+void CAG_universe_diff_tile(caUniverse_t *universe, caStepper_t *stepper, int slot, caTile_t *before, caTile_t *after);
+int CAG_universe_count(int *births, int *deaths, int *changed, cag_word_t before, cag_word_t after, cag_word_t flipped);
+void CAG_universe_rehash(caUniverse_t *universe);
+void CAG_universe_record(caUniverse_t *universe, uint64_t before);
+int CAG_universe_is_edge(caUniverse_t *universe, int slot);
+uint8_t CAG_universe_cell_planes(caUniverse_t *universe, caTile_t *src, int x, int y);
+void CAG_universe_fill_halo(caUniverse_t *universe, caTile_t *src);
+void CAG_universe_gather_halo(caUniverse_t *universe, caScratch_t *s, int slot);
+uint32_t CAG_universe_tile_cells(caTile_t *tile);
+void CAG_universe_pyramid_add(caUniverse_t *universe, int slot, int cells);
+void CAG_universe_pyramid_up(caUniverse_t *universe, int b, int slot);
+void CAG_universe_pyramid_build(caUniverse_t *universe, int b);
+void CAG_universe_edit_begin(caUniverse_t *universe);
+void CAG_universe_edit_end(caUniverse_t *universe);
+
+// interleaves the bits of x and y (z-order curve)
+uint32_t CAG_universe_morton(uint32_t x, uint32_t y) {
+    uint32_t code = 0;
+    for (int i = 0; i < 16; i++) {
+        code |= ((x >> i) & 1) << (2 * i);
+        code |= ((y >> i) & 1) << (2 * i + 1);
+    }
+    return code;
+}
+
+// qsort comparator for (morton code, tile index) pairs
+int CAG_universe_compare_morton(const void *a, const void *b) {
+    const uint32_t *pa = a, *pb = b;
+    return (pa[0] > pb[0]) - (pa[0] < pb[0]);
+}
+
+// creates a width x height universe, returns NULL if out of memory
+caUniverse_t *s4640878_lib_CAG_universe_create(int width, int height) {
+    if ((width <= 0) || (height <= 0) || (width > (0xFFFF << CAG_TILE_SHIFT)) || (height > (0xFFFF << CAG_TILE_SHIFT))) {
+        return NULL;
+    }
+    caUniverse_t *universe = calloc(1, sizeof(caUniverse_t));
+    if (universe == NULL) {
+        return NULL;
+    }
+    universe->width = width;
+    universe->height = height;
+    universe->tilesX = (width + TILE_MASK) >> CAG_TILE_SHIFT;
+    universe->tilesY = (height + TILE_MASK) >> CAG_TILE_SHIFT;
+    universe->tileCount = universe->tilesX * universe->tilesY;
+
+    int count = universe->tileCount;
+    universe->tileSlot = malloc(count * sizeof(uint32_t));
+    universe->slotX = malloc(count * sizeof(uint16_t));
+    universe->slotY = malloc(count * sizeof(uint16_t));
+    universe->neighbourSlot = malloc(count * 8 * sizeof(int32_t));
+    universe->changed = malloc(count * sizeof(uint8_t));
+    universe->changedList = malloc(count * sizeof(uint32_t));
+    universe->previousList = malloc(count * sizeof(uint32_t));
+    universe->work = malloc(count * sizeof(uint32_t));
+    universe->visit = calloc(count, sizeof(uint32_t));
+    universe->tileBounds = malloc(count * 4 * sizeof(uint8_t));
+    universe->haloWest = calloc(CAG_PLANES * universe->tilesY, sizeof(cag_word_t));
+    universe->haloEast = calloc(CAG_PLANES * universe->tilesY, sizeof(cag_word_t));
+    universe->haloNorth = calloc(width + 2, sizeof(uint8_t));
+    universe->haloSouth = calloc(width + 2, sizeof(uint8_t));
+    universe->edgeList = malloc(count * sizeof(uint32_t));
+    uint32_t *order = malloc(count * 2 * sizeof(uint32_t));
+    int ok = (universe->tileSlot != NULL) && (universe->slotX != NULL) && (universe->slotY != NULL)
+            && (universe->neighbourSlot != NULL) && (universe->changed != NULL) && (universe->changedList != NULL)
+            && (universe->previousList != NULL)
+            && (universe->work != NULL) && (universe->visit != NULL) && (universe->tileBounds != NULL)
+            && (universe->haloWest != NULL) && (universe->haloEast != NULL) && (universe->haloNorth != NULL)
+            && (universe->haloSouth != NULL) && (universe->edgeList != NULL)
+            && (order != NULL);
+    for (int b = 0; b < CAG_BUFFERS; b++) {
+        universe->tiles[b] = calloc(count, sizeof(caTile_t));
+        universe->occupied[b] = calloc(count, sizeof(uint8_t));
+        ok = ok && (universe->tiles[b] != NULL) && (universe->occupied[b] != NULL);
+    }
+    // population pyramid per buffer: blocks of 2x2 blocks of the level below, up to one block
+    universe->pyramidLevels = 1;
+    while ((LEVEL_SIZE(universe->tilesX, universe->pyramidLevels - 1) > 1)
+            || (LEVEL_SIZE(universe->tilesY, universe->pyramidLevels - 1) > 1)) {
+        universe->pyramidLevels++;
+    }
+    for (int b = 0; b < CAG_BUFFERS; b++) {
+        for (int k = 0; k < universe->pyramidLevels; k++) {
+            universe->pyramid[b][k] = calloc(LEVEL_SIZE(universe->tilesX, k) * LEVEL_SIZE(universe->tilesY, k), sizeof(uint32_t));
+            ok = ok && (universe->pyramid[b][k] != NULL);
+        }
+    }
+    if (!ok) {
+        free(order);
+        s4640878_lib_CAG_universe_delete(universe);
+        return NULL;
+    }
+
+    // storage slots are handed out in morton order of the tile position
+    for (int i = 0; i < count; i++) {
+        order[2 * i] = CAG_universe_morton(i % universe->tilesX, i / universe->tilesX);
+        order[2 * i + 1] = i;
+    }
+    qsort(order, count, 2 * sizeof(uint32_t), CAG_universe_compare_morton);
+    for (int slot = 0; slot < count; slot++) {
+        int index = order[2 * slot + 1];
+        universe->tileSlot[index] = slot;
+        universe->slotX[slot] = index % universe->tilesX;
+        universe->slotY[slot] = index / universe->tilesX;
+    }
+    free(order);
+
+    // neighbouring tiles (NW, N, NE, W, E, SW, S, SE)
+    for (int slot = 0; slot < count; slot++) {
+        int n = 0;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                if ((dx != 0) || (dy != 0)) {
+                    universe->neighbourSlot[slot * 8 + n] =
+                            CAG_universe_slot(universe, universe->slotX[slot] + dx, universe->slotY[slot] + dy);
+                    n++;
+                }
+            }
+        }
+    }
+    for (int slot = 0; slot < count; slot++) {
+        if (CAG_universe_is_edge(universe, slot)) {
+            universe->edgeList[universe->edgeCount++] = slot;
+        }
+    }
+    universe->boundary = CAG_BOUNDARY_DEAD;
+    s4640878_lib_CAG_universe_parse_rule(&universe->rule, CAG_RULE_DEFAULT);
+    s4640878_lib_CAG_universe_set_rule(universe, &universe->rule);
+    s4640878_lib_CAG_universe_set_kernel(universe, CAG_KERNEL_AVX2);
+    s4640878_lib_CAG_universe_clear(universe);
+    universe->published = universe->current;
+    return universe;
+}
+
+// frees a universe and all of its buffers
+void s4640878_lib_CAG_universe_delete(caUniverse_t *universe) {
+    if (universe == NULL) {
+        return;
+    }
+    for (int b = 0; b < CAG_BUFFERS; b++) {
+        free(universe->tiles[b]);
+        free(universe->occupied[b]);
+    }
+    free(universe->tileSlot);
+    free(universe->slotX);
+    free(universe->slotY);
+    free(universe->neighbourSlot);
+    free(universe->changed);
+    free(universe->changedList);
+    free(universe->previousList);
+    free(universe->work);
+    free(universe->visit);
+    free(universe->tileBounds);
+    for (int b = 0; b < CAG_BUFFERS; b++) {
+        for (int k = 0; k < CAG_PYRAMID_LEVELS; k++) {
+            free(universe->pyramid[b][k]);
+        }
+    }
+    free(universe->haloWest);
+    free(universe->haloEast);
+    free(universe->haloNorth);
+    free(universe->haloSouth);
+    free(universe->edgeList);
+    free(universe->lut);
+    free(universe);
+}
+
+// kills every cell
+void s4640878_lib_CAG_universe_clear(caUniverse_t *universe) {
+    CAG_universe_edit_begin(universe);
+    for (int b = 0; b < CAG_BUFFERS; b++) {
+        memset(universe->tiles[b], 0, universe->tileCount * sizeof(caTile_t));
+        memset(universe->occupied[b], 0, universe->tileCount);
+    }
+    // both buffers are empty, so nothing has changed
+    memset(universe->changed, 0, universe->tileCount);
+    universe->changedCount = 0;
+    universe->previousCount = 0;
+    for (int slot = 0; slot < universe->tileCount; slot++) {
+        uint8_t *b = &universe->tileBounds[slot * 4];
+        b[0] = BOUNDS_EMPTY;
+        b[1] = 0;
+        b[2] = BOUNDS_EMPTY;
+        b[3] = 0;
+    }
+    for (int b = 0; b < CAG_BUFFERS; b++) {
+        for (int k = 0; k < universe->pyramidLevels; k++) {
+            memset(universe->pyramid[b][k], 0, LEVEL_SIZE(universe->tilesX, k) * LEVEL_SIZE(universe->tilesY, k) * sizeof(uint32_t));
+        }
+    }
+    memset(universe->haloWest, 0, CAG_PLANES * universe->tilesY * sizeof(cag_word_t));
+    memset(universe->haloEast, 0, CAG_PLANES * universe->tilesY * sizeof(cag_word_t));
+    memset(universe->haloNorth, 0, universe->width + 2);
+    memset(universe->haloSouth, 0, universe->width + 2);
+    universe->bounds.x0 = universe->width;
+    universe->bounds.y0 = universe->height;
+    universe->bounds.x1 = -1;
+    universe->bounds.y1 = -1;
+    universe->boundsValid = 1;
+    universe->hash = 0;
+    universe->historyCount = 0;
+    universe->period = 0;
+    universe->population = 0;
+    universe->births = 0;
+    universe->deaths = 0;
+    universe->changedCells = 0;
+    CAG_universe_edit_end(universe);
+}
+
+// adds a tile to the changed list
+void CAG_universe_mark_changed(caUniverse_t *universe, int slot) {
+    universe->boundsValid = 0;
+    if (!universe->changed[slot]) {
+        universe->changed[slot] = 1;
+        universe->changedList[universe->changedCount++] = slot;
+    }
+}
+
+// recomputes the live cell bounds of a tile
+void CAG_universe_tile_bounds(caUniverse_t *universe, int slot, caTile_t *tile) {
+    uint8_t *b = &universe->tileBounds[slot * 4];
+    cag_word_t rows = 0;
+    int x0 = BOUNDS_EMPTY, x1 = 0;
+    for (int c = 0; c < TILE; c++) {
+        // any non-zero state (dead life cells have all planes clear)
+        cag_word_t column = 0;
+        for (int p = 0; p < CAG_PLANES; p++) {
+            column |= tile->plane[p][c];
+        }
+        if (column) {
+            if (x0 == BOUNDS_EMPTY) {
+                x0 = c;
+            }
+            x1 = c;
+            rows |= column;
+        }
+    }
+    if (rows == 0) {
+        b[0] = BOUNDS_EMPTY;
+        b[1] = 0;
+        b[2] = BOUNDS_EMPTY;
+        b[3] = 0;
+        return;
+    }
+    int y0 = 0, y1 = TILE - 1;
+    while (!((rows >> y0) & 1)) {
+        y0++;
+    }
+    while (!((rows >> y1) & 1)) {
+        y1--;
+    }
+    b[0] = x0;
+    b[1] = x1;
+    b[2] = y0;
+    b[3] = y1;
+}
+
+// returns the cells of a tile that are not dead (some plane set)
+uint32_t CAG_universe_tile_cells(caTile_t *tile) {
+    uint32_t cells = 0;
+    for (int c = 0; c < TILE; c++) {
+        cag_word_t column = 0;
+        for (int p = 0; p < CAG_PLANES; p++) {
+            column |= tile->plane[p][c];
+        }
+        cells += __builtin_popcountll(column);
+    }
+    return cells;
+}
+
+// adds cells to the block holding a tile on every level of the current pyramid
+void CAG_universe_pyramid_add(caUniverse_t *universe, int slot, int cells) {
+    int tx = universe->slotX[slot], ty = universe->slotY[slot];
+    for (int k = 0; k < universe->pyramidLevels; k++) {
+        universe->pyramid[universe->current][k][(ty >> k) * LEVEL_SIZE(universe->tilesX, k) + (tx >> k)] += cells;
+    }
+}
+
+// adds up the blocks holding a tile on the levels above the tile's own in the
+// pyramid of buffer b, from the 2x2 blocks below each (the tile's level 0 entry
+// is already set)
+void CAG_universe_pyramid_up(caUniverse_t *universe, int b, int slot) {
+    int tx = universe->slotX[slot], ty = universe->slotY[slot];
+    for (int k = 1; k < universe->pyramidLevels; k++) {
+        int below = LEVEL_SIZE(universe->tilesX, k - 1), rows = LEVEL_SIZE(universe->tilesY, k - 1);
+        int bx = (tx >> k) << 1, by = (ty >> k) << 1;
+        uint32_t *level = universe->pyramid[b][k - 1];
+        uint32_t cells = level[by * below + bx];
+        if (bx + 1 < below) {
+            cells += level[by * below + bx + 1];
+        }
+        if (by + 1 < rows) {
+            cells += level[(by + 1) * below + bx];
+            if (bx + 1 < below) {
+                cells += level[(by + 1) * below + bx + 1];
+            }
+        }
+        universe->pyramid[b][k][(ty >> k) * LEVEL_SIZE(universe->tilesX, k) + (tx >> k)] = cells;
+    }
+}
+
+// recounts the whole pyramid of buffer b from its tiles
+void CAG_universe_pyramid_build(caUniverse_t *universe, int b) {
+    for (int k = 1; k < universe->pyramidLevels; k++) {
+        memset(universe->pyramid[b][k], 0, LEVEL_SIZE(universe->tilesX, k) * LEVEL_SIZE(universe->tilesY, k) * sizeof(uint32_t));
+    }
+    for (int slot = 0; slot < universe->tileCount; slot++) {
+        uint32_t cells = CAG_universe_tile_cells(&universe->tiles[b][slot]);
+        int tx = universe->slotX[slot], ty = universe->slotY[slot];
+        universe->pyramid[b][0][ty * universe->tilesX + tx] = cells;
+        for (int k = 1; k < universe->pyramidLevels; k++) {
+            universe->pyramid[b][k][(ty >> k) * LEVEL_SIZE(universe->tilesX, k) + (tx >> k)] += cells;
+        }
+    }
+}
+
+// returns the storage slot of tile (tx, ty), -1 if outside the universe
+int CAG_universe_slot(caUniverse_t *universe, int tx, int ty) {
+    if ((tx < 0) || (tx >= universe->tilesX) || (ty < 0) || (ty >= universe->tilesY)) {
+        return -1;
+    }
+    return universe->tileSlot[ty * universe->tilesX + tx];
+}
+
+// returns 1 if the tile touches the universe edge
+int CAG_universe_is_edge(caUniverse_t *universe, int slot) {
+    return (universe->slotX[slot] == 0) || (universe->slotX[slot] == universe->tilesX - 1)
+            || (universe->slotY[slot] == 0) || (universe->slotY[slot] == universe->tilesY - 1);
+}
+
+// maps a cell just outside the universe to the cell it is joined to
+// returns 0 if the cell is dead (dead boundary)
+int s4640878_lib_CAG_universe_wrap(caUniverse_t *universe, int *x, int *y) {
+    int width = universe->width, height = universe->height;
+    if (universe->boundary == CAG_BOUNDARY_DEAD) {
+        return (*x >= 0) && (*x < width) && (*y >= 0) && (*y < height);
+    }
+    if ((*x < 0) || (*x >= width)) {
+        *x = (*x + width) % width;
+        if (universe->boundary == CAG_BOUNDARY_CROSS) {
+            *y = height - 1 - *y;
+        }
+    }
+    if ((*y < 0) || (*y >= height)) {
+        *y = (*y + height) % height;
+        if (universe->boundary != CAG_BOUNDARY_TORUS) {
+            *x = width - 1 - *x;
+        }
+    }
+    return 1;
+}
+
+// number of columns of tile column tx inside the universe
+int CAG_universe_valid_cols(caUniverse_t *universe, int tx) {
+    int cols = universe->width - (tx << CAG_TILE_SHIFT);
+    return (cols > TILE) ? TILE : cols;
+}
+
+// mask of the rows of tile row ty inside the universe
+cag_word_t CAG_universe_row_mask(caUniverse_t *universe, int ty) {
+    int rows = universe->height - (ty << CAG_TILE_SHIFT);
+    return (rows >= TILE) ? WORD_ONES : (cag_word_t)((((cag_word_t)1) << rows) - 1);
+}
+
+// returns the state value of cell (x, y), 0 (dead) outside the universe
+int s4640878_lib_CAG_universe_get_cell(caUniverse_t *universe, int x, int y) {
+    if ((x < 0) || (x >= universe->width) || (y < 0) || (y >= universe->height)) {
+        return 0;
+    }
+    int slot = universe->tileSlot[(y >> CAG_TILE_SHIFT) * universe->tilesX + (x >> CAG_TILE_SHIFT)];
+    return CAG_universe_tile_value(universe, &universe->tiles[universe->current][slot], x & TILE_MASK, y & TILE_MASK);
+}
+
+// returns the state value of cell (x, y) inside a tile
+// life: 0 or 1 + age, multi-state: the state
+int CAG_universe_tile_value(caUniverse_t *universe, caTile_t *tile, int x, int y) {
+    int value = 0;
+    if (universe->rule.family != CAG_FAMILY_LIFE) {
+        for (int p = 1; p <= universe->statePlanes; p++) {
+            value |= ((tile->plane[p][x] >> y) & 1) << (p - 1);
+        }
+    } else if ((tile->plane[0][x] >> y) & 1) {
+        value = 1;
+        for (int p = 1; p < CAG_PLANES; p++) {
+            value += ((tile->plane[p][x] >> y) & 1) << (p - 1);
+        }
+    }
+    return value;
+}
+
+// sets the state value of cell (x, y), ignored outside the universe
+// life: values saturate at CAG_AGE_MAX, multi-state: at the last state
+// values <= 0 kill the cell
+void s4640878_lib_CAG_universe_set_cell(caUniverse_t *universe, int x, int y, int value) {
+    if ((x < 0) || (x >= universe->width) || (y < 0) || (y >= universe->height)) {
+        return;
+    }
+    int slot = universe->tileSlot[(y >> CAG_TILE_SHIFT) * universe->tilesX + (x >> CAG_TILE_SHIFT)];
+    caTile_t *tile = &universe->tiles[universe->current][slot];
+    cag_word_t bit = ((cag_word_t)1) << (y & TILE_MASK);
+    CAG_universe_edit_begin(universe);
+    if (value < 0) {
+        value = 0;
+    }
+    // plane 0 is the counted plane, planes 1.. hold the age or the state
+    int first = (value > 0), rest = 0;
+    if (universe->rule.family != CAG_FAMILY_LIFE) {
+        value = (value >= universe->rule.states) ? (universe->rule.states - 1) : value;
+        first = (value == 1);
+        rest = value;
+    } else if (value > 0) {
+        rest = (value > CAG_AGE_MAX) ? (CAG_AGE_MAX - 1) : (value - 1);
+    }
+    int changed = 0;
+    cag_word_t first0 = tile->plane[0][x & TILE_MASK], flipped = 0, any0 = 0, any1 = 0;
+    for (int p = 0; p < CAG_PLANES; p++) {
+        cag_word_t old = tile->plane[p][x & TILE_MASK];
+        int set = (p == 0) ? first : ((rest >> (p - 1)) & 1);
+        if (set) {
+            tile->plane[p][x & TILE_MASK] |= bit;
+        } else {
+            tile->plane[p][x & TILE_MASK] &= (cag_word_t)~bit;
+        }
+        changed |= (tile->plane[p][x & TILE_MASK] != old);
+        any0 |= old;
+        any1 |= tile->plane[p][x & TILE_MASK];
+        uint64_t hash = CAG_universe_column_hash(universe, slot, x & TILE_MASK, p, old)
+                ^ CAG_universe_column_hash(universe, slot, x & TILE_MASK, p, tile->plane[p][x & TILE_MASK]);
+        if (hash != 0) {
+            // a hashed plane changed: the state changed (not only the age)
+            universe->hash ^= hash;
+            flipped = bit;
+        }
+    }
+    universe->population += CAG_universe_count(&universe->births, &universe->deaths, &universe->changedCells,
+            first0, tile->plane[0][x & TILE_MASK], flipped);
+    if (value > 0) {
+        universe->occupied[universe->current][slot] = 1;
+    }
+    if ((any0 ^ any1) & bit) {
+        // the cell died or stopped being dead
+        CAG_universe_pyramid_add(universe, slot, (any1 & bit) ? 1 : -1);
+    }
+    if (changed) {
+        // the bounds are recomputed once by get_bounds, not once per edited cell
+        universe->period = 0;
+        CAG_universe_mark_changed(universe, slot);
+        universe->tileBounds[slot * 4] = BOUNDS_STALE;
+    }
+    CAG_universe_edit_end(universe);
+}
+
+// loads columns -1..TILE of a tile (and the rows above and below it) into scratch s
+// the tile's own columns are one straight loop per plane (missing neighbours read
+// the empty tile), which the compiler vectorises
+void CAG_universe_gather(caUniverse_t *universe, caScratch_t *s, caTile_t *src, int slot) {
+    static const caTile_t empty;
+    int32_t *nb = &universe->neighbourSlot[slot * 8];
+    const caTile_t *own = &src[slot];
+    const caTile_t *above = (nb[NB_N] < 0) ? &empty : &src[nb[NB_N]];
+    const caTile_t *below = (nb[NB_S] < 0) ? &empty : &src[nb[NB_S]];
+
+    for (int p = 0; p < CAG_PLANES; p++) {
+        for (int col = 0; col < TILE; col++) {
+            cag_word_t mid = own->plane[p][col];
+            s->mid[p][col + 1] = mid;
+            s->up[p][col + 1] = (cag_word_t)(mid << 1) | (above->plane[p][col] >> (TILE - 1));
+            s->down[p][col + 1] = (cag_word_t)(mid >> 1) | (cag_word_t)(below->plane[p][col] << (TILE - 1));
+        }
+    }
+
+    // column -1 from the west tiles, column TILE from the east tiles
+    for (int side = 0; side < 2; side++) {
+        int c = (side == 0) ? 0 : TILE + 1;
+        int col = (side == 0) ? TILE - 1 : 0;
+        int centre = nb[(side == 0) ? NB_W : NB_E];
+        int up = nb[(side == 0) ? NB_NW : NB_NE];
+        int down = nb[(side == 0) ? NB_SW : NB_SE];
+        for (int p = 0; p < CAG_PLANES; p++) {
+            cag_word_t mid = (centre < 0) ? 0 : src[centre].plane[p][col];
+            cag_word_t aboveBit = (up < 0) ? 0 : (src[up].plane[p][col] >> (TILE - 1)) & 1;
+            cag_word_t belowBit = (down < 0) ? 0 : src[down].plane[p][col] & 1;
+            s->mid[p][c] = mid;
+            s->up[p][c] = (cag_word_t)(mid << 1) | aboveBit;
+            s->down[p][c] = (cag_word_t)(mid >> 1) | (cag_word_t)(belowBit << (TILE - 1));
+        }
+    }
+    if ((universe->boundary != CAG_BOUNDARY_DEAD) && CAG_universe_is_edge(universe, slot)) {
+        CAG_universe_gather_halo(universe, s, slot);
+    }
+}
+
+// returns the planes of cell (x, y) of a buffer, bit p is plane p
+uint8_t CAG_universe_cell_planes(caUniverse_t *universe, caTile_t *src, int x, int y) {
+    int slot = universe->tileSlot[(y >> CAG_TILE_SHIFT) * universe->tilesX + (x >> CAG_TILE_SHIFT)];
+    uint8_t planes = 0;
+    for (int p = 0; p < CAG_PLANES; p++) {
+        planes |= ((src[slot].plane[p][x & TILE_MASK] >> (y & TILE_MASK)) & 1) << p;
+    }
+    return planes;
+}
+
+// fills the halo ring around the universe from the edge cells of a buffer
+// done once per generation, and only when an edge tile changed
+void CAG_universe_fill_halo(caUniverse_t *universe, caTile_t *src) {
+    int width = universe->width, height = universe->height;
+    memset(universe->haloWest, 0, CAG_PLANES * universe->tilesY * sizeof(cag_word_t));
+    memset(universe->haloEast, 0, CAG_PLANES * universe->tilesY * sizeof(cag_word_t));
+    for (int y = 0; y < height; y++) {
+        int xw = -1, yw = y, xe = width, ye = y;
+        s4640878_lib_CAG_universe_wrap(universe, &xw, &yw);
+        s4640878_lib_CAG_universe_wrap(universe, &xe, &ye);
+        uint8_t west = CAG_universe_cell_planes(universe, src, xw, yw);
+        uint8_t east = CAG_universe_cell_planes(universe, src, xe, ye);
+        for (int p = 0; p < CAG_PLANES; p++) {
+            universe->haloWest[p * universe->tilesY + (y >> CAG_TILE_SHIFT)] |= (cag_word_t)((west >> p) & 1) << (y & TILE_MASK);
+            universe->haloEast[p * universe->tilesY + (y >> CAG_TILE_SHIFT)] |= (cag_word_t)((east >> p) & 1) << (y & TILE_MASK);
+        }
+    }
+    for (int x = -1; x <= width; x++) {
+        int xn = x, yn = -1, xs = x, ys = height;
+        s4640878_lib_CAG_universe_wrap(universe, &xn, &yn);
+        s4640878_lib_CAG_universe_wrap(universe, &xs, &ys);
+        universe->haloNorth[x + 1] = CAG_universe_cell_planes(universe, src, xn, yn);
+        universe->haloSouth[x + 1] = CAG_universe_cell_planes(universe, src, xs, ys);
+    }
+}
+
+// replaces the outside columns and rows of a gathered edge tile with the halo
+void CAG_universe_gather_halo(caUniverse_t *universe, caScratch_t *s, int slot) {
+    int tx = universe->slotX[slot], ty = universe->slotY[slot];
+    int validCols = CAG_universe_valid_cols(universe, tx);
+    int rows = universe->height - (ty << CAG_TILE_SHIFT);
+    rows = (rows > TILE) ? TILE : rows;
+
+    // west and east halo columns, with the rows above and below from the next tile rows
+    for (int side = 0; side < 2; side++) {
+        int c = (side == 0) ? 0 : validCols + 1;
+        cag_word_t *halo = (side == 0) ? universe->haloWest : universe->haloEast;
+        if ((side == 0) ? (tx != 0) : (tx != universe->tilesX - 1)) {
+            continue;
+        }
+        for (int p = 0; p < CAG_PLANES; p++) {
+            cag_word_t mid = halo[p * universe->tilesY + ty];
+            cag_word_t aboveBit = (ty > 0) ? (halo[p * universe->tilesY + ty - 1] >> (TILE - 1)) & 1 : 0;
+            cag_word_t belowBit = (ty < universe->tilesY - 1) ? halo[p * universe->tilesY + ty + 1] & 1 : 0;
+            s->mid[p][c] = mid;
+            s->up[p][c] = (cag_word_t)(mid << 1) | aboveBit;
+            s->down[p][c] = (cag_word_t)(mid >> 1) | (cag_word_t)(belowBit << (TILE - 1));
+        }
+    }
+
+    // north and south halo rows, one bit per gathered column (-1..validCols)
+    int x0 = (tx << CAG_TILE_SHIFT) - 1;
+    for (int c = 0; c < validCols + 2; c++) {
+        for (int p = 0; p < CAG_PLANES; p++) {
+            if (ty == 0) {
+                s->up[p][c] |= (universe->haloNorth[x0 + c + 1] >> p) & 1;
+            }
+            if (ty == universe->tilesY - 1) {
+                s->down[p][c] |= (cag_word_t)((universe->haloSouth[x0 + c + 1] >> p) & 1) << (rows - 1);
+            }
+        }
+    }
+}
+
+// computes the next state of the gathered tile into dst, returns 1 if a cell is alive
+// each column is summed vertically with a bit-parallel full adder, then the three
+// column sums around a cell are added as 2-bit numbers (3x3 total, own cell included)
+// the rule is applied as one AND per rule term on the decoded total (life has
+// its own two-term expression, as fast as the hard-coded kernel)
+int CAG_universe_kernel(caUniverse_t *universe, caScratch_t *s, caTile_t *dst, int validCols, cag_word_t rowMask) {
+    // rule terms copied to locals: the tile stores below could alias the universe
+    int life = (universe->rule.birth == (1 << 3)) && (universe->rule.survive == ((1 << 2) | (1 << 3)));
+    int terms = universe->rule.terms;
+    uint8_t lowIndex[10], highIndex[10], selectIndex[10];
+    for (int i = 0; i < terms; i++) {
+        lowIndex[i] = universe->rule.total[i] & 3;
+        highIndex[i] = universe->rule.total[i] >> 2;
+        selectIndex[i] = universe->rule.select[i];
+    }
+    cag_word_t ones[TILE + 2], twos[TILE + 2];
+    cag_word_t occupied = 0;
+
+    for (int c = 0; c < validCols + 2; c++) {
+        cag_word_t u = s->up[0][c], m = s->mid[0][c], d = s->down[0][c];
+        ones[c] = u ^ m ^ d;
+        twos[c] = (u & m) | (d & (u ^ m));
+    }
+
+    for (int c = 1; c <= validCols; c++) {
+        // add the three 2-bit column sums: total = b0 + 2*b1 + 4*b2 + 8*b3
+        cag_word_t b0 = ones[c - 1] ^ ones[c] ^ ones[c + 1];
+        cag_word_t carry = (ones[c - 1] & ones[c]) | (ones[c + 1] & (ones[c - 1] ^ ones[c]));
+        cag_word_t t = twos[c - 1] ^ twos[c] ^ twos[c + 1];
+        cag_word_t fours = (twos[c - 1] & twos[c]) | (twos[c + 1] & (twos[c - 1] ^ twos[c]));
+        cag_word_t b1 = t ^ carry;
+        cag_word_t b2 = fours ^ (t & carry);
+        cag_word_t b3 = fours & t & carry;
+
+        cag_word_t alive = s->mid[0][c];
+        cag_word_t next;
+        if (life) {
+            // B3/S23: total == 3, or total == 4 and the cell is alive
+            next = ((b0 & b1 & ~b2) | (alive & ~b0 & ~b1 & b2)) & ~b3;
+        } else {
+            // total == t is (low two bits == t & 3) & (high bits == t >> 2),
+            // totals only go up to 9 so b3 set means b2 is clear
+            cag_word_t low[4] = {~(b0 | b1), b0 & ~b1, ~b0 & b1, b0 & b1};
+            cag_word_t high[3] = {~(b2 | b3), b2, b3};
+            cag_word_t select[4] = {0, ~alive, alive, WORD_ONES};
+            next = 0;
+            for (int i = 0; i < terms; i++) {
+                next |= low[lowIndex[i]] & high[highIndex[i]] & select[selectIndex[i]];
+            }
+        }
+        occupied |= CAG_universe_age_column(s, dst, c, next & rowMask);
+    }
+    for (int c = validCols; c < TILE; c++) {
+        for (int p = 0; p < CAG_PLANES; p++) {
+            dst->plane[p][c] = 0;
+        }
+    }
+    return occupied != 0;
+}
+
+// writes the next live cells of gathered column c into column c - 1 of dst with
+// their ages, returns next: survivors age by one (saturating), newborn cells
+// take the highest age of their live neighbours
+cag_word_t CAG_universe_age_column(caScratch_t *s, caTile_t *dst, int c, cag_word_t next) {
+    cag_word_t alive = s->mid[0][c];
+    cag_word_t survived = next & alive;
+    cag_word_t born = next & ~alive;
+
+    // survivors: saturating increment of the age planes
+    cag_word_t age[CAG_AGE_PLANES];
+    cag_word_t inc = WORD_ONES;
+    for (int p = 1; p < CAG_PLANES; p++) {
+        inc &= s->mid[p][c];        // lanes with all bits set are saturated
+    }
+    inc = ~inc;
+    for (int p = 1; p < CAG_PLANES; p++) {
+        age[p - 1] = (s->mid[p][c] ^ inc) & survived;
+        inc &= s->mid[p][c];
+    }
+
+    // births: highest age of the 8 neighbours, bit-sliced from the top plane down
+    // (dead neighbours always have age 0, so they never win)
+    if (born) {
+        cag_word_t candidate[8] = {WORD_ONES, WORD_ONES, WORD_ONES, WORD_ONES,
+                WORD_ONES, WORD_ONES, WORD_ONES, WORD_ONES};
+        for (int p = CAG_PLANES - 1; p > 0; p--) {
+            cag_word_t neighbour[8] = {
+                s->up[p][c - 1], s->mid[p][c - 1], s->down[p][c - 1],
+                s->up[p][c], s->down[p][c],
+                s->up[p][c + 1], s->mid[p][c + 1], s->down[p][c + 1]
+            };
+            cag_word_t highest = 0;
+            for (int i = 0; i < 8; i++) {
+                highest |= candidate[i] & neighbour[i];
+            }
+            for (int i = 0; i < 8; i++) {
+                candidate[i] &= neighbour[i] | ~highest;
+            }
+            age[p - 1] |= highest & born;
+        }
+    }
+
+    dst->plane[0][c - 1] = next;
+    for (int p = 1; p < CAG_PLANES; p++) {
+        dst->plane[p][c - 1] = age[p - 1];
+    }
+    return next;
+}
+
+// computes the next state of the gathered tile into dst with a block lookup
+// table kernel (s4640878_CAG_lut.c), returns 1 if a cell is alive
+int CAG_universe_kernel_lut(caUniverse_t *universe, caScratch_t *s, caTile_t *dst, int validCols, cag_word_t rowMask) {
+    cag_word_t next[TILE];
+    cag_word_t occupied = 0;
+
+    if (universe->kernel == CAG_KERNEL_LUT_4X4) {
+        s4640878_lib_CAG_lut_next_4x4(universe->lut, s, next, validCols);
+    } else {
+        s4640878_lib_CAG_lut_next_3x3(universe->lut, s, next, validCols);
+    }
+    for (int c = 1; c <= validCols; c++) {
+        occupied |= CAG_universe_age_column(s, dst, c, next[c - 1] & rowMask);
+    }
+    for (int c = validCols; c < TILE; c++) {
+        for (int p = 0; p < CAG_PLANES; p++) {
+            dst->plane[p][c] = 0;
+        }
+    }
+    return occupied != 0;
+}
+
+// computes the next state of a gathered multi-state tile into dst, returns 1 if a
+// cell is not in state 0: the 3x3 total of state 1 cells is counted as in life,
+// then every cell that can change looks its next state up in the state table
+int CAG_universe_kernel_states(caUniverse_t *universe, caScratch_t *s, caTile_t *dst, int validCols, cag_word_t rowMask) {
+    const uint8_t *table = universe->stateTable;
+    int planes = universe->statePlanes;
+    cag_word_t ones[TILE + 2], twos[TILE + 2];
+    cag_word_t occupied = 0;
+
+    for (int c = 0; c < validCols + 2; c++) {
+        cag_word_t u = s->up[0][c], m = s->mid[0][c], d = s->down[0][c];
+        ones[c] = u ^ m ^ d;
+        twos[c] = (u & m) | (d & (u ^ m));
+    }
+
+    for (int c = 1; c <= validCols; c++) {
+        cag_word_t b0 = ones[c - 1] ^ ones[c] ^ ones[c + 1];
+        cag_word_t carry = (ones[c - 1] & ones[c]) | (ones[c + 1] & (ones[c - 1] ^ ones[c]));
+        cag_word_t t = twos[c - 1] ^ twos[c] ^ twos[c + 1];
+        cag_word_t fours = (twos[c - 1] & twos[c]) | (twos[c + 1] & (twos[c - 1] ^ twos[c]));
+        cag_word_t b1 = t ^ carry;
+        cag_word_t b2 = fours ^ (t & carry);
+        cag_word_t b3 = fours & t & carry;
+
+        // cells in state 0 with no state 1 cell around stay in state 0
+        cag_word_t state = 0;
+        for (int p = 1; p <= planes; p++) {
+            state |= s->mid[p][c];
+        }
+        cag_word_t lanes = (state | b0 | b1 | b2 | b3) & rowMask;
+        cag_word_t out[CAG_AGE_PLANES] = {0};
+        cag_word_t first = 0;
+        while (lanes) {
+            int y = __builtin_ctzll((unsigned long long)lanes);
+            lanes &= lanes - 1;
+            int index = (int)(((b0 >> y) & 1) | (((b1 >> y) & 1) << 1) | (((b2 >> y) & 1) << 2) | (((b3 >> y) & 1) << 3));
+            for (int p = 1; p <= planes; p++) {
+                index |= (int)((s->mid[p][c] >> y) & 1) << (p + 3);
+            }
+            int next = table[index];
+            for (int p = 0; p < planes; p++) {
+                out[p] |= (cag_word_t)((next >> p) & 1) << y;
+            }
+            first |= (cag_word_t)(next == 1) << y;
+        }
+
+        dst->plane[0][c - 1] = first;
+        for (int p = 1; p < CAG_PLANES; p++) {
+            dst->plane[p][c - 1] = (p <= planes) ? out[p - 1] : 0;
+            occupied |= dst->plane[p][c - 1];
+        }
+    }
+    for (int c = validCols; c < TILE; c++) {
+        for (int p = 0; p < CAG_PLANES; p++) {
+            dst->plane[p][c] = 0;
+        }
+    }
+    return occupied != 0;
+}
+
+// computes the next generation of one tile from buffer src into buffer dst
+// tiles whose 3x3 tile neighbourhood is empty are cleared without running the kernel
+// only the tile's own slot is written (and the stepper), so tiles can be stepped
+// by several threads at once: neighbours are read from src, which no one writes
+void CAG_universe_step_tile(caUniverse_t *universe, caStepper_t *stepper, int slot, int src, int dst) {
+    caTile_t *srcTile = &universe->tiles[src][slot];
+    caTile_t *dstTile = &universe->tiles[dst][slot];
+    uint8_t *srcOccupied = universe->occupied[src];
+    uint8_t *dstOccupied = universe->occupied[dst];
+    int32_t *nb = &universe->neighbourSlot[slot * 8];
+
+    // edge tiles can be reached through the halo when the edges are joined
+    int busy = srcOccupied[slot] || ((universe->boundary != CAG_BOUNDARY_DEAD) && CAG_universe_is_edge(universe, slot));
+    for (int i = 0; (i < 8) && !busy; i++) {
+        busy = (nb[i] >= 0) && srcOccupied[nb[i]];
+    }
+    if (!busy) {
+        // nothing can be born here, the tile stays empty
+        if (dstOccupied[slot]) {
+            memset(dstTile, 0, sizeof(caTile_t));
+            dstOccupied[slot] = 0;
+        }
+        return;
+    }
+    CAG_universe_gather(universe, &stepper->scratch, universe->tiles[src], slot);
+    int validCols = CAG_universe_valid_cols(universe, universe->slotX[slot]);
+    cag_word_t rowMask = CAG_universe_row_mask(universe, universe->slotY[slot]);
+    if (universe->rule.family == CAG_FAMILY_LIFE) {
+        switch (universe->kernel) {
+#if CAG_SIMD
+            case CAG_KERNEL_AVX2:
+                dstOccupied[slot] = s4640878_lib_CAG_simd_kernel_avx2(universe, &stepper->scratch, dstTile, validCols, rowMask);
+                break;
+            case CAG_KERNEL_SSE2:
+                dstOccupied[slot] = s4640878_lib_CAG_simd_kernel_sse2(universe, &stepper->scratch, dstTile, validCols, rowMask);
+                break;
+#endif
+            case CAG_KERNEL_LUT_3X3:
+            case CAG_KERNEL_LUT_4X4:
+                dstOccupied[slot] = CAG_universe_kernel_lut(universe, &stepper->scratch, dstTile, validCols, rowMask);
+                break;
+            default:
+                dstOccupied[slot] = CAG_universe_kernel(universe, &stepper->scratch, dstTile, validCols, rowMask);
+                break;
+        }
+    } else {
+        dstOccupied[slot] = CAG_universe_kernel_states(universe, &stepper->scratch, dstTile, validCols, rowMask);
+    }
+    if (memcmp(dstTile, srcTile, sizeof(caTile_t)) != 0) {
+        CAG_universe_diff_tile(universe, stepper, slot, srcTile, dstTile);
+        // a slot is stepped once per generation and step_begin cleared its flag
+        universe->changed[slot] = 1;
+        stepper->changedList[stepper->changedCount++] = slot;
+        CAG_universe_tile_bounds(universe, slot, dstTile);
+        // the tile's own pyramid entry, the levels above are added up by step_end
+        universe->pyramid[dst][0][universe->slotY[slot] * universe->tilesX + universe->slotX[slot]] = CAG_universe_tile_cells(dstTile);
+    }
+}
+
+// computes the next generation with the packed tile kernel
+// a tile can only change if it or a neighbour changed in the previous generation,
+// so only those tiles are recomputed (a static or empty universe costs nothing)
+// the new generation goes into the oldest buffer and is then published, readers
+// of the two newest generations are never written under
+void s4640878_lib_CAG_universe_step(caUniverse_t *universe) {
+    int workCount = s4640878_lib_CAG_universe_step_begin(universe);
+    s4640878_lib_CAG_universe_stepper_init(&universe->stepper, universe->changedList);
+    s4640878_lib_CAG_universe_step_tiles(universe, &universe->stepper, 0, workCount);
+    caStepper_t *stepper = &universe->stepper;
+    s4640878_lib_CAG_universe_step_end(universe, &stepper, 1);
+}
+
+// starts a generation: lists the tiles to recompute in universe->work and
+// returns how many there are, every listed tile is then stepped once with
+// step_tiles (in any order, by any number of steppers) before step_end
+int s4640878_lib_CAG_universe_step_begin(caUniverse_t *universe) {
+    int src = universe->current;
+    int dst = (src + 1) % CAG_BUFFERS;
+
+    if (++universe->stamp == 0) {
+        memset(universe->visit, 0, universe->tileCount * sizeof(uint32_t));
+        universe->stamp = 1;
+    }
+    uint32_t stamp = universe->stamp;
+
+    // changed tiles and their neighbours make up the work list
+    int workCount = 0, edgeChanged = 0;
+    for (int i = 0; i < universe->changedCount; i++) {
+        int slot = universe->changedList[i];
+        int32_t *nb = &universe->neighbourSlot[slot * 8];
+        universe->changed[slot] = 0;
+        edgeChanged |= CAG_universe_is_edge(universe, slot);
+        for (int n = -1; n < 8; n++) {
+            int s = (n < 0) ? slot : nb[n];
+            if ((s >= 0) && (universe->visit[s] != stamp)) {
+                universe->visit[s] = stamp;
+                universe->work[workCount++] = s;
+            }
+        }
+    }
+
+    // joined edges: a change on one edge reaches the tiles on the opposite edge
+    if ((universe->boundary != CAG_BOUNDARY_DEAD) && edgeChanged) {
+        CAG_universe_fill_halo(universe, universe->tiles[src]);
+        for (int i = 0; i < universe->edgeCount; i++) {
+            int slot = universe->edgeList[i];
+            if (universe->visit[slot] != stamp) {
+                universe->visit[slot] = stamp;
+                universe->work[workCount++] = slot;
+            }
+        }
+    }
+
+    // the next buffer holds generation - 2: tiles that changed in the step before
+    // are stale there, bring over the ones that are not recomputed
+    caTile_t *srcTiles = universe->tiles[src], *dstTiles = universe->tiles[dst];
+    for (int i = 0; i < universe->previousCount; i++) {
+        int slot = universe->previousList[i];
+        if (universe->visit[slot] != stamp) {
+            memcpy(&dstTiles[slot], &srcTiles[slot], sizeof(caTile_t));
+            universe->occupied[dst][slot] = universe->occupied[src][slot];
+        }
+    }
+    // so are the pyramid entries of those tiles and of the ones changed (or edited)
+    // since, which step_tile only rewrites if they change again
+    for (int list = 0; list < 2; list++) {
+        uint32_t *slots = (list == 0) ? universe->previousList : universe->changedList;
+        int slotCount = (list == 0) ? universe->previousCount : universe->changedCount;
+        for (int i = 0; i < slotCount; i++) {
+            int index = universe->slotY[slots[i]] * universe->tilesX + universe->slotX[slots[i]];
+            universe->pyramid[dst][0][index] = universe->pyramid[src][0][index];
+        }
+        for (int i = 0; i < slotCount; i++) {
+            CAG_universe_pyramid_up(universe, dst, slots[i]);
+        }
+    }
+    uint32_t *list = universe->previousList;
+    universe->previousList = universe->changedList;
+    universe->previousCount = universe->changedCount;
+    universe->changedList = list;
+    universe->changedCount = 0;
+
+    if (workCount * 4 > universe->tileCount) {
+        // most tiles are active: run through them in storage (morton) order
+        workCount = 0;
+        for (int slot = 0; slot < universe->tileCount; slot++) {
+            if (universe->visit[slot] == stamp) {
+                universe->work[workCount++] = slot;
+            }
+        }
+    }
+    return workCount;
+}
+
+// steps tiles first..first + count - 1 of the work list, the counters and
+// changed tiles go into the stepper
+void s4640878_lib_CAG_universe_step_tiles(caUniverse_t *universe, caStepper_t *stepper, int first, int count) {
+    int src = universe->current;
+    int dst = (src + 1) % CAG_BUFFERS;
+    for (int i = first; i < first + count; i++) {
+        CAG_universe_step_tile(universe, stepper, universe->work[i], src, dst);
+    }
+}
+
+// ends a generation once every listed tile is stepped: adds up the steppers
+// (in order, their changed tiles become the changed list) and publishes it
+void s4640878_lib_CAG_universe_step_end(caUniverse_t *universe, caStepper_t **steppers, int count) {
+    uint64_t before = universe->hash;
+    universe->births = 0;
+    universe->deaths = 0;
+    universe->changedCells = 0;
+    for (int i = 0; i < count; i++) {
+        caStepper_t *stepper = steppers[i];
+        universe->hash ^= stepper->hash;
+        universe->births += stepper->births;
+        universe->deaths += stepper->deaths;
+        universe->changedCells += stepper->changedCells;
+        // the serial stepper already writes into the changed list (memmove is a no-op there)
+        memmove(&universe->changedList[universe->changedCount], stepper->changedList,
+                stepper->changedCount * sizeof(uint32_t));
+        universe->changedCount += stepper->changedCount;
+    }
+    universe->population += universe->births - universe->deaths;
+    if (universe->changedCount > 0) {
+        universe->boundsValid = 0;
+    }
+    int dst = (universe->current + 1) % CAG_BUFFERS;
+    for (int i = 0; i < universe->changedCount; i++) {
+        CAG_universe_pyramid_up(universe, dst, universe->changedList[i]);
+    }
+    universe->current = dst;
+    universe->generation++;
+    CAG_universe_record(universe, before);
+
+    // publish once every tile of the generation is written
+    uint32_t sequence = (universe->published >> PUBLISH_SHIFT) + 1;
+    __sync_synchronize();
+    universe->published = (sequence << PUBLISH_SHIFT) | universe->current;
+}
+
+// clears the counters of a stepper, its changed tiles go into changedList
+// (room for every tile of the universe)
+void s4640878_lib_CAG_universe_stepper_init(caStepper_t *stepper, uint32_t *changedList) {
+    stepper->hash = 0;
+    stepper->births = 0;
+    stepper->deaths = 0;
+    stepper->changedCells = 0;
+    stepper->changedList = changedList;
+    stepper->changedCount = 0;
+}
+
+/* code adapted from:
+ * processing.org/examples/gameoflife.html
+ * A Processing Implementation of Game of Life by Joan Soler-Adillon
+ */
+// computes the next generation with one int per cell (reference implementation)
+// kept to check the packed kernel against, needs 2 * (width + 2) * (height + 2) ints of heap
+// the copy has a one cell halo filled from the boundary mode, so the neighbour loop
+// needs no bounds checks
+void s4640878_lib_CAG_universe_step_reference(caUniverse_t *universe) {
+    int width = universe->width, height = universe->height;
+    int stride = height + 2;
+    int multiState = (universe->rule.family != CAG_FAMILY_LIFE);
+    int birth[9], survive[9];       // rule tables, indexed by live neighbour count
+    for (int n = 0; n < 9; n++) {
+        birth[n] = (universe->rule.birth >> n) & 1;
+        survive[n] = (universe->rule.survive >> n) & 1;
+    }
+    int *cells = malloc((width + 2) * stride * sizeof(int));
+    int *cellsBuf = malloc((width + 2) * stride * sizeof(int));
+    if ((cells == NULL) || (cellsBuf == NULL)) {
+        free(cells);
+        free(cellsBuf);
+        return;
+    }
+    uint64_t before = s4640878_lib_CAG_universe_write_begin(universe);
+    // make a copy of the cells array, cell (x, y) is at (x + 1) * stride + (y + 1)
+    for (int x = -1; x <= width; x++) {
+        for (int y = -1; y <= height; y++) {
+            int wx = x, wy = y, value = 0;
+            if (s4640878_lib_CAG_universe_wrap(universe, &wx, &wy)) {
+                value = s4640878_lib_CAG_universe_get_cell(universe, wx, wy);
+            }
+            cellsBuf[(x + 1) * stride + (y + 1)] = value;
+            cells[(x + 1) * stride + (y + 1)] = value;
+        }
+    }
+    // loops through cells
+    for (int x = 1; x <= width; x++) {
+        for (int y = 1; y <= height; y++) {
+            // loops through adjacent cells
+            int count = 0, value = 0;
+            for (int dx = x - 1; dx <= x + 1; dx++) {
+                for (int dy = y - 1; dy <= y + 1; dy++) {
+                    // skip own cell
+                    if (!((dx == x) && (dy == y))) {
+                        // increment count if adjacent cell is alive (multi-state: in state 1)
+                        if (multiState ? (cellsBuf[dx * stride + dy] == 1) : cellsBuf[dx * stride + dy]) {
+                            count++;
+                            if (cellsBuf[dx * stride + dy] > value) {
+                                value = cellsBuf[dx * stride + dy];   // save the higher adjacent state value
+                            }
+                        }
+                    }
+                }
+            }
+            // check if cell is alive or dead, applies rules
+            if (multiState) {
+                int state = cellsBuf[x * stride + y];
+                cells[x * stride + y] = universe->stateTable[(state << 4) | (count + (state == 1))];
+            } else if (cellsBuf[x * stride + y]) {
+                cells[x * stride + y] = survive[count] * (cellsBuf[x * stride + y] + 1);   // increment state value or die
+            } else {
+                cells[x * stride + y] = birth[count] * value;     // assigns the highest state value to new cell
+            }
+        }
+    }
+    for (int x = 0; x < width; x++) {
+        for (int y = 0; y < height; y++) {
+            s4640878_lib_CAG_universe_set_cell(universe, x, y, cells[(x + 1) * stride + (y + 1)]);
+        }
+    }
+    free(cells);
+    free(cellsBuf);
+    s4640878_lib_CAG_universe_write_end(universe, before, 1);
+}
+
+// starts writing a generation computed by another engine (with set_cell, cells
+// that did not change can be left alone): clears the step counters and returns
+// the hash to pass to write_end
+// the generation is written in place, readers fail read_end until write_end
+uint64_t s4640878_lib_CAG_universe_write_begin(caUniverse_t *universe) {
+    CAG_universe_edit_begin(universe);
+    universe->births = 0;
+    universe->deaths = 0;
+    universe->changedCells = 0;
+    return universe->hash;
+}
+
+// ends writing a generation computed by another engine, generations after the
+// one write_begin started from, and looks for a cycle as a step does
+void s4640878_lib_CAG_universe_write_end(caUniverse_t *universe, uint64_t before, uint32_t generations) {
+    universe->generation += generations;
+    CAG_universe_record(universe, before);
+    CAG_universe_edit_end(universe);
+}
+
+// starts editing the published generation in place (nested edits mark it once):
+// the sequence moves on by 2 and is flagged, so readers of it, and readers that
+// start before edit_end, fail read_end
+void CAG_universe_edit_begin(caUniverse_t *universe) {
+    if (universe->writing++ == 0) {
+        uint32_t sequence = (universe->published >> PUBLISH_SHIFT) + 2;
+        universe->published = (sequence << PUBLISH_SHIFT) | PUBLISH_WRITING | universe->current;
+        __sync_synchronize();
+    }
+}
+
+// ends an edit of the published generation, publishing it again once the
+// outermost edit ends
+void CAG_universe_edit_end(caUniverse_t *universe) {
+    if (--universe->writing == 0) {
+        uint32_t sequence = (universe->published >> PUBLISH_SHIFT) + 1;
+        __sync_synchronize();
+        universe->published = (sequence << PUBLISH_SHIFT) | universe->current;
+    }
+}
+
+// gets the bounding box of the live cells, returns 0 if there is no live cell
+int s4640878_lib_CAG_universe_get_bounds(caUniverse_t *universe, caBounds_t *bounds) {
+    if (!universe->boundsValid) {
+        // fold the tile bounds, only after something changed
+        caBounds_t box = {universe->width, universe->height, -1, -1};
+        for (int slot = 0; slot < universe->tileCount; slot++) {
+            uint8_t *b = &universe->tileBounds[slot * 4];
+            if (b[0] == BOUNDS_STALE) {
+                CAG_universe_tile_bounds(universe, slot, &universe->tiles[universe->current][slot]);
+            }
+            if (b[0] == BOUNDS_EMPTY) {
+                continue;
+            }
+            int x = universe->slotX[slot] << CAG_TILE_SHIFT, y = universe->slotY[slot] << CAG_TILE_SHIFT;
+            box.x0 = (x + b[0] < box.x0) ? x + b[0] : box.x0;
+            box.x1 = (x + b[1] > box.x1) ? x + b[1] : box.x1;
+            box.y0 = (y + b[2] < box.y0) ? y + b[2] : box.y0;
+            box.y1 = (y + b[3] > box.y1) ? y + b[3] : box.y1;
+        }
+        universe->bounds = box;
+        universe->boundsValid = 1;
+    }
+    *bounds = universe->bounds;
+    return bounds->x0 <= bounds->x1;
+}
+
+// returns the number of tiles changed by the last step or edit
+int s4640878_lib_CAG_universe_get_changed(caUniverse_t *universe) {
+    return universe->changedCount;
+}
+
+// returns the number of live cells (multi-state: cells in state 1)
+int s4640878_lib_CAG_universe_get_population(caUniverse_t *universe) {
+    return universe->population;
+}
+
+// copies the population and activity counters of the current generation
+void s4640878_lib_CAG_universe_get_stats(caUniverse_t *universe, caStats_t *stats) {
+    stats->generation = universe->generation;
+    stats->population = universe->population;
+    stats->births = universe->births;
+    stats->deaths = universe->deaths;
+    stats->changed = universe->changedCells;
+    stats->period = universe->period;
+}
+
+// returns the bytes allocated by create (the universe and all of its buffers)
+uint32_t s4640878_lib_CAG_universe_get_memory(caUniverse_t *universe) {
+    uint32_t count = universe->tileCount;
+    uint32_t perTile = sizeof(uint32_t) + 2 * sizeof(uint16_t) + 8 * sizeof(int32_t)  // slot maps
+            + sizeof(uint8_t) + 5 * sizeof(uint32_t) + 4 * sizeof(uint8_t)          // step lists, bounds
+            + CAG_BUFFERS * (sizeof(caTile_t) + sizeof(uint8_t));                    // tiles
+    uint32_t pyramid = 0;
+    for (int k = 0; k < universe->pyramidLevels; k++) {
+        pyramid += LEVEL_SIZE(universe->tilesX, k) * LEVEL_SIZE(universe->tilesY, k) * sizeof(uint32_t);
+    }
+    return sizeof(caUniverse_t) + count * perTile
+            + 2 * CAG_PLANES * universe->tilesY * sizeof(cag_word_t)     // west/east halo
+            + 2 * (universe->width + 2) * sizeof(uint8_t)               // north/south halo
+            + CAG_BUFFERS * pyramid                                     // population pyramids
+            + s4640878_lib_CAG_lut_get_entries(universe->kernel);       // block kernel table
+}
+
+// returns 1 if the last packed step left the universe as it was, ages of
+// live life cells aside (they keep counting up to CAG_AGE_MAX)
+// only the tiles the step changed can differ from the previous generation
+int s4640878_lib_CAG_universe_get_still(caUniverse_t *universe) {
+    int previous = (universe->current + CAG_BUFFERS - 1) % CAG_BUFFERS;
+    int planes = (universe->rule.family == CAG_FAMILY_LIFE) ? 1 : CAG_PLANES;
+    for (int i = 0; i < universe->changedCount; i++) {
+        int slot = universe->changedList[i];
+        caTile_t *now = &universe->tiles[universe->current][slot];
+        caTile_t *before = &universe->tiles[previous][slot];
+        if (memcmp(now->plane[0], before->plane[0], planes * sizeof(now->plane[0])) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// returns the hash of the current generation: equal cells give equal hashes
+// (life ages are not hashed, multi-state cells are hashed by state)
+uint64_t s4640878_lib_CAG_universe_get_hash(caUniverse_t *universe) {
+    return universe->hash;
+}
+
+// returns the period of the cycle the universe entered with the last step
+// (1: still, 2..CAG_HISTORY: oscillating), 0 if none was found or cells were edited
+int s4640878_lib_CAG_universe_get_period(caUniverse_t *universe) {
+    return universe->period;
+}
+
+// hash contribution of one column word of a plane, 0 for an empty word
+// so only changed columns need updating (xor out the old word, xor in the new)
+// planes that are not hashed (life ages, multi-state plane 0) contribute 0
+uint64_t CAG_universe_column_hash(caUniverse_t *universe, int slot, int c, int p, cag_word_t word) {
+    int multiState = (universe->rule.family != CAG_FAMILY_LIFE);
+    if ((word == 0) || (multiState ? ((p == 0) || (p > universe->statePlanes)) : (p != 0))) {
+        return 0;
+    }
+    // the column key spread by a golden ratio multiply, then one mixing round
+    uint64_t key = ((uint64_t)slot * TILE + c) * CAG_PLANES + p;
+    uint64_t z = ((uint64_t)word ^ (key * 0x9E3779B97F4A7C15ULL)) * 0xBF58476D1CE4E5B9ULL;
+    return z ^ (z >> 31);
+}
+
+// adds the hash change and the counters of a tile going from before to after to
+// a stepper, only the columns whose state changed are hashed and counted
+void CAG_universe_diff_tile(caUniverse_t *universe, caStepper_t *stepper, int slot, caTile_t *before, caTile_t *after) {
+    int first = (universe->rule.family == CAG_FAMILY_LIFE) ? 0 : 1;
+    int last = (universe->rule.family == CAG_FAMILY_LIFE) ? 0 : universe->statePlanes;
+    for (int c = 0; c < TILE; c++) {
+        cag_word_t flipped = 0;
+        for (int p = first; p <= last; p++) {
+            cag_word_t diff = before->plane[p][c] ^ after->plane[p][c];
+            if (diff) {
+                stepper->hash ^= CAG_universe_column_hash(universe, slot, c, p, before->plane[p][c])
+                        ^ CAG_universe_column_hash(universe, slot, c, p, after->plane[p][c]);
+                flipped |= diff;
+            }
+        }
+        if (flipped) {
+            CAG_universe_count(&stepper->births, &stepper->deaths, &stepper->changedCells,
+                    before->plane[0][c], after->plane[0][c], flipped);
+        }
+    }
+}
+
+// adds the cells of a plane 0 column that came alive, died or changed state
+// to the counters, returns the change in population
+int CAG_universe_count(int *births, int *deaths, int *changed, cag_word_t before, cag_word_t after, cag_word_t flipped) {
+    int born = __builtin_popcountll((unsigned long long)(after & ~before));
+    int died = __builtin_popcountll((unsigned long long)(before & ~after));
+    *births += born;
+    *deaths += died;
+    // life: the changed cells are the births and deaths
+    if (flipped == (before ^ after)) {
+        *changed += born + died;
+    } else {
+        *changed += __builtin_popcountll((unsigned long long)flipped);
+    }
+    return born - died;
+}
+
+// recomputes the hash and population from the occupied tiles and forgets the history
+void CAG_universe_rehash(caUniverse_t *universe) {
+    universe->hash = 0;
+    universe->population = 0;
+    for (int slot = 0; slot < universe->tileCount; slot++) {
+        if (universe->occupied[universe->current][slot]) {
+            caTile_t *tile = &universe->tiles[universe->current][slot];
+            for (int p = 0; p < CAG_PLANES; p++) {
+                for (int c = 0; c < TILE; c++) {
+                    universe->hash ^= CAG_universe_column_hash(universe, slot, c, p, tile->plane[p][c]);
+                }
+            }
+            for (int c = 0; c < TILE; c++) {
+                universe->population += __builtin_popcountll((unsigned long long)tile->plane[0][c]);
+            }
+        }
+    }
+    universe->historyCount = 0;
+    universe->period = 0;
+}
+
+// looks for the new generation in the hash history, then records it
+// before is the hash the step started from, recorded first if cells were edited
+void CAG_universe_record(caUniverse_t *universe, uint64_t before) {
+    if ((universe->historyCount == 0) || (universe->history[universe->historyHead] != before)) {
+        universe->historyHead = (universe->historyHead + 1) % CAG_HISTORY;
+        universe->history[universe->historyHead] = before;
+        if (universe->historyCount < CAG_HISTORY) {
+            universe->historyCount++;
+        }
+    }
+    universe->period = 0;
+    for (int i = 0; i < universe->historyCount; i++) {
+        if (universe->history[(universe->historyHead + CAG_HISTORY - i) % CAG_HISTORY] == universe->hash) {
+            universe->period = i + 1;
+            break;
+        }
+    }
+    universe->historyHead = (universe->historyHead + 1) % CAG_HISTORY;
+    universe->history[universe->historyHead] = universe->hash;
+    if (universe->historyCount < CAG_HISTORY) {
+        universe->historyCount++;
+    }
+}
+
+// starts reading the published generation, returns the ticket for read_cell/read_end
+// does not block: the stepping task never waits for readers
+uint32_t s4640878_lib_CAG_universe_read_begin(caUniverse_t *universe) {
+    uint32_t ticket = universe->published;
+    __sync_synchronize();
+    return ticket;
+}
+
+// returns the state value of cell (x, y) in the generation of a ticket
+int s4640878_lib_CAG_universe_read_cell(caUniverse_t *universe, uint32_t ticket, int x, int y) {
+    if ((x < 0) || (x >= universe->width) || (y < 0) || (y >= universe->height)) {
+        return 0;
+    }
+    int slot = universe->tileSlot[(y >> CAG_TILE_SHIFT) * universe->tilesX + (x >> CAG_TILE_SHIFT)];
+    return CAG_universe_tile_value(universe, &universe->tiles[ticket & PUBLISH_MASK][slot], x & TILE_MASK, y & TILE_MASK);
+}
+
+// reads cells (x, y) .. (x, y + 31) of the generation of a ticket into
+// planes[0 .. CAG_PLANES - 1]: bit i of a plane word is cell (x, y + i), the
+// planes as in the tiles (life: plane 0 live, multi-state: planes 1.. the state)
+// cells outside the universe read as 0
+void s4640878_lib_CAG_universe_read_column(caUniverse_t *universe, uint32_t ticket, int x, int y, uint32_t *planes) {
+    caTile_t *tiles = universe->tiles[ticket & PUBLISH_MASK];
+
+    memset(planes, 0, CAG_PLANES * sizeof(uint32_t));
+    if ((x < 0) || (x >= universe->width)) {
+        return;
+    }
+    // a tile column word at a time, from the first row inside the universe
+    int row = (y < 0) ? -y : 0;
+    int rows = (universe->height - y < 32) ? universe->height - y : 32;
+    while (row < rows) {
+        int cy = y + row;
+        int slot = universe->tileSlot[(cy >> CAG_TILE_SHIFT) * universe->tilesX + (x >> CAG_TILE_SHIFT)];
+        int offset = cy & TILE_MASK;
+        int count = ((TILE - offset) < (rows - row)) ? TILE - offset : rows - row;
+        uint32_t mask = (count < 32) ? (((uint32_t)1 << count) - 1) : 0xFFFFFFFFu;
+        for (int p = 0; p < CAG_PLANES; p++) {
+            planes[p] |= ((uint32_t)(tiles[slot].plane[p][x & TILE_MASK] >> offset) & mask) << row;
+        }
+        row += count;
+    }
+}
+
+// returns 1 if the generation of a ticket was intact for the whole read
+// its buffer is only reused after two more generations are published, and an
+// edit in place moves the sequence on by 3 (the ticket is flagged if the read
+// started during one)
+int s4640878_lib_CAG_universe_read_end(caUniverse_t *universe, uint32_t ticket) {
+    __sync_synchronize();
+    return !(ticket & PUBLISH_WRITING) && (((universe->published >> PUBLISH_SHIFT) - (ticket >> PUBLISH_SHIFT)) <= 1);
+}
+
+// returns the cells that are not dead in the generation of a ticket in the block
+// of a pyramid level holding cell (x, y): (CAG_TILE_BITS << level) cells a side,
+// aligned to its size, 0 outside the universe or the levels
+uint32_t s4640878_lib_CAG_universe_read_block(caUniverse_t *universe, uint32_t ticket, int level, int x, int y) {
+    if ((x < 0) || (x >= universe->width) || (y < 0) || (y >= universe->height)
+            || (level < 0) || (level >= universe->pyramidLevels)) {
+        return 0;
+    }
+    int bx = (x >> CAG_TILE_SHIFT) >> level, by = (y >> CAG_TILE_SHIFT) >> level;
+    return universe->pyramid[ticket & PUBLISH_MASK][level][by * LEVEL_SIZE(universe->tilesX, level) + bx];
+}
+
+// selects the boundary mode (CAG_BOUNDARY_*), the edge tiles are recomputed next step
+void s4640878_lib_CAG_universe_set_boundary(caUniverse_t *universe, int boundary) {
+    if ((boundary < CAG_BOUNDARY_DEAD) || (boundary > CAG_BOUNDARY_CROSS)) {
+        return;
+    }
+    universe->boundary = boundary;
+    if (boundary == CAG_BOUNDARY_DEAD) {
+        memset(universe->haloWest, 0, CAG_PLANES * universe->tilesY * sizeof(cag_word_t));
+        memset(universe->haloEast, 0, CAG_PLANES * universe->tilesY * sizeof(cag_word_t));
+        memset(universe->haloNorth, 0, universe->width + 2);
+        memset(universe->haloSouth, 0, universe->width + 2);
+    }
+    for (int i = 0; i < universe->edgeCount; i++) {
+        CAG_universe_mark_changed(universe, universe->edgeList[i]);
+    }
+    // earlier generations do not repeat under other edges
+    universe->historyCount = 0;
+    universe->period = 0;
+}
+
+// returns the boundary mode
+int s4640878_lib_CAG_universe_get_boundary(caUniverse_t *universe) {
+    return universe->boundary;
+}
+
+// builds a rule from birth and survival neighbour count masks (bit n: n neighbours)
+// and a number of states: 2 is life, more is a generations rule (wireworld ignores
+// the counts). returns 0, or -1 for counts above 8, birth on 0 neighbours (that
+// would fill the empty universe in one step) or more than CAG_AGE_MAX states
+int s4640878_lib_CAG_universe_compile_rule(caRule_t *rule, int family, uint16_t birth, uint16_t survive, int states) {
+    if (family == CAG_FAMILY_WIREWORLD) {
+        birth = 0;
+        survive = 0;
+        states = 4;
+    } else {
+        if ((birth & 1) || (birth >> 9) || (survive >> 9) || (states < 2) || (states > CAG_AGE_MAX)) {
+            return -1;
+        }
+        family = (states == 2) ? CAG_FAMILY_LIFE : CAG_FAMILY_GENERATIONS;
+    }
+    rule->family = family;
+    rule->states = states;
+    rule->birth = birth;
+    rule->survive = survive;
+    rule->terms = 0;
+    for (int total = 0; total <= 9; total++) {
+        // a dead cell has total live neighbours, a live cell total - 1
+        int select = (((birth >> total) & 1) ? CAG_RULE_DEAD : 0)
+                | (((total > 0) && ((survive >> (total - 1)) & 1)) ? CAG_RULE_ALIVE : 0);
+        if (select) {
+            rule->total[rule->terms] = total;
+            rule->select[rule->terms] = select;
+            rule->terms++;
+        }
+    }
+    return 0;
+}
+
+// builds a rule from a string: "B36/S23" (either order, any case), "B2/S/C3"
+// (generations), "23/3" and "345/2/4" (survival first) or "WireWorld"
+// returns 0, or -1 if the string is not a valid rule
+int s4640878_lib_CAG_universe_parse_rule(caRule_t *rule, const char *string) {
+    const char *name = "wireworld";
+    int i = 0;
+    while ((name[i] != '\0') && ((string[i] | 0x20) == name[i])) {
+        i++;
+    }
+    if ((name[i] == '\0') && (string[i] == '\0')) {
+        return s4640878_lib_CAG_universe_compile_rule(rule, CAG_FAMILY_WIREWORLD, 0, 0, 4);
+    }
+
+    uint16_t mask[2] = {0, 0};      // birth, survive
+    int states = 2, section = -1, sections = 0, lettered = 0, slashes = 0;
+    for (const char *p = string; *p != '\0'; p++) {
+        char ch = *p;
+        if ((ch == 'B') || (ch == 'b')) {
+            section = 0;
+            lettered = 1;
+            sections++;
+        } else if ((ch == 'S') || (ch == 's')) {
+            section = 1;
+            lettered = 1;
+            sections++;
+        } else if ((ch == 'C') || (ch == 'c')) {
+            section = 2;
+            states = 0;
+            lettered = 1;
+            sections++;
+        } else if ((ch >= '0') && (ch <= '9')) {
+            if (section < 0) {
+                // unlettered rules are survival first
+                section = 1;
+                sections++;
+            }
+            if (section == 2) {
+                states = states * 10 + (ch - '0');
+                if (states > CAG_AGE_MAX) {
+                    return -1;
+                }
+            } else if (ch <= '8') {
+                mask[section] |= 1 << (ch - '0');
+            } else {
+                return -1;
+            }
+        } else if (ch == '/') {
+            if (!lettered) {
+                // survival / birth / states
+                slashes++;
+                section = (slashes == 1) ? 0 : 2;
+                if (section == 2) {
+                    states = 0;
+                }
+                sections++;
+            }
+        } else if (ch != ' ') {
+            return -1;
+        }
+    }
+    if (sections == 0) {
+        return -1;
+    }
+    return s4640878_lib_CAG_universe_compile_rule(rule, CAG_FAMILY_LIFE, mask[0], mask[1], states);
+}
+
+// writes a rule as "B<counts>/S<counts>" ("/C<states>" for generations, "WireWorld")
+// into string (CAG_RULE_LEN chars)
+void s4640878_lib_CAG_universe_format_rule(const caRule_t *rule, char *string) {
+    if (rule->family == CAG_FAMILY_WIREWORLD) {
+        strcpy(string, "WireWorld");
+        return;
+    }
+    *string++ = 'B';
+    for (int n = 0; n <= 8; n++) {
+        if ((rule->birth >> n) & 1) {
+            *string++ = '0' + n;
+        }
+    }
+    *string++ = '/';
+    *string++ = 'S';
+    for (int n = 0; n <= 8; n++) {
+        if ((rule->survive >> n) & 1) {
+            *string++ = '0' + n;
+        }
+    }
+    if (rule->family == CAG_FAMILY_GENERATIONS) {
+        *string++ = '/';
+        *string++ = 'C';
+        if (rule->states >= 10) {
+            *string++ = '0' + rule->states / 10;
+        }
+        *string++ = '0' + rule->states % 10;
+    }
+    *string = '\0';
+}
+
+// re-encodes the cells of every buffer after the family or number of states changed:
+// cells in the counted state (life: alive) become state 1 (life: age 1), the rest die
+void CAG_universe_convert(caUniverse_t *universe) {
+    int multiState = (universe->rule.family != CAG_FAMILY_LIFE);
+    for (int b = 0; b < CAG_BUFFERS; b++) {
+        for (int slot = 0; slot < universe->tileCount; slot++) {
+            caTile_t *tile = &universe->tiles[b][slot];
+            cag_word_t any = 0;
+            if ((b == universe->current) && universe->occupied[b][slot]) {
+                // cells may vanish, so the halo and neighbours are refreshed too
+                CAG_universe_mark_changed(universe, slot);
+            }
+            for (int c = 0; c < TILE; c++) {
+                for (int p = 1; p < CAG_PLANES; p++) {
+                    tile->plane[p][c] = ((p == 1) && multiState) ? tile->plane[0][c] : 0;
+                }
+                any |= tile->plane[0][c];
+            }
+            universe->occupied[b][slot] = (any != 0);
+            if (b == universe->current) {
+                CAG_universe_tile_bounds(universe, slot, tile);
+            }
+        }
+        CAG_universe_pyramid_build(universe, b);
+    }
+}
+
+// selects the rule, every occupied tile is recomputed next step
+// changing the family or number of states keeps only the cells in the counted state
+void s4640878_lib_CAG_universe_set_rule(caUniverse_t *universe, const caRule_t *rule) {
+    int convert = (rule->family != universe->rule.family) || (rule->states != universe->rule.states);
+    universe->rule = *rule;
+
+    // multi-state table: next state of [(state << 4) | 3x3 total of state 1 cells]
+    universe->statePlanes = 0;
+    while ((1 << universe->statePlanes) < rule->states) {
+        universe->statePlanes++;
+    }
+    for (int state = 0; state < 16; state++) {
+        for (int total = 0; total < 16; total++) {
+            int count = total - (state == 1);   // a state 1 cell counts itself in the total
+            int next = 0;
+            if ((state >= rule->states) || (count < 0) || (count > 8)) {
+                next = 0;
+            } else if (rule->family == CAG_FAMILY_WIREWORLD) {
+                switch (state) {
+                    case CAG_WIRE_HEAD:
+                        next = CAG_WIRE_TAIL;
+                        break;
+                    case CAG_WIRE_TAIL:
+                        next = CAG_WIRE_CONDUCTOR;
+                        break;
+                    case CAG_WIRE_CONDUCTOR:
+                        next = ((count == 1) || (count == 2)) ? CAG_WIRE_HEAD : CAG_WIRE_CONDUCTOR;
+                        break;
+                }
+            } else if (state == 0) {
+                next = (rule->birth >> count) & 1;
+            } else if (state == 1) {
+                next = ((rule->survive >> count) & 1) ? 1 : ((rule->states > 2) ? 2 : 0);
+            } else {
+                next = (state + 1 < rule->states) ? state + 1 : 0;
+            }
+            universe->stateTable[(state << 4) | total] = next;
+        }
+    }
+    if (universe->lut != NULL) {
+        s4640878_lib_CAG_lut_build(universe->lut, universe->kernel, rule);
+    }
+
+    if (convert) {
+        CAG_universe_edit_begin(universe);
+        CAG_universe_convert(universe);
+        CAG_universe_edit_end(universe);
+    }
+    // the cells may now be hashed over other planes, and earlier generations
+    // do not repeat under another rule
+    CAG_universe_rehash(universe);
+    for (int slot = 0; slot < universe->tileCount; slot++) {
+        if (universe->occupied[universe->current][slot]) {
+            CAG_universe_mark_changed(universe, slot);
+        }
+    }
+}
+
+// selects the packed tile kernel (CAG_KERNEL_*), or the best one below it that
+// the build and the cpu have, returns the kernel selected
+// every kernel gives the same cells, only the time differs. the block kernels
+// build their table from the rule (and again on every rule change), without
+// the memory for it the scalar kernel is selected
+int s4640878_lib_CAG_universe_set_kernel(caUniverse_t *universe, int kernel) {
+    free(universe->lut);
+    universe->lut = NULL;
+    if ((kernel == CAG_KERNEL_LUT_3X3) || (kernel == CAG_KERNEL_LUT_4X4)) {
+        universe->lut = malloc(s4640878_lib_CAG_lut_get_entries(kernel));
+        if (universe->lut != NULL) {
+            universe->kernel = kernel;
+            s4640878_lib_CAG_lut_build(universe->lut, kernel, &universe->rule);
+            return kernel;
+        }
+        kernel = CAG_KERNEL_SCALAR;
+    }
+#if CAG_SIMD
+    while ((kernel > CAG_KERNEL_SCALAR) && !s4640878_lib_CAG_simd_supported(kernel)) {
+        kernel--;
+    }
+    universe->kernel = (kernel < CAG_KERNEL_SCALAR) ? CAG_KERNEL_SCALAR : kernel;
+#else
+    universe->kernel = CAG_KERNEL_SCALAR;
+#endif
+    return universe->kernel;
+}
+
+// returns the packed tile kernel
+int s4640878_lib_CAG_universe_get_kernel(caUniverse_t *universe) {
+    return universe->kernel;
+}
@@ -0,0 +1,310 @@
+/**
+ **************************************************************
+ * @file mylib/s4640878_CAG_universe.h
+ * @author Mike Smith - 46408789
+ * @date 06052022
+ * @brief CAGUniverse - runtime sized, tiled cell storage (header file)
+ *        (board: nucleo-f401)
+ * REFERENCE: csse3010_project.pdf (spec sheet)
+ ***************************************************************
+ * EXTERNAL FUNCTIONS
+ ***************************************************************
+ * s4640878_lib_CAG_universe_create() - creates a universe
+ * s4640878_lib_CAG_universe_delete() - deletes a universe
+ * s4640878_lib_CAG_universe_clear() - kills every cell
+ * s4640878_lib_CAG_universe_get_cell() - gets the state value of a cell
+ * s4640878_lib_CAG_universe_set_cell() - sets the state value of a cell
+ * s4640878_lib_CAG_universe_step() - computes the next generation (packed)
+ * s4640878_lib_CAG_universe_step_reference() - computes the next generation (int)
+ * s4640878_lib_CAG_universe_write_begin() - starts writing a generation computed elsewhere
+ * s4640878_lib_CAG_universe_write_end() - ends it, counts the generations and looks for a cycle
+ * s4640878_lib_CAG_universe_step_begin() - starts a generation, lists the tiles to step
+ * s4640878_lib_CAG_universe_step_tiles() - steps a range of the listed tiles
+ * s4640878_lib_CAG_universe_step_end() - adds up the steppers and publishes the generation
+ * s4640878_lib_CAG_universe_stepper_init() - clears the counters of a stepper
+ * s4640878_lib_CAG_universe_get_bounds() - gets the bounding box of the live cells
+ * s4640878_lib_CAG_universe_get_changed() - gets the number of tiles that changed
+ * s4640878_lib_CAG_universe_get_population() - gets the number of live cells
+ * s4640878_lib_CAG_universe_get_still() - checks the last step moved no cell
+ * s4640878_lib_CAG_universe_get_hash() - gets the hash of the current generation
+ * s4640878_lib_CAG_universe_get_period() - gets the period of a detected cycle
+ * s4640878_lib_CAG_universe_get_stats() - gets population and activity counters
+ * s4640878_lib_CAG_universe_get_memory() - gets the bytes allocated for the universe
+ * s4640878_lib_CAG_universe_read_begin() - starts reading the published generation
+ * s4640878_lib_CAG_universe_read_cell() - gets the state value of a published cell
+ * s4640878_lib_CAG_universe_read_column() - gets 32 published cells of a column as plane words
+ * s4640878_lib_CAG_universe_read_end() - checks the published generation was intact
+ * s4640878_lib_CAG_universe_read_block() - gets the published cells that are not dead in a pyramid block
+ * s4640878_lib_CAG_universe_set_boundary() - selects the boundary mode
+ * s4640878_lib_CAG_universe_get_boundary() - gets the boundary mode
+ * s4640878_lib_CAG_universe_wrap() - maps a cell outside the universe to the cell it is joined to
+ * s4640878_lib_CAG_universe_compile_rule() - builds a rule from birth/survival counts and states
+ * s4640878_lib_CAG_universe_parse_rule() - builds a rule from a B/S[/C] rule string
+ * s4640878_lib_CAG_universe_format_rule() - writes a rule as a B/S[/C] rule string
+ * s4640878_lib_CAG_universe_set_rule() - selects the rule
+ * s4640878_lib_CAG_universe_set_kernel() - selects the packed tile kernel
+ * s4640878_lib_CAG_universe_get_kernel() - gets the packed tile kernel
+ ***************************************************************
+ */
+
+#ifndef S4640878_CAG_UNIVERSE_H_
+#define S4640878_CAG_UNIVERSE_H_
+
+#include <stdint.h>
+
+// tile size: a tile is CAG_TILE_BITS x CAG_TILE_BITS cells, one word per column
+// 16 on the board (one tile column is one board column), 64 on 64-bit hosts
+#ifndef CAG_TILE_BITS
+#if UINTPTR_MAX > 0xFFFFFFFFUL
+#define CAG_TILE_BITS 64
+#else
+#define CAG_TILE_BITS 16
+#endif
+#endif
+
+#if CAG_TILE_BITS == 64
+typedef uint64_t cag_word_t;
+#define CAG_TILE_SHIFT 6
+#elif CAG_TILE_BITS == 32
+typedef uint32_t cag_word_t;
+#define CAG_TILE_SHIFT 5
+#elif CAG_TILE_BITS == 16
+typedef uint16_t cag_word_t;
+#define CAG_TILE_SHIFT 4
+#else
+#error "CAG_TILE_BITS must be 16, 32 or 64"
+#endif
+
+// packed tile kernels: portable words, or on x86-64 hosts the columns of a
+// tile stepped 128 (sse2) or 256 (avx2) bits at a time, the best one the cpu
+// runs is picked when a universe is created (multi-state rules stay portable)
+#ifndef CAG_SIMD
+#if defined(__x86_64__) && defined(__GNUC__) && (CAG_TILE_BITS == 64)
+#define CAG_SIMD 1
+#else
+#define CAG_SIMD 0
+#endif
+#endif
+#define CAG_KERNEL_SCALAR 0
+#define CAG_KERNEL_SSE2 1
+#define CAG_KERNEL_AVX2 2
+
+// block lookup table kernels (any build): the life rule as a table of the next
+// cell of each 3x3 (512 bytes, for small memories) or of the next 2x2 block of
+// each 4x4 (64KB, a quarter of the lookups)
+#define CAG_KERNEL_LUT_3X3 3
+#define CAG_KERNEL_LUT_4X4 4
+
+// number of age bit-planes, state values saturate at (1 << CAG_AGE_PLANES)
+#ifndef CAG_AGE_PLANES
+#define CAG_AGE_PLANES 4
+#endif
+
+// plane 0 is the alive plane, planes 1.. hold (state value - 1)
+#define CAG_PLANES (CAG_AGE_PLANES + 1)
+#define CAG_AGE_MAX (1 << CAG_AGE_PLANES)
+
+// generation hashes kept for cycle detection, longest period found
+#ifndef CAG_HISTORY
+#define CAG_HISTORY 16
+#endif
+
+// population pyramid levels: level k counts the cells of blocks of
+// (CAG_TILE_BITS << k) cells a side, enough for 0xFFFF tiles a side
+#define CAG_PYRAMID_LEVELS 17
+
+// universe buffers: the published generation, the one before it (still safe
+// for readers that started on it) and the one being computed
+#define CAG_BUFFERS 3
+
+// boundary modes
+// dead: cells outside the universe are dead
+// torus: left/right and top/bottom edges are joined
+// klein: left/right joined, top/bottom joined mirrored (klein bottle)
+// cross: both pairs joined mirrored (cross-surface)
+#define CAG_BOUNDARY_DEAD 0
+#define CAG_BOUNDARY_TORUS 1
+#define CAG_BOUNDARY_KLEIN 2
+#define CAG_BOUNDARY_CROSS 3
+
+// default rule (conway's life) and longest rule string ("B12345678/S012345678/C16")
+#define CAG_RULE_DEFAULT "B3/S23"
+#define CAG_RULE_LEN 28
+
+// rule families
+// life: 2 states, live cells keep an age in the age planes
+// generations: B/S/C rules, live cells that do not survive decay through C - 2
+//      dying states (brian's brain B2/S/C3, star wars B2/S345/C4)
+// wireworld: empty, electron head, electron tail, conductor
+// multi-state cells keep their state in the fewest planes from plane 1 up, plane 0
+// marks state 1 (the state neighbours count), so the counting kernel is shared
+#define CAG_FAMILY_LIFE 0
+#define CAG_FAMILY_GENERATIONS 1
+#define CAG_FAMILY_WIREWORLD 2
+
+// wireworld states
+#define CAG_WIRE_EMPTY 0
+#define CAG_WIRE_HEAD 1
+#define CAG_WIRE_TAIL 2
+#define CAG_WIRE_CONDUCTOR 3
+
+// cells a rule term applies to
+#define CAG_RULE_DEAD 1
+#define CAG_RULE_ALIVE 2
+#define CAG_RULE_ANY 3
+
+// outer-totalistic (life-like) rule, compiled into the 3x3 totals (own cell
+// included) that give a live cell, so the kernel has no branches on the rule
+typedef struct caRule {
+    int family;                 // CAG_FAMILY_*
+    int states;                 // number of states (2 for life)
+    uint16_t birth;             // bit n: a dead cell with n live neighbours is born
+    uint16_t survive;           // bit n: a live cell with n live neighbours survives
+    int terms;                  // number of totals giving a live cell
+    uint8_t total[10];          // 3x3 total of each term
+    uint8_t select[10];         // CAG_RULE_DEAD, CAG_RULE_ALIVE or CAG_RULE_ANY
+} caRule_t;
+
+// one tile, bit y of plane[p][x] is plane p of cell (x, y) inside the tile
+typedef struct caTile {
+    cag_word_t plane[CAG_PLANES][CAG_TILE_BITS];
+} caTile_t;
+
+// working area for one tile step: columns -1..CAG_TILE_BITS of the tile,
+// shifted so bit y holds the cell above (up), at (mid) or below (down) row y
+typedef struct caScratch {
+    cag_word_t up[CAG_PLANES][CAG_TILE_BITS + 2];
+    cag_word_t mid[CAG_PLANES][CAG_TILE_BITS + 2];
+    cag_word_t down[CAG_PLANES][CAG_TILE_BITS + 2];
+} caScratch_t;
+
+// one thread stepping tiles: its working area, and what the tiles it stepped
+// changed, added into the universe by step_end
+typedef struct caStepper {
+    caScratch_t scratch;
+    uint64_t hash;              // xor of the hash changes
+    int births;
+    int deaths;
+    int changedCells;
+    uint32_t *changedList;      // slots of the tiles that changed
+    int changedCount;
+} caStepper_t;
+
+// bounding box in cells (inclusive), x0 > x1 when there is no live cell
+typedef struct caBounds {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+} caBounds_t;
+
+// population and activity of a generation
+// births, deaths and changed count the last step (and edits made after it)
+typedef struct caStats {
+    uint32_t generation;        // generations computed
+    int population;             // live cells (multi-state: cells in state 1)
+    int births;                 // cells that came alive (entered state 1)
+    int deaths;                 // cells that died (left state 1)
+    int changed;                // cells whose state changed (life ages excluded)
+    int period;                 // cycle period, 0 if none
+} caStats_t;
+
+// cellular automaton universe
+// tiles are stored in Morton (z-order) so neighbouring tiles are close in memory
+// only tiles that changed, and their neighbours, are recomputed each step:
+// a tile that did not change in the last two steps holds the same cells in every buffer
+// one task steps and edits the universe, other tasks read it with read_begin/read_end
+typedef struct caUniverse {
+    int width;                  // width in cells
+    int height;                 // height in cells
+    int tilesX;                 // width in tiles
+    int tilesY;                 // height in tiles
+    int tileCount;              // number of tiles
+    uint32_t *tileSlot;         // (ty * tilesX + tx) -> storage slot
+    uint16_t *slotX;            // storage slot -> tile x
+    uint16_t *slotY;            // storage slot -> tile y
+    int32_t *neighbourSlot;     // storage slot -> 8 neighbour slots (-1: none)
+    caTile_t *tiles[CAG_BUFFERS];       // tile storage per buffer
+    uint8_t *occupied[CAG_BUFFERS];     // tile has a live cell, per buffer
+    int current;                // buffer holding the current generation
+    volatile uint32_t published;    // (generation sequence << 3) | editing flag | current, for readers
+    int writing;                // nesting depth of edits of the published generation
+    uint8_t *changed;           // tile changed since the previous generation
+    uint32_t *changedList;      // slots with changed set
+    int changedCount;
+    uint32_t *previousList;     // slots changed in the step before (stale in the next buffer)
+    int previousCount;
+    uint32_t *work;             // slots to recompute in the current step
+    uint32_t *visit;            // step stamp per slot (already in work)
+    uint32_t stamp;
+    uint8_t *tileBounds;        // per slot: x0, x1, y0, y1 of the live cells in the tile, recomputed
+                                // by get_bounds after an edit
+    uint32_t *pyramid[CAG_BUFFERS][CAG_PYRAMID_LEVELS];    // per buffer and level: cells that are not
+                                // dead per block (row major, level 0 per tile), kept up to date by
+                                // steps and edits
+    int pyramidLevels;          // levels down to a single block
+    caBounds_t bounds;          // live cells of the universe (valid if boundsValid)
+    int boundsValid;
+    int boundary;               // boundary mode
+    caRule_t rule;              // rule used by both engines
+    int kernel;                 // packed tile kernel (CAG_KERNEL_*)
+    uint8_t *lut;               // table of the block kernel built from the rule, NULL for the others
+    uint8_t stateTable[256];    // multi-state: next state of [(state << 4) | 3x3 total of state 1]
+    int statePlanes;            // multi-state: planes holding the state
+    cag_word_t *haloWest;       // column -1 per plane and tile row ([p * tilesY + ty])
+    cag_word_t *haloEast;       // column width per plane and tile row
+    uint8_t *haloNorth;         // row -1 for columns -1..width, bit p is plane p
+    uint8_t *haloSouth;         // row height for columns -1..width
+    uint32_t *edgeList;         // slots of the tiles on the universe edge
+    int edgeCount;
+    uint32_t generation;        // generations computed
+    uint64_t hash;              // zobrist-style hash of the current cells (ages excluded)
+    uint64_t history[CAG_HISTORY];  // hashes of the last generations, newest at historyHead
+    int historyHead;
+    int historyCount;
+    int period;                 // cycle period found by the last step, 0 if none
+    int population;             // live cells, kept up to date by steps and edits
+    int births;                 // counters of the last step, see caStats_t
+    int deaths;
+    int changedCells;
+    caStepper_t stepper;        // working area of the serial step
+} caUniverse_t;
+
+// external function declarations
+caUniverse_t *s4640878_lib_CAG_universe_create(int width, int height);
+void s4640878_lib_CAG_universe_delete(caUniverse_t *universe);
+void s4640878_lib_CAG_universe_clear(caUniverse_t *universe);
+int s4640878_lib_CAG_universe_get_cell(caUniverse_t *universe, int x, int y);
+void s4640878_lib_CAG_universe_set_cell(caUniverse_t *universe, int x, int y, int value);
+void s4640878_lib_CAG_universe_step(caUniverse_t *universe);
+void s4640878_lib_CAG_universe_step_reference(caUniverse_t *universe);
+uint64_t s4640878_lib_CAG_universe_write_begin(caUniverse_t *universe);
+void s4640878_lib_CAG_universe_write_end(caUniverse_t *universe, uint64_t before, uint32_t generations);
+int s4640878_lib_CAG_universe_step_begin(caUniverse_t *universe);
+void s4640878_lib_CAG_universe_step_tiles(caUniverse_t *universe, caStepper_t *stepper, int first, int count);
+void s4640878_lib_CAG_universe_step_end(caUniverse_t *universe, caStepper_t **steppers, int count);
+void s4640878_lib_CAG_universe_stepper_init(caStepper_t *stepper, uint32_t *changedList);
+int s4640878_lib_CAG_universe_get_bounds(caUniverse_t *universe, caBounds_t *bounds);
+int s4640878_lib_CAG_universe_get_changed(caUniverse_t *universe);
+int s4640878_lib_CAG_universe_get_population(caUniverse_t *universe);
+int s4640878_lib_CAG_universe_get_still(caUniverse_t *universe);
+uint64_t s4640878_lib_CAG_universe_get_hash(caUniverse_t *universe);
+int s4640878_lib_CAG_universe_get_period(caUniverse_t *universe);
+void s4640878_lib_CAG_universe_get_stats(caUniverse_t *universe, caStats_t *stats);
+uint32_t s4640878_lib_CAG_universe_get_memory(caUniverse_t *universe);
+uint32_t s4640878_lib_CAG_universe_read_begin(caUniverse_t *universe);
+int s4640878_lib_CAG_universe_read_cell(caUniverse_t *universe, uint32_t ticket, int x, int y);
+void s4640878_lib_CAG_universe_read_column(caUniverse_t *universe, uint32_t ticket, int x, int y, uint32_t *planes);
+int s4640878_lib_CAG_universe_read_end(caUniverse_t *universe, uint32_t ticket);
+uint32_t s4640878_lib_CAG_universe_read_block(caUniverse_t *universe, uint32_t ticket, int level, int x, int y);
+void s4640878_lib_CAG_universe_set_boundary(caUniverse_t *universe, int boundary);
+int s4640878_lib_CAG_universe_get_boundary(caUniverse_t *universe);
+int s4640878_lib_CAG_universe_wrap(caUniverse_t *universe, int *x, int *y);
+int s4640878_lib_CAG_universe_compile_rule(caRule_t *rule, int family, uint16_t birth, uint16_t survive, int states);
+int s4640878_lib_CAG_universe_parse_rule(caRule_t *rule, const char *string);
+void s4640878_lib_CAG_universe_format_rule(const caRule_t *rule, char *string);
+void s4640878_lib_CAG_universe_set_rule(caUniverse_t *universe, const caRule_t *rule);
+int s4640878_lib_CAG_universe_set_kernel(caUniverse_t *universe, int kernel);
+int s4640878_lib_CAG_universe_get_kernel(caUniverse_t *universe);
+
+#endif
@@ -16,6 +16,9 @@
 
 #include "s4640878_cli_CAG_mnemonic.h"
 #include "s4640878_CAG_joystick.h"
+#include "s4640878_CAG_bench.h"
+#include "s4640878_CAG_display.h"
+#include "s4640878_oled.h"
 #include "board.h"
 #include "processor_hal.h"
 #include "task.h"
@@ -23,6 +26,18 @@
 
 #define BUF_LEN 50
 
+// longest wait for a batch run before the command returns without its result
+#define BATCH_WAIT_MS 60000
+
+// bench command: most generations per case, longest time a case holds off the
+// other tasks, and the longest gap between the calls of one command
+#define BENCH_MAX_GENERATIONS 10000
+#define BENCH_LIMIT_MS 250
+#define BENCH_RESUME_MS 1000
+
+// packed tile kernel names (CAG_KERNEL_*)
+static const char *kernelName[] = {"scalar", "sse2", "avx2", "lut 3x3", "lut 4x4"};
+
 // echo command
 CLI_Command_Definition_t xEcho = {
     "echo",
@@ -34,7 +49,7 @@ CLI_Command_Definition_t xEcho = {
 // cell command
 CLI_Command_Definition_t xCell = {
     "cell", 
-    "cell <type><x><y>: Draw a cell. dead(0), alive(1), \r\n\r\n",
+    "cell <type><x><y>: Draw a cell. dead(0), alive(1), state(2-15) for generations and wireworld rules.\r\n\r\n",
     prvCellCommand,
     3
 };
@@ -79,6 +94,126 @@ CLI_Command_Definition_t xStop = {
     0
 };
 
+// rule command
+CLI_Command_Definition_t xRule = {
+    "rule", 
+    "rule <B/S[/C]>: Set the rule, e.g. B3/S23 (life), B36/S23 (highlife), B2/S (seeds), B2/S/C3 (brian's brain), WireWorld.\r\n\r\n",
+    prvRuleCommand,
+    1
+};
+
+// jump command
+CLI_Command_Definition_t xJump = {
+    "jump", 
+    "jump <k>: Advance 2^k generations at once (hashlife), k 0..30.\r\n\r\n",
+    prvJumpCommand,
+    1
+};
+
+// edge command
+CLI_Command_Definition_t xEdge = {
+    "edge", 
+    "edge <type>: Set the boundary. dead(0), torus(1), klein bottle(2), cross-surface(3).\r\n\r\n",
+    prvEdgeCommand,
+    1
+};
+
+// engine command
+CLI_Command_Definition_t xEngine = {
+    "engine", 
+    "engine <type>: Set the simulation engine. int(0), packed(1), parallel(2, hosts), bytes(3), sparse(4).\r\n\r\n",
+    prvEngineCommand,
+    1
+};
+
+// kernel command
+CLI_Command_Definition_t xKernel = {
+    "kernel", 
+    "kernel <type>: Set the packed tile kernel of the simulator and bench. scalar(0), sse2(1, hosts), avx2(2, hosts), lut 3x3(3), lut 4x4(4).\r\n\r\n",
+    prvKernelCommand,
+    1
+};
+
+// interval command
+CLI_Command_Definition_t xInterval = {
+    "interval", 
+    "interval <ms>: Set the time between generations (1 to 10000 ms).\r\n\r\n",
+    prvIntervalCommand,
+    1
+};
+
+// jitter command
+CLI_Command_Definition_t xJitter = {
+    "jitter", 
+    "jitter: Measured time between generations (us) since the simulation was started.\r\n\r\n",
+    prvJitterCommand,
+    0
+};
+
+// oled command
+CLI_Command_Definition_t xOled = {
+    "oled", 
+    "oled: Display frames, the frames that changed the panel, the bytes written and the transfer times (us) and errors.\r\n\r\n",
+    prvOledCommand,
+    0
+};
+
+// fps command
+CLI_Command_Definition_t xFps = {
+    "fps", 
+    "fps <n>: Set the highest display frame rate (1 to 50).\r\n\r\n",
+    prvFpsCommand,
+    1
+};
+
+// frames command
+CLI_Command_Definition_t xFrames = {
+    "frames", 
+    "frames: Display refresh requests, frames drawn, requests merged into a frame and generations not shown.\r\n\r\n",
+    prvFramesCommand,
+    0
+};
+
+// step command
+CLI_Command_Definition_t xStep = {
+    "step", 
+    "step <n>: Compute n generations as fast as possible and report generations/s.\r\n\r\n",
+    prvStepCommand,
+    1
+};
+
+// until command
+CLI_Command_Definition_t xUntil = {
+    "until", 
+    "until <type><population><max>: Compute up to max generations until: empty(1), stable(2), population reached(3), cycle(4).\r\n\r\n",
+    prvUntilCommand,
+    3
+};
+
+// cycle command
+CLI_Command_Definition_t xCycle = {
+    "cycle", 
+    "cycle <mode>: Show the period of a detected cycle. auto-pause off(0), on(1).\r\n\r\n",
+    prvCycleCommand,
+    1
+};
+
+// stats command
+CLI_Command_Definition_t xStats = {
+    "stats", 
+    "stats: Generation, population and the births, deaths and changed cells of the last step.\r\n\r\n",
+    prvStatsCommand,
+    0
+};
+
+// bench command
+CLI_Command_Definition_t xBench = {
+    "bench", 
+    "bench <n>: Time every engine for n generations (1..10000, at most 250ms each) on the benchmark seeds and sizes, one CSV row per run.\r\n\r\n",
+    prvBenchCommand,
+    1
+};
+
 // clear command
 CLI_Command_Definition_t xClear = {
     "clear", 
@@ -128,6 +263,21 @@ void s4640878_cli_CAG_mnemonic_init(void) {
     FreeRTOS_CLIRegisterCommand(&xGlider);
     FreeRTOS_CLIRegisterCommand(&xStart);
     FreeRTOS_CLIRegisterCommand(&xStop);
+    FreeRTOS_CLIRegisterCommand(&xRule);
+    FreeRTOS_CLIRegisterCommand(&xJump);
+    FreeRTOS_CLIRegisterCommand(&xEdge);
+    FreeRTOS_CLIRegisterCommand(&xEngine);
+    FreeRTOS_CLIRegisterCommand(&xKernel);
+    FreeRTOS_CLIRegisterCommand(&xInterval);
+    FreeRTOS_CLIRegisterCommand(&xJitter);
+    FreeRTOS_CLIRegisterCommand(&xOled);
+    FreeRTOS_CLIRegisterCommand(&xFps);
+    FreeRTOS_CLIRegisterCommand(&xFrames);
+    FreeRTOS_CLIRegisterCommand(&xStep);
+    FreeRTOS_CLIRegisterCommand(&xUntil);
+    FreeRTOS_CLIRegisterCommand(&xCycle);
+    FreeRTOS_CLIRegisterCommand(&xStats);
+    FreeRTOS_CLIRegisterCommand(&xBench);
     FreeRTOS_CLIRegisterCommand(&xClear);
     FreeRTOS_CLIRegisterCommand(&xDel);
     FreeRTOS_CLIRegisterCommand(&xCre);
@@ -172,7 +322,8 @@ static BaseType_t prvCellCommand(char *pcWriteBuffer, size_t xWriteBufferLen, co
             caMsg.type = (CELL << 4) | ALIVE;
             break;
         default: 
-            caMsg.type = 0;
+            // multi-state rules, the simulator clamps to the last state
+            caMsg.type = ((type > ALIVE) && (type <= 0xF)) ? ((CELL << 4) | type) : 0;
     }
 
     // sends msg through queue
@@ -289,6 +440,378 @@ static BaseType_t prvStopCommand(char *pcWriteBuffer, size_t xWriteBufferLen, co
     return pdFALSE;
 }
 
+// rule command
+static BaseType_t prvRuleCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    long lRuleLen;
+    const char *cRule;
+    char cRuleString[CAG_RULE_LEN];
+    caRule_t rule;
+
+    // get parameters from command string
+    cRule = FreeRTOS_CLIGetParameter(pcCommandString, 1, &lRuleLen);
+    if ((lRuleLen >= CAG_RULE_LEN) || (lRuleLen <= 0)) {
+        xWriteBufferLen = sprintf((char*) pcWriteBuffer, "invalid rule\n\r\n\r");
+        return pdFALSE;
+    }
+    strncpy(cRuleString, cRule, lRuleLen);
+    cRuleString[lRuleLen] = '\0';
+
+    // checks the rule string before sending the masks with the family and states
+    if (s4640878_lib_CAG_universe_parse_rule(&rule, cRuleString) != 0) {
+        xWriteBufferLen = sprintf((char*) pcWriteBuffer, "invalid rule\n\r\n\r");
+        return pdFALSE;
+    }
+    caMsg.cell_x = rule.birth | (rule.family << RULE_SHIFT);
+    caMsg.cell_y = rule.survive | (rule.states << RULE_SHIFT);
+    caMsg.type = (RULE << 4);
+
+    // sends msg through queue
+    xQueueSendToFront(s4640878QueueCAGMnemonic, (void*)&caMsg, (portTickType)10);
+    s4640878_lib_CAG_universe_format_rule(&rule, cRuleString);
+    xWriteBufferLen = sprintf((char*) pcWriteBuffer, "%s\n\r\n\r", cRuleString);
+    return pdFALSE;
+}
+
+// jump command
+static BaseType_t prvJumpCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    long lKLen;
+    const char *cK;
+
+    caBatch_t result;
+
+    // get parameters from command string
+    cK = FreeRTOS_CLIGetParameter(pcCommandString, 1, &lKLen);
+    int k = atoi(cK);
+    if ((k < 0) || (k > JUMP_MAX) || (s4640878SemaphoreCAGBatch == NULL)) {
+        xWriteBufferLen = sprintf((char*) pcWriteBuffer, "invalid jump\n\r\n\r");
+        return pdFALSE;
+    }
+    xSemaphoreTake(s4640878SemaphoreCAGBatch, 0);   // drops the result of a timed out run
+
+    // create jump of 2^k generations
+    caMsg.cell_x = k;
+    caMsg.cell_y = 0;
+    caMsg.type = (JUMP << 4);
+
+    // sends msg through queue and waits for the simulator to finish
+    xQueueSendToFront(s4640878QueueCAGMnemonic, (void*)&caMsg, (portTickType)10);
+    if (xSemaphoreTake(s4640878SemaphoreCAGBatch, BATCH_WAIT_MS / portTICK_PERIOD_MS) != pdTRUE) {
+        xWriteBufferLen = sprintf((char*) pcWriteBuffer, "jump still running\n\r\n\r");
+        return pdFALSE;
+    }
+    if (s4640878_lib_CAG_simulator_get_jump() != CAG_HASHLIFE_OK) {
+        xWriteBufferLen = sprintf((char*) pcWriteBuffer, "jump not run\n\r\n\r");
+        return pdFALSE;
+    }
+    s4640878_lib_CAG_simulator_get_batch(&result);
+    xWriteBufferLen = sprintf((char*) pcWriteBuffer, "%lu generations in %lu ms\n\r\n\r",
+            (unsigned long)result.generations, (unsigned long)result.ms);
+    return pdFALSE;
+}
+
+// edge command
+static BaseType_t prvEdgeCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    long lTypeLen;
+    const char *cType;
+
+    // get parameters from command string, a number (atoi reads a word as 0)
+    cType = FreeRTOS_CLIGetParameter(pcCommandString, 1, &lTypeLen);
+    int type = atoi(cType);
+    if ((cType[0] < '0') || (cType[0] > '9') || (type < CAG_BOUNDARY_DEAD) || (type > CAG_BOUNDARY_CROSS)) {
+        xWriteBufferLen = sprintf((char*) pcWriteBuffer, "invalid edge\n\r\n\r");
+        return pdFALSE;
+    }
+
+    // create boundary mode change
+    caMsg.cell_x = type;
+    caMsg.cell_y = 0;
+    caMsg.type = (BOUNDARY << 4);
+
+    // sends msg through queue
+    xQueueSendToFront(s4640878QueueCAGMnemonic, (void*)&caMsg, (portTickType)10);
+    xWriteBufferLen = sprintf((char*) pcWriteBuffer, "\n\r");   // clears the write buffer
+    return pdFALSE;
+}
+
+// engine command
+static BaseType_t prvEngineCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    long lTypeLen;
+    const char *cType;
+
+    // get parameters from command string, a number (atoi reads a word as 0)
+    cType = FreeRTOS_CLIGetParameter(pcCommandString, 1, &lTypeLen);
+    int type = atoi(cType);
+    if ((cType[0] < '0') || (cType[0] > '9')
+            || ((type != CAG_ENGINE_INT) && (type != CAG_ENGINE_PACKED) && (type != CAG_ENGINE_BYTES)
+            && (type != CAG_ENGINE_SPARSE) && !(CAG_PARALLEL && (type == CAG_ENGINE_PARALLEL)))) {
+        xWriteBufferLen = sprintf((char*) pcWriteBuffer, "invalid engine\n\r\n\r");
+        return pdFALSE;
+    }
+
+    // create engine change
+    caMsg.cell_x = type;
+    caMsg.cell_y = 0;
+    caMsg.type = (ENGINE << 4);
+
+    // sends msg through queue
+    xQueueSendToFront(s4640878QueueCAGMnemonic, (void*)&caMsg, (portTickType)10);
+    xWriteBufferLen = sprintf((char*) pcWriteBuffer, "\n\r");   // clears the write buffer
+    return pdFALSE;
+}
+
+// kernel command
+static BaseType_t prvKernelCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    long lTypeLen;
+    const char *cType;
+
+    // get parameters from command string, a number (atoi reads a word as 0)
+    cType = FreeRTOS_CLIGetParameter(pcCommandString, 1, &lTypeLen);
+    int type = atoi(cType);
+    if ((cType[0] < '0') || (cType[0] > '9') || (type < CAG_KERNEL_SCALAR) || (type > CAG_KERNEL_LUT_4X4)
+            || (s4640878SemaphoreCAGBatch == NULL)) {
+        xWriteBufferLen = sprintf((char*) pcWriteBuffer, "invalid kernel\n\r\n\r");
+        return pdFALSE;
+    }
+    xSemaphoreTake(s4640878SemaphoreCAGBatch, 0);   // drops the result of a timed out run
+
+    // create kernel change
+    caMsg.cell_x = type;
+    caMsg.cell_y = 0;
+    caMsg.type = (KERNEL << 4);
+
+    // sends msg through queue and waits for the simulator to select it
+    xQueueSendToFront(s4640878QueueCAGMnemonic, (void*)&caMsg, (portTickType)10);
+    caUniverse_t *universe = s4640878_lib_CAG_simulator_get_universe();
+    if ((xSemaphoreTake(s4640878SemaphoreCAGBatch, BATCH_WAIT_MS / portTICK_PERIOD_MS) != pdTRUE) || (universe == NULL)) {
+        xWriteBufferLen = sprintf((char*) pcWriteBuffer, "kernel not set\n\r\n\r");
+        return pdFALSE;
+    }
+
+    // the bench runs after it use the kernel the simulator got
+    type = s4640878_lib_CAG_universe_get_kernel(universe);
+    s4640878_lib_CAG_bench_set_kernel(type);
+    xWriteBufferLen = sprintf((char*) pcWriteBuffer, "kernel %s\n\r\n\r", kernelName[type]);
+    return pdFALSE;
+}
+
+// interval command
+static BaseType_t prvIntervalCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    long lMsLen;
+    const char *cMs;
+
+    // get parameters from command string
+    cMs = FreeRTOS_CLIGetParameter(pcCommandString, 1, &lMsLen);
+    int ms = atoi(cMs);
+    if ((ms < CAG_SIMULATOR_INTERVAL_MIN_MS) || (ms > CAG_SIMULATOR_INTERVAL_MAX_MS)) {
+        xWriteBufferLen = sprintf((char*) pcWriteBuffer, "invalid interval\n\r\n\r");
+        return pdFALSE;
+    }
+
+    // create interval change
+    caMsg.cell_x = ms;
+    caMsg.cell_y = 0;
+    caMsg.type = (INTERVAL << 4);
+
+    // sends msg through queue
+    xQueueSendToFront(s4640878QueueCAGMnemonic, (void*)&caMsg, (portTickType)10);
+    xWriteBufferLen = sprintf((char*) pcWriteBuffer, "\n\r");   // clears the write buffer
+    return pdFALSE;
+}
+
+// jitter command
+static BaseType_t prvJitterCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    caTiming_t timing;
+
+    // times are measured by the simulator task as it runs
+    s4640878_lib_CAG_simulator_get_timing(&timing);
+    xWriteBufferLen = sprintf((char*) pcWriteBuffer, "interval %lums generations %lu min %lu max %lu mean %lu jitter %lu mean jitter %lu late %lu (us)\n\r\n\r",
+            (unsigned long)timing.intervalMs, (unsigned long)timing.generations, (unsigned long)timing.minUs,
+            (unsigned long)timing.maxUs, (unsigned long)timing.meanUs, (unsigned long)timing.jitterUs,
+            (unsigned long)timing.meanJitterUs, (unsigned long)timing.late);
+    return pdFALSE;
+}
+
+// oled command
+static BaseType_t prvOledCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    struct oledStats stats;
+
+    // bytes written, and what writing every frame whole would have taken
+    s4640878_reg_oled_get_stats(&stats);
+    uint32_t meanUs = (stats.changed > 0) ? stats.transferUs / stats.changed : 0;
+    xWriteBufferLen = sprintf((char*) pcWriteBuffer, "frames %lu changed %lu runs %lu bytes %lu (whole %lu) transfer %lu max %lu us errors %lu %lukHz\n\r\n\r",
+            (unsigned long)stats.updates, (unsigned long)stats.changed, (unsigned long)stats.runs,
+            (unsigned long)stats.bytes, (unsigned long)stats.updates * OLED_FULL_UPDATE_BYTES,
+            (unsigned long)meanUs, (unsigned long)stats.maxTransferUs, (unsigned long)stats.errors,
+            (unsigned long)OLED_I2C_SPEED / 1000);
+    return pdFALSE;
+}
+
+// fps command
+static BaseType_t prvFpsCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    long lFpsLen;
+    const char *cFps;
+
+    // get parameters from command string
+    cFps = FreeRTOS_CLIGetParameter(pcCommandString, 1, &lFpsLen);
+    int fps = atoi(cFps);
+    if ((fps < CAG_DISPLAY_FPS_MIN) || (fps > CAG_DISPLAY_FPS_MAX)) {
+        xWriteBufferLen = sprintf((char*) pcWriteBuffer, "invalid frame rate\n\r\n\r");
+        return pdFALSE;
+    }
+
+    // the display task reads it before each frame
+    s4640878_lib_CAG_display_set_fps(fps);
+    xWriteBufferLen = sprintf((char*) pcWriteBuffer, "\n\r");   // clears the write buffer
+    return pdFALSE;
+}
+
+// frames command
+static BaseType_t prvFramesCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    caDisplayStats_t stats;
+
+    // counted by the display task and the tasks requesting frames
+    s4640878_lib_CAG_display_get_stats(&stats);
+    xWriteBufferLen = sprintf((char*) pcWriteBuffer, "requests %lu frames %lu merged %lu generations not shown %lu (at most %dfps)\n\r\n\r",
+            (unsigned long)stats.requests, (unsigned long)stats.frames, (unsigned long)stats.merged,
+            (unsigned long)stats.skipped, stats.fps);
+    return pdFALSE;
+}
+
+// sends a batch run and writes its result: generations, time and generations/s
+static void CAG_mnemonic_batch(char *pcWriteBuffer, int condition, int generations, int target) {
+    static const char *reasons[] = {"done", "empty", "stable", "population reached", "cycle"};
+    caBatch_t result;
+
+    if ((generations <= 0) || (condition < BATCH_COUNT) || (condition > BATCH_CYCLE)
+            || (s4640878SemaphoreCAGBatch == NULL)) {
+        sprintf((char*) pcWriteBuffer, "invalid batch\n\r\n\r");
+        return;
+    }
+    xSemaphoreTake(s4640878SemaphoreCAGBatch, 0);   // drops the result of a timed out run
+
+    // create batch run
+    caMsg.cell_x = generations;
+    caMsg.cell_y = target;
+    caMsg.type = (BATCH << 4) | condition;
+
+    // sends msg through queue and waits for the simulator to finish
+    xQueueSendToFront(s4640878QueueCAGMnemonic, (void*)&caMsg, (portTickType)10);
+    if (xSemaphoreTake(s4640878SemaphoreCAGBatch, BATCH_WAIT_MS / portTICK_PERIOD_MS) != pdTRUE) {
+        sprintf((char*) pcWriteBuffer, "batch still running\n\r\n\r");
+        return;
+    }
+    s4640878_lib_CAG_simulator_get_batch(&result);
+    uint32_t rate = (result.ms > 0) ? (uint32_t)((uint64_t)result.generations * 1000 / result.ms) : 0;
+    sprintf((char*) pcWriteBuffer, "%lu generations in %lu ms, %lu gen/s (%s)\n\r\n\r",
+            (unsigned long)result.generations, (unsigned long)result.ms, (unsigned long)rate, reasons[result.reason]);
+}
+
+// step command
+static BaseType_t prvStepCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    long lNLen;
+    const char *cN;
+
+    // get parameters from command string
+    cN = FreeRTOS_CLIGetParameter(pcCommandString, 1, &lNLen);
+
+    CAG_mnemonic_batch(pcWriteBuffer, BATCH_COUNT, atoi(cN), 0);
+    return pdFALSE;
+}
+
+// until command
+static BaseType_t prvUntilCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    long lTypeLen, lPopulationLen, lMaxLen;
+    const char *cType, *cPopulation, *cMax;
+
+    // get parameters from command string
+    cType = FreeRTOS_CLIGetParameter(pcCommandString, 1, &lTypeLen);
+    cPopulation = FreeRTOS_CLIGetParameter(pcCommandString, 2, &lPopulationLen);
+    cMax = FreeRTOS_CLIGetParameter(pcCommandString, 3, &lMaxLen);
+
+    int type = atoi(cType);
+    CAG_mnemonic_batch(pcWriteBuffer, (type == BATCH_COUNT) ? -1 : type, atoi(cMax), atoi(cPopulation));
+    return pdFALSE;
+}
+
+// cycle command
+static BaseType_t prvCycleCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    long lModeLen;
+    const char *cMode;
+
+    // get parameters from command string
+    cMode = FreeRTOS_CLIGetParameter(pcCommandString, 1, &lModeLen);
+    int mode = atoi(cMode);
+    s4640878_lib_CAG_simulator_set_autopause(mode);
+
+    // period 1 is a still universe, 0 means no repeat within the hash history
+    int period = s4640878_lib_CAG_simulator_get_period();
+    if (period > 0) {
+        xWriteBufferLen = sprintf((char*) pcWriteBuffer, "period %d, auto-pause %s\n\r\n\r", period, mode ? "on" : "off");
+    } else {
+        xWriteBufferLen = sprintf((char*) pcWriteBuffer, "no cycle, auto-pause %s\n\r\n\r", mode ? "on" : "off");
+    }
+    return pdFALSE;
+}
+
+// stats command
+static BaseType_t prvStatsCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    caStats_t stats;
+
+    // counters are kept by the engine, nothing is scanned here
+    s4640878_lib_CAG_simulator_get_stats(&stats);
+    xWriteBufferLen = sprintf((char*) pcWriteBuffer, "generation %lu population %d births %d deaths %d changed %d period %d\n\r\n\r",
+            (unsigned long)stats.generation, stats.population, stats.births, stats.deaths, stats.changed, stats.period);
+    return pdFALSE;
+}
+
+// bench command
+// called once per output line: the CSV header, then one benchmark case per call
+static BaseType_t prvBenchCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
+    static int benchCase = -1;      // next case, -1 for the header
+    static TickType_t benchTick;    // when the last case was written
+    caBenchResult_t result;
+    long lNLen;
+    const char *cN;
+
+    // get parameters from command string
+    cN = FreeRTOS_CLIGetParameter(pcCommandString, 1, &lNLen);
+    int generations = atoi(cN);
+
+    // the cases of one command follow each other at once, a later call is a new
+    // command (the one before was cut short)
+    if ((xTaskGetTickCount() - benchTick) > (BENCH_RESUME_MS / portTICK_PERIOD_MS)) {
+        benchCase = -1;
+    }
+    if (benchCase < 0) {
+        if ((generations <= 0) || (generations > BENCH_MAX_GENERATIONS)) {
+            sprintf((char*) pcWriteBuffer, "invalid bench\n\r\n\r");
+            return pdFALSE;
+        }
+        int len = s4640878_lib_CAG_bench_format_header(pcWriteBuffer);
+        sprintf(pcWriteBuffer + len, "\n\r");
+        benchCase = 0;
+        benchTick = xTaskGetTickCount();
+        return pdTRUE;
+    }
+
+    // other tasks are held off so only the engine is timed, for at most
+    // BENCH_LIMIT_MS per case (the generations column shows how many ran)
+    s4640878_lib_CAG_bench_set_limit(BENCH_LIMIT_MS);
+    vTaskSuspendAll();
+    s4640878_lib_CAG_bench_run_case(&result, benchCase, generations);
+    xTaskResumeAll();
+    benchTick = xTaskGetTickCount();
+
+    int len = s4640878_lib_CAG_bench_format(&result, pcWriteBuffer);
+    if (++benchCase < CAG_BENCH_CASES) {
+        sprintf(pcWriteBuffer + len, "\n\r");
+        return pdTRUE;
+    }
+    sprintf(pcWriteBuffer + len, "\n\r\n\r");
+    benchCase = -1;
+    return pdFALSE;
+}
+
 // clear command
 static BaseType_t prvClearCommand(char *pcWriteBuffer, size_t xWriteBufferLen, const char *pcCommandString) {
     // sets the event bit to clear display
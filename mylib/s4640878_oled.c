@@ -14,12 +14,16 @@
  ***************************************************************
  * s4640878_reg_oled_init() - initialise the oled
  * s4640878_tsk_oled_init() - created controlling task for the oled
+ * s4640878_reg_oled_update() - writes the parts of a frame that differ from the panel
+ * s4640878_reg_oled_invalidate() - makes the next update write the whole frame
+ * s4640878_reg_oled_get_stats() - gets the updates and bytes written to the panel
  *************************************************************** 
  */
 
 #include "s4640878_oled.h"
 #include "board.h"
 #include "processor_hal.h"
+#include <string.h>
 
 // i2c definitions
 #define I2C_SDA 9
@@ -27,11 +31,73 @@
 #define I2C_GPIO GPIOB
 #define I2C_GPIO_AF GPIO_AF4_I2C1
 #define I2C_GPIO_CLK() __GPIOB_CLK_ENABLE()
-#define I2C_CLK_SPEED 100000
+#define I2C_CLK_SPEED OLED_I2C_SPEED
+
+// ssd1306 i2c address (write) and control bytes: the rest of the transaction
+// is commands, or data
+#define SSD1306_ADDRESS 0x78
+#define SSD1306_CONTROL_COMMANDS 0x00
+#define SSD1306_CONTROL_DATA 0x40
+
+// ssd1306 commands (horizontal addressing: the data fills a window of
+// columns and pages left to right, then top to bottom)
+#define SSD1306_ADDRESSING_MODE 0x20
+#define SSD1306_HORIZONTAL 0x00
+#define SSD1306_COLUMN_ADDRESS 0x21
+#define SSD1306_PAGE_ADDRESS 0x22
+
+// a transfer is a list of i2c transactions, each its length (2 bytes, little
+// endian), the control byte and the commands or data. on the bus each one also
+// has the address byte
+#define TRANSACTION_HEADER 2
+
+// a whole frame: the addressing commands, then the data
+#define WHOLE_COMMANDS 8
+#define WHOLE_TRANSFER (2 * (TRANSACTION_HEADER + 1) + WHOLE_COMMANDS + OLED_FRAME_BYTES)
+
+// unchanged columns between two changed ones that are written rather than
+// starting a new run (a new run costs a column window transaction: address,
+// control and 3 commands, and the address and control of its data)
+#define RUN_GAP 7
+
+// longest wait for a transfer before the bus is reset
+#define TRANSFER_WAIT_MS 100
+
+// the board sends with dma (i2c1 tx: dma1 stream 6 channel 1) and times with the
+// dwt cycle counter, elsewhere the transactions go through the ssd1306 driver
+#ifdef DMA1_Stream6
+#define OLED_DMA 1
+#define OLED_DMA_STREAM DMA1_Stream6
+#define OLED_DMA_CLEAR (DMA_HIFCR_CTCIF6 | DMA_HIFCR_CHTIF6 | DMA_HIFCR_CTEIF6 | DMA_HIFCR_CDMEIF6 | DMA_HIFCR_CFEIF6)
+#define OLED_I2C_ERRORS (I2C_SR1_BERR | I2C_SR1_ARLO | I2C_SR1_AF | I2C_SR1_OVR | I2C_SR1_TIMEOUT)
+#else
+#define OLED_DMA 0
+#endif
+#ifndef DWT
+#include <time.h>
+#endif
 
 // internal function declarations
 void s4640878TaskOled(void);
 void oled_draw_boundary_box(void);
+int oled_build_whole(uint8_t *wire, const uint8_t *frame);
+int oled_build_runs(uint8_t *wire, const uint8_t *frame);
+uint8_t *oled_transaction(uint8_t *wire, int control, int length);
+void oled_send(uint8_t *wire, int length);
+void oled_wait(void);
+void oled_done(int error);
+uint32_t oled_clock(void);
+
+static uint8_t oledShown[OLED_FRAME_BYTES];     // what the panel shows once the transfers are done
+static volatile int oledShownValid = 0;         // 0 until the panel has been written whole
+static uint8_t oledWire[2][WHOLE_TRANSFER];     // transfer being built, and the one on the bus
+static int oledBuild = 0;
+static volatile int oledBusy = 0;               // a transfer is on the bus
+static volatile uint8_t *oledNext;              // its next transaction, and its end
+static volatile uint8_t *oledEnd;
+static uint32_t oledStart;                      // clock at the start of the transfer
+static TaskHandle_t oledWaiter = NULL;          // task to notify when it is done
+static struct oledStats oledStats;
 
 // initialise oled with i2c interface
 void s4640878_reg_oled_init(void) {
@@ -88,7 +154,319 @@ void s4640878_reg_oled_init(void) {
     
     // ssd1306
     ssd1306_Init();                 
+    s4640878_reg_oled_invalidate();
+
+#if OLED_DMA
+    // dma: memory to the i2c data register, one byte at a time
+    __DMA1_CLK_ENABLE();
+    OLED_DMA_STREAM->CR = 0;
+    OLED_DMA_STREAM->PAR = (uint32_t)&I2C1->DR;
+    OLED_DMA_STREAM->CR = DMA_SxCR_CHSEL_0 | DMA_SxCR_MINC | DMA_SxCR_DIR_0;
+
+    // priority: 10 (the transfers end with a task notification)
+    HAL_NVIC_SetPriority(I2C1_EV_IRQn, 10, 0);
+    HAL_NVIC_EnableIRQ(I2C1_EV_IRQn);
+    HAL_NVIC_SetPriority(I2C1_ER_IRQn, 10, 0);
+    HAL_NVIC_EnableIRQ(I2C1_ER_IRQn);
+    HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 10, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+#endif
+#ifdef DWT
+    // starts the cycle counter used to time the transfers
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+// writes the column runs of each page of a frame (OLED_FRAME_BYTES, page
+// format) that differ from what the panel shows, nearby runs are joined
+// the transfer is started and not waited for, so the next frame can be drawn
+// while it is on the bus (the changed bytes are copied into one of two transfer
+// buffers). it only waits when the previous transfer is still going
+// returns the bytes to be written on the bus, 0 if the panel already shows the frame
+uint32_t s4640878_reg_oled_update(const uint8_t *frame) {
+    uint8_t *wire = oledWire[oledBuild];
+    int length = 0;
+
+    oledStats.updates++;
+    if (oledShownValid) {
+        length = oled_build_runs(wire, frame);
+    }
+    if (!oledShownValid || (length < 0)) {
+        // the panel is not known, or the runs would cost more than the whole frame
+        length = oled_build_whole(wire, frame);
+        oledShownValid = 1;
+    }
+    if (length == 0) {
+        return 0;
+    }
+
+    // on the bus each transaction has the address instead of the length
+    uint32_t bytes = 0;
+    for (int i = 0; i < length; i += TRANSACTION_HEADER + wire[i] + (wire[i + 1] << 8)) {
+        bytes += 1 + wire[i] + (wire[i + 1] << 8);
+    }
+    oledStats.changed++;
+    oledStats.bytes += bytes;
+
+    oled_wait();
+    oled_send(wire, length);
+    oledBuild ^= 1;
+    return bytes;
+}
+
+// makes the next update write the whole frame, for when the panel was written
+// some other way (ssd1306_UpdateScreen) or reset
+void s4640878_reg_oled_invalidate(void) {
+    oledShownValid = 0;
+}
+
+// copies the panel update counters
+void s4640878_reg_oled_get_stats(struct oledStats *stats) {
+    *stats = oledStats;
+}
+
+// builds the transfer of a whole frame, returns its length
+int oled_build_whole(uint8_t *wire, const uint8_t *frame) {
+    uint8_t *commands = oled_transaction(wire, SSD1306_CONTROL_COMMANDS, WHOLE_COMMANDS);
+    const uint8_t window[WHOLE_COMMANDS] = {
+        SSD1306_ADDRESSING_MODE, SSD1306_HORIZONTAL,
+        SSD1306_COLUMN_ADDRESS, 0, SSD1306_WIDTH - 1,
+        SSD1306_PAGE_ADDRESS, 0, OLED_PAGES - 1
+    };
+    memcpy(commands, window, WHOLE_COMMANDS);
+    uint8_t *data = oled_transaction(commands + WHOLE_COMMANDS, SSD1306_CONTROL_DATA, OLED_FRAME_BYTES);
+    memcpy(data, frame, OLED_FRAME_BYTES);
+    memcpy(oledShown, frame, OLED_FRAME_BYTES);
+    oledStats.runs++;
+    return WHOLE_TRANSFER;
+}
+
+// builds the transfer of the column runs that differ from the panel, each a
+// window transaction and a data transaction, and ends it with the window back
+// at the whole screen (as ssd1306_UpdateScreen expects it)
+// returns its length, 0 if nothing differs, or -1 if it would not be shorter
+// than the whole frame (the panel copy is then left part updated)
+int oled_build_runs(uint8_t *wire, const uint8_t *frame) {
+    uint8_t *next = wire;
+    int runs = 0;
+
+    for (int page = 0; page < OLED_PAGES; page++) {
+        const uint8_t *row = frame + page * SSD1306_WIDTH;
+        uint8_t *shown = oledShown + page * SSD1306_WIDTH;
+        int x = 0, pageSent = 0;
+        while (x < SSD1306_WIDTH) {
+            if (row[x] == shown[x]) {
+                x++;
+                continue;
+            }
+
+            // the run ends at the last changed column before RUN_GAP unchanged ones
+            int start = x, end = x;
+            for (x++; (x < SSD1306_WIDTH) && (x - end <= RUN_GAP); x++) {
+                if (row[x] != shown[x]) {
+                    end = x;
+                }
+            }
+            int columns = end - start + 1;
+            int commands = pageSent ? 3 : 6;
+            // room for this run and the window transaction at the end
+            if ((next - wire) + 3 * (TRANSACTION_HEADER + 1) + commands + columns + 6 > WHOLE_TRANSFER) {
+                return -1;
+            }
+
+            uint8_t *command = oled_transaction(next, SSD1306_CONTROL_COMMANDS, commands);
+            if (!pageSent) {
+                *command++ = SSD1306_PAGE_ADDRESS;
+                *command++ = page;
+                *command++ = page;
+                pageSent = 1;
+            }
+            *command++ = SSD1306_COLUMN_ADDRESS;
+            *command++ = start;
+            *command++ = end;
+            uint8_t *data = oled_transaction(command, SSD1306_CONTROL_DATA, columns);
+            memcpy(data, row + start, columns);
+            memcpy(shown + start, row + start, columns);
+            next = data + columns;
+            runs++;
+            x = end + 1;
+        }
+    }
+
+    if (runs == 0) {
+        return 0;
+    }
+    uint8_t *command = oled_transaction(next, SSD1306_CONTROL_COMMANDS, 6);
+    const uint8_t window[6] = {SSD1306_COLUMN_ADDRESS, 0, SSD1306_WIDTH - 1, SSD1306_PAGE_ADDRESS, 0, OLED_PAGES - 1};
+    memcpy(command, window, 6);
+    oledStats.runs += runs;
+    return (command + 6) - wire;
+}
+
+// writes the header of a transaction of length command or data bytes at wire,
+// returns where its bytes go
+uint8_t *oled_transaction(uint8_t *wire, int control, int length) {
+    wire[0] = (length + 1) & 0xFF;
+    wire[1] = (length + 1) >> 8;
+    wire[2] = control;
+    return wire + TRANSACTION_HEADER + 1;
+}
+
+// starts sending a transfer, oled_done is called when it has gone
+// board: the first start condition, the i2c and dma interrupts do the rest
+void oled_send(uint8_t *wire, int length) {
+    oledNext = wire;
+    oledEnd = wire + length;
+    oledBusy = 1;
+    oledStart = oled_clock();
+#if OLED_DMA
+    // a transfer that ended after its wait gave up left a notification, which
+    // would end the wait for this one early
+    ulTaskNotifyTake(pdTRUE, 0);
+    oledWaiter = xTaskGetCurrentTaskHandle();
+    I2C1->CR2 |= I2C_CR2_ITEVTEN | I2C_CR2_ITERREN | I2C_CR2_DMAEN;
+    I2C1->CR1 |= I2C_CR1_START;
+#else
+    // each transaction through the ssd1306 driver, one command at a time
+    while (oledNext < oledEnd) {
+        int count = oledNext[0] + (oledNext[1] << 8) - 1;
+        uint8_t *bytes = (uint8_t *)oledNext + TRANSACTION_HEADER + 1;
+        if (oledNext[TRANSACTION_HEADER] == SSD1306_CONTROL_DATA) {
+            ssd1306_WriteData(bytes, count);
+        } else {
+            for (int i = 0; i < count; i++) {
+                ssd1306_WriteCommand(bytes[i]);
+            }
+        }
+        oledNext = bytes + count;
+    }
+    oled_done(0);
+#endif
+}
+
+// waits for the transfer on the bus to finish, a transfer that does not
+// (the panel stopped answering) is stopped, counted as an error and the
+// next update writes the whole frame
+void oled_wait(void) {
+    if (!oledBusy) {
+        return;
+    }
+    ulTaskNotifyTake(pdTRUE, TRANSFER_WAIT_MS / portTICK_PERIOD_MS);
+    if (oledBusy) {
+#if OLED_DMA
+        portDISABLE_INTERRUPTS();
+        OLED_DMA_STREAM->CR &= ~(DMA_SxCR_EN | DMA_SxCR_TCIE);
+        DMA1->HIFCR = OLED_DMA_CLEAR;
+        I2C1->CR2 &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITERREN | I2C_CR2_DMAEN);
+        I2C1->CR1 |= I2C_CR1_STOP;
+        oledBusy = 0;       // before a late dma interrupt turns the events back on
+        portENABLE_INTERRUPTS();
+#else
+        oledBusy = 0;
+#endif
+        oledShownValid = 0;
+        oledStats.errors++;
+    }
+}
+
+// ends a transfer (error: it was stopped by a bus error), times it and
+// notifies the task waiting for it, called from the i2c interrupts on the board
+void oled_done(int error) {
+    uint32_t elapsed = oled_clock() - oledStart;
+#ifdef DWT
+    elapsed /= SystemCoreClock / 1000000;
+#endif
+    if (error) {
+        oledShownValid = 0;     // the panel missed part of it
+        oledStats.errors++;
+    }
+    oledStats.transferUs += elapsed;
+    if (elapsed > oledStats.maxTransferUs) {
+        oledStats.maxTransferUs = elapsed;
+    }
+    oledBusy = 0;
+#if OLED_DMA
+    I2C1->CR2 &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITERREN | I2C_CR2_DMAEN);
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(oledWaiter, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+#endif
+}
+
+// returns the time: core cycles (board) or us (host)
+uint32_t oled_clock(void) {
+#ifdef DWT
+    return DWT->CYCCNT;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000);
+#endif
+}
+
+#if OLED_DMA
+// i2c1 event isr: sends the address after each start condition, hands the
+// bytes of the transaction to the dma after the address, and once the dma is
+// done (its interrupt turns the events back on) and the last byte has gone,
+// starts the next transaction (repeated start) or stops
+void I2C1_EV_IRQHandler(void) {
+    uint32_t status = I2C1->SR1;
+
+    NVIC_ClearPendingIRQ(I2C1_EV_IRQn);
+    if (status & I2C_SR1_SB) {
+        I2C1->DR = SSD1306_ADDRESS;
+    } else if (status & I2C_SR1_ADDR) {
+        // the dma waits for the address to be acknowledged (no tx empty in the
+        // address phase), then fills the data register as it empties
+        int length = oledNext[0] + (oledNext[1] << 8);
+        DMA1->HIFCR = OLED_DMA_CLEAR;
+        OLED_DMA_STREAM->M0AR = (uint32_t)(oledNext + TRANSACTION_HEADER);
+        OLED_DMA_STREAM->NDTR = length;
+        OLED_DMA_STREAM->CR |= DMA_SxCR_TCIE | DMA_SxCR_EN;
+        oledNext += TRANSACTION_HEADER + length;
+        // no events while the dma runs: byte transfer finished can be set
+        // between two of its writes, and would interrupt again and again
+        I2C1->CR2 &= ~I2C_CR2_ITEVTEN;
+        (void)I2C1->SR2;    // clears the address flag
+    } else if (status & I2C_SR1_BTF) {
+        // cleared by the start or stop condition
+        if (oledNext < oledEnd) {
+            I2C1->CR1 |= I2C_CR1_START;
+        } else if (oledBusy) {
+            I2C1->CR1 |= I2C_CR1_STOP;
+            oled_done(0);
+        }
+    }
+}
+
+// dma1 stream 6 isr (i2c1 tx): once the dma has written the last byte of a
+// transaction, turns the i2c events back on to see it leave the bus
+void DMA1_Stream6_IRQHandler(void) {
+    NVIC_ClearPendingIRQ(DMA1_Stream6_IRQn);
+    if (DMA1->HISR & DMA_HISR_TCIF6) {
+        DMA1->HIFCR = OLED_DMA_CLEAR;
+        OLED_DMA_STREAM->CR &= ~DMA_SxCR_TCIE;
+        if (oledBusy) {
+            I2C1->CR2 |= I2C_CR2_ITEVTEN;
+        }
+    }
+}
+
+// i2c1 error isr: a bus error, lost arbitration or no acknowledge ends the
+// transfer
+void I2C1_ER_IRQHandler(void) {
+    NVIC_ClearPendingIRQ(I2C1_ER_IRQn);
+    if (I2C1->SR1 & OLED_I2C_ERRORS) {
+        I2C1->SR1 &= ~OLED_I2C_ERRORS;
+        OLED_DMA_STREAM->CR &= ~(DMA_SxCR_EN | DMA_SxCR_TCIE);
+        I2C1->CR1 |= I2C_CR1_STOP;
+        if (oledBusy) {
+            oled_done(1);
+        }
+    }
 }
+#endif
 
 // controlling task for oled
 void s4640878TaskOLED(void) {
@@ -11,6 +11,9 @@
  ***************************************************************
  * s4640878_reg_oled_init() - initialise the oled
  * s4640878_tsk_oled_init() - created controlling task for the oled
+ * s4640878_reg_oled_update() - writes the parts of a frame that differ from the panel
+ * s4640878_reg_oled_invalidate() - makes the next update write the whole frame
+ * s4640878_reg_oled_get_stats() - gets the updates and bytes written to the panel
  *************************************************************** 
  */
 
@@ -35,11 +38,42 @@ struct oledTextMsg {
     char displayText[20];
 };
 
+// frame in ssd1306 page format: byte page * SSD1306_WIDTH + x holds rows
+// 8 * page .. 8 * page + 7 of column x, bit 0 the top row
+#define OLED_PAGES (SSD1306_HEIGHT / 8)
+#define OLED_FRAME_BYTES (OLED_PAGES * SSD1306_WIDTH)
+
+// bytes on the bus to write a whole frame the way ssd1306_UpdateScreen does:
+// per page 3 commands (address, control and command byte each) and the data
+#define OLED_FULL_UPDATE_BYTES (OLED_PAGES * (3 * 3 + 2 + SSD1306_WIDTH))
+
+// i2c bus speed (hz): up to 100000 standard mode, up to 400000 fast mode
+#ifndef OLED_I2C_SPEED
+#define OLED_I2C_SPEED 100000
+#endif
+#if OLED_I2C_SPEED > 400000
+#error "OLED_I2C_SPEED is above fast mode (400000)"
+#endif
+
+// panel updates, the bytes written for them and the transfers on the bus
+struct oledStats {
+    uint32_t updates;       // frames given to s4640878_reg_oled_update
+    uint32_t changed;       // frames that differed from the panel (one transfer each)
+    uint32_t runs;          // column runs written
+    uint32_t bytes;         // bytes written (address and control bytes included)
+    uint32_t transferUs;    // total and longest time of a transfer on the bus
+    uint32_t maxTransferUs;
+    uint32_t errors;        // transfers ended by a bus error or not finishing
+};
+
 // oled message queue
 QueueHandle_t s4640878QueueOledMsg;
 
 // external function declarations
 void s4640878_reg_oled_init(void);
 void s4640878_tsk_oled_init(void);
+uint32_t s4640878_reg_oled_update(const uint8_t *frame);
+void s4640878_reg_oled_invalidate(void);
+void s4640878_reg_oled_get_stats(struct oledStats *stats);
 
 #endif
\ No newline at end of file
@@ -130,10 +130,11 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelete            1
 #define INCLUDE_vTaskCleanUpResources  0
 #define INCLUDE_vTaskSuspend           1
-#define INCLUDE_vTaskDelayUntil        0
+#define INCLUDE_vTaskDelayUntil        1
 #define INCLUDE_vTaskDelay             1
 #define INCLUDE_xTaskGetSchedulerState 1
 #define INCLUDE_xTaskGetHandle         1
+#define INCLUDE_xTaskGetCurrentTaskHandle 1
 
 /* Cortex-M specific definitions. */
 #ifdef __NVIC_PRIO_BITS
@@ -13,6 +13,14 @@ LIBSRCS += $(MYLIB_PATH)/s4640878_irremote.c
 LIBSRCS += $(MYLIB_PATH)/s4640878_oled.c
 
 LIBSRCS += $(MYLIB_PATH)/s4640878_CAG_simulator.c 
+LIBSRCS += $(MYLIB_PATH)/s4640878_CAG_universe.c
+LIBSRCS += $(MYLIB_PATH)/s4640878_CAG_hashlife.c
+LIBSRCS += $(MYLIB_PATH)/s4640878_CAG_parallel.c
+LIBSRCS += $(MYLIB_PATH)/s4640878_CAG_simd.c
+LIBSRCS += $(MYLIB_PATH)/s4640878_CAG_lut.c
+LIBSRCS += $(MYLIB_PATH)/s4640878_CAG_bytes.c
+LIBSRCS += $(MYLIB_PATH)/s4640878_CAG_sparse.c
+LIBSRCS += $(MYLIB_PATH)/s4640878_CAG_bench.c
 LIBSRCS += $(MYLIB_PATH)/s4640878_CAG_display.c
 LIBSRCS += $(MYLIB_PATH)/s4640878_CAG_grid.c
 LIBSRCS += $(MYLIB_PATH)/s4640878_cli_task.c